@@ -219,6 +219,7 @@ set(functions_list
     nanosleep
     poll
     posix_fadvise
+    posix_fallocate
     pread pwrite
     pthread_cancel
     pthread_keycreate pthread_key_create
@@ -556,6 +556,7 @@ enum att_type {
 	att_gen_init_val,
 	att_gen_id_increment,
 	att_gen_schema_name,
+	att_gen_cache,
 
 	// Stored procedure attributes
 
@@ -393,14 +393,13 @@ INTL_BOOL IntlUtil::asciiWellFormed(charset* cs, ULONG len, const UCHAR* str, UL
 	fb_assert(cs != NULL);
 	fb_assert(str != NULL);
 
-	for (const UCHAR* p = str, *const end = str + len; p != end; ++p, --len)
+	const ULONG pos = UnicodeUtil::utf8AsciiPrefix(len, str);
+
+	if (pos < len)
 	{
-		if (*p > 127)
-		{
-			if (offendingPos)
-				*offendingPos = p - str;
-			return false;	// malformed
-		}
+		if (offendingPos)
+			*offendingPos = pos;
+		return false;	// malformed
 	}
 
 	return true;	// well-formed
@@ -414,6 +413,13 @@ INTL_BOOL IntlUtil::utf8WellFormed(charset* cs, ULONG len, const UCHAR* str, ULO
 }
 
 
+ULONG IntlUtil::utf8Length(charset* cs, ULONG srcLen, const UCHAR* src)
+{
+	fb_assert(cs != NULL);
+	return UnicodeUtil::utf8Length(srcLen, src);
+}
+
+
 ULONG IntlUtil::utf8SubString(charset* cs, ULONG srcLen, const UCHAR* src, ULONG dstLen, UCHAR* dst,
 	ULONG startPos, ULONG length)
 {
@@ -426,6 +432,14 @@ ULONG IntlUtil::utf8SubString(charset* cs, ULONG srcLen, const UCHAR* src, ULONG
 		if (pos >= srcLen)
 			return 0;
 
+		// skip runs of ASCII characters in bulk
+		if (const ULONG ascii = MIN(UnicodeUtil::utf8AsciiPrefix(srcLen - pos, src + pos), startPos - currentPos))
+		{
+			pos += ascii;
+			currentPos += ascii;
+			continue;
+		}
+
 		U8_NEXT_UNSAFE(src, pos, c);
 
 		if (c < 0)
@@ -438,6 +452,14 @@ ULONG IntlUtil::utf8SubString(charset* cs, ULONG srcLen, const UCHAR* src, ULONG
 
 	while (currentPos < startPos + length && pos < srcLen)
 	{
+		if (const ULONG ascii = MIN(UnicodeUtil::utf8AsciiPrefix(srcLen - pos, src + pos),
+				startPos + length - currentPos))
+		{
+			pos += ascii;
+			currentPos += ascii;
+			continue;
+		}
+
 		U8_NEXT_UNSAFE(src, pos, c);
 
 		if (c < 0)
@@ -472,6 +494,7 @@ void IntlUtil::initUtf8Charset(charset* cs)
 	initNarrowCharset(cs, "UTF8");
 	cs->charset_max_bytes_per_char = 4;
 	cs->charset_fn_well_formed = utf8WellFormed;
+	cs->charset_fn_length = utf8Length;
 	cs->charset_fn_substring = utf8SubString;
 
 	initConvert(&cs->charset_to_unicode, cvtUtf8ToUtf16);
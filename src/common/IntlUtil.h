@@ -73,6 +73,7 @@ public:
 	static INTL_BOOL asciiWellFormed(charset* cs, ULONG len, const UCHAR* str, ULONG* offendingPos) noexcept;
 	static INTL_BOOL utf8WellFormed(charset* cs, ULONG len, const UCHAR* str, ULONG* offendingPos);
 
+	static ULONG utf8Length(charset* cs, ULONG srcLen, const UCHAR* src);
 	static ULONG utf8SubString(charset* cs, ULONG srcLen, const UCHAR* src, ULONG dstLen, UCHAR* dst,
 		ULONG startPos, ULONG length);
 
@@ -111,6 +111,7 @@ PARSER_TOKEN(TOK_BOTH, "BOTH", false)
 PARSER_TOKEN(TOK_BREAK, "BREAK", true)
 PARSER_TOKEN(TOK_BTRIM, "BTRIM", false)
 PARSER_TOKEN(TOK_BY, "BY", false)
+PARSER_TOKEN(TOK_CACHE, "CACHE", true)
 PARSER_TOKEN(TOK_CALL, "CALL", false)
 PARSER_TOKEN(TOK_CALLER, "CALLER", true)
 PARSER_TOKEN(TOK_CASCADE, "CASCADE", true)
@@ -319,6 +320,7 @@ PARSER_TOKEN(TOK_MANUAL, "MANUAL", true)
 PARSER_TOKEN(TOK_MAPPING, "MAPPING", true)
 PARSER_TOKEN(TOK_MATCHED, "MATCHED", true)
 PARSER_TOKEN(TOK_MATCHING, "MATCHING", true)
+PARSER_TOKEN(TOK_MATERIALIZED, "MATERIALIZED", true)
 PARSER_TOKEN(TOK_MAXIMUM, "MAX", false)
 PARSER_TOKEN(TOK_MAXVALUE, "MAXVALUE", true)
 PARSER_TOKEN(TOK_MERGE, "MERGE", false)
@@ -35,18 +35,49 @@
 #include "../common/os/path_utils.h"
 #include "../common/os/os_utils.h"
 #include "unicode/ucal.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 
 using namespace Firebird;
 
 namespace
 {
+	// Offset change of a region time zone
+	struct TimeZoneTransition
+	{
+		UDate utc;		// instant of the transition
+		UDate local;	// first local time converted to UTC with the new offset
+		int offset;		// new offset (minutes)
+	};
+
+	// Offsets of a region time zone for about a year, taken from ICU
+	class TimeZonePeriod
+	{
+	public:
+		TimeZonePeriod(MemoryPool& pool)
+			: transitions(pool)
+		{
+		}
+
+		int getUtcOffset(UDate utc) const;
+		bool getLocalOffset(UDate local, int* offset) const;
+
+	public:
+		int initialOffset = 0;
+		bool localValid = true;		// false if transitions are too close to each other
+		HalfStaticArray<TimeZoneTransition, 4> transitions;
+	};
+
 	class TimeZoneDesc
 	{
 	public:
 		TimeZoneDesc(MemoryPool& pool)
 			: asciiName(pool),
 			  unicodeName(pool),
-			  icuCachedCalendar(nullptr)
+			  icuCachedCalendar(nullptr),
+			  periodChunks{},
+			  pool(pool)
 		{
 		}
 
@@ -57,6 +88,17 @@ namespace
 				auto& icuLib = UnicodeUtil::getConversionICU();
 				icuLib.ucalClose(calendar);
 			}
+
+			for (auto& chunkPtr : periodChunks)
+			{
+				if (const auto chunk = chunkPtr.load())
+				{
+					for (auto& periodPtr : chunk->periods)
+						delete periodPtr.load();
+
+					delete chunk;
+				}
+			}
 		}
 
 	public:
@@ -91,10 +133,47 @@ namespace
 			return IcuCalendarWrapper(calendar, &icuCachedCalendar);
 		}
 
+		// Offsets are taken from the transition tables, built from ICU data on first use
+		// of every period. False is returned when ICU should be asked directly.
+
+		bool getUtcOffset(UDate utc, int* offset) const
+		{
+			const auto period = getPeriod(utc);
+
+			if (!period)
+				return false;
+
+			*offset = period->getUtcOffset(utc);
+			return true;
+		}
+
+		bool getLocalOffset(UDate local, int* offset) const
+		{
+			const auto period = getPeriod(local);
+			return period && period->getLocalOffset(local, offset);
+		}
+
 	private:
+		const TimeZonePeriod* getPeriod(UDate date) const;
+		TimeZonePeriod* buildPeriod(UDate start, UDate end) const;
+
+	private:
+		static constexpr UDate PERIOD_LENGTH = 366.0 * U_MILLIS_PER_DAY;
+		// Transitions around the period, enough to convert its local times
+		static constexpr UDate PERIOD_MARGIN = U_MILLIS_PER_DAY;
+		static constexpr unsigned PERIODS_PER_CHUNK = 128;
+		static constexpr unsigned PERIOD_CHUNKS = 80;	// covers years 1 - 9999
+
+		struct PeriodChunk
+		{
+			std::atomic<TimeZonePeriod*> periods[PERIODS_PER_CHUNK];
+		};
+
 		string asciiName;
 		Array<UChar> unicodeName;
 		mutable std::atomic<UCalendar*>	icuCachedCalendar;
+		mutable std::atomic<PeriodChunk*> periodChunks[PERIOD_CHUNKS];
+		MemoryPool& pool;
 	};
 }
 
@@ -304,6 +383,136 @@ static InitInstance<TimeZoneStartup> timeZoneStartup;
 
 //-------------------------------------
 
+namespace
+{
+	int TimeZonePeriod::getUtcOffset(UDate utc) const
+	{
+		const auto pos = std::upper_bound(transitions.begin(), transitions.end(), utc,
+			[](UDate date, const TimeZoneTransition& transition) { return date < transition.utc; });
+
+		return pos == transitions.begin() ? initialOffset : (pos - 1)->offset;
+	}
+
+	// Resolves local times the same way as ICU calendar with UCAL_WALLTIME_FIRST for repeated and
+	// skipped wall times does: the old offset is used up to the transition plus the bigger of offsets.
+	bool TimeZonePeriod::getLocalOffset(UDate local, int* offset) const
+	{
+		if (!localValid)
+			return false;
+
+		// ICU gets the local time without fractions of seconds
+		local = std::floor(local / U_MILLIS_PER_SECOND) * U_MILLIS_PER_SECOND;
+
+		const auto pos = std::upper_bound(transitions.begin(), transitions.end(), local,
+			[](UDate date, const TimeZoneTransition& transition) { return date < transition.local; });
+
+		*offset = pos == transitions.begin() ? initialOffset : (pos - 1)->offset;
+		return true;
+	}
+
+	const TimeZonePeriod* TimeZoneDesc::getPeriod(UDate date) const
+	{
+		const double index = std::floor((date - MIN_ICU_TIMESTAMP) / PERIOD_LENGTH);
+
+		if (index < 0 || index >= PERIODS_PER_CHUNK * PERIOD_CHUNKS)
+			return nullptr;
+
+		const unsigned n = static_cast<unsigned>(index);
+		auto& chunkPtr = periodChunks[n / PERIODS_PER_CHUNK];
+		auto chunk = chunkPtr.load(std::memory_order_acquire);
+
+		if (!chunk)
+		{
+			const auto newChunk = FB_NEW_POOL(pool) PeriodChunk();
+
+			if (chunkPtr.compare_exchange_strong(chunk, newChunk))
+				chunk = newChunk;
+			else
+				delete newChunk;
+		}
+
+		auto& periodPtr = chunk->periods[n % PERIODS_PER_CHUNK];
+		auto period = periodPtr.load(std::memory_order_acquire);
+
+		if (!period)
+		{
+			const UDate start = MIN_ICU_TIMESTAMP + n * PERIOD_LENGTH;
+			const auto newPeriod = buildPeriod(start - PERIOD_MARGIN, start + PERIOD_LENGTH + PERIOD_MARGIN);
+
+			if (!newPeriod)
+				return nullptr;
+
+			if (periodPtr.compare_exchange_strong(period, newPeriod))
+				period = newPeriod;
+			else
+				delete newPeriod;
+		}
+
+		return period;
+	}
+
+	TimeZonePeriod* TimeZoneDesc::buildPeriod(UDate start, UDate end) const
+	{
+		UErrorCode icuErrorCode = U_ZERO_ERROR;
+
+		UnicodeUtil::ConversionICU& icuLib = UnicodeUtil::getConversionICU();
+
+		auto icuCalendar = getCalendar(icuLib, &icuErrorCode);
+
+		if (!icuCalendar)
+			return nullptr;
+
+		const auto getOffset = [&]() {
+			return icuLib.ucalGet(icuCalendar, UCAL_ZONE_OFFSET, &icuErrorCode) +
+				icuLib.ucalGet(icuCalendar, UCAL_DST_OFFSET, &icuErrorCode);
+		};
+
+		icuLib.ucalSetMillis(icuCalendar, start, &icuErrorCode);
+
+		int lastOffset = getOffset();
+		UDate lastLocal = start;
+		UDate date;
+
+		const auto period = FB_NEW_POOL(pool) TimeZonePeriod(pool);
+		period->initialOffset = lastOffset / U_MILLIS_PER_MINUTE;
+
+		while (U_SUCCESS(icuErrorCode) &&
+			icuLib.ucalGetTimeZoneTransitionDate(icuCalendar, UCAL_TZ_TRANSITION_NEXT, &date, &icuErrorCode) &&
+			date < end)
+		{
+			icuLib.ucalSetMillis(icuCalendar, date, &icuErrorCode);
+
+			const int offset = getOffset();
+
+			// Skip changes of the zone name or of the DST rule not changing the offset
+			if (U_FAILURE(icuErrorCode) || offset == lastOffset)
+				continue;
+
+			// Overlapping ranges of repeated or skipped local times could not be resolved by the table
+			if (date + MIN(lastOffset, offset) < lastLocal)
+				period->localValid = false;
+
+			auto& transition = period->transitions.add();
+			transition.utc = date;
+			transition.local = date + MAX(lastOffset, offset);
+			transition.offset = offset / U_MILLIS_PER_MINUTE;
+
+			lastOffset = offset;
+			lastLocal = transition.local;
+		}
+
+		if (U_FAILURE(icuErrorCode))
+		{
+			delete period;
+			return nullptr;
+		}
+
+		return period;
+	}
+}	// namespace
+
+//-------------------------------------
+
 
 const ISC_DATE TimeZoneUtil::TIME_TZ_BASE_DATE = 58849;	// 2020-01-01
 const char TimeZoneUtil::GMT_FALLBACK[5] = "GMT*";
@@ -605,13 +814,14 @@ void TimeZoneUtil::extractOffset(const ISC_TIMESTAMP_TZ& timeStampTz, int* sign,
 // Extracts the offset (+- minutes) from a offset- or region-based datetime with time zone.
 void TimeZoneUtil::extractOffset(const ISC_TIMESTAMP_TZ& timeStampTz, SSHORT* offset)
 {
-	SSHORT displacement;
+	int displacement;
 
 	if (timeStampTz.time_zone == GMT_ZONE)
 		displacement = 0;
 	else if (isOffset(timeStampTz.time_zone))
 		displacement = offsetZoneToDisplacement(timeStampTz.time_zone);
-	else
+	else if (!getDesc(timeStampTz.time_zone)->getUtcOffset(
+				timeStampToIcuDate(timeStampTz.utc_timestamp), &displacement))
 	{
 		UErrorCode icuErrorCode = U_ZERO_ERROR;
 
@@ -708,7 +918,8 @@ void TimeZoneUtil::localTimeStampToUtc(ISC_TIMESTAMP_TZ& timeStampTz)
 		return;
 	else if (isOffset(timeStampTz.time_zone))
 		displacement = offsetZoneToDisplacement(timeStampTz.time_zone);
-	else
+	else if (!getDesc(timeStampTz.time_zone)->getLocalOffset(
+				timeStampToIcuDate(timeStampTz.utc_timestamp), &displacement))
 	{
 		tm times;
 		TimeStamp::decode_timestamp(*(ISC_TIMESTAMP*) &timeStampTz, &times, nullptr);
@@ -775,23 +986,29 @@ bool TimeZoneUtil::decodeTimeStamp(const ISC_TIMESTAMP_TZ& timeStampTz, bool gmt
 			if (gmtFallback && getenv("MISSING_ICU_EMULATION"))
 				(Arg::Gds(isc_random) << "Emulating missing ICU").raise();
 #endif
-			UnicodeUtil::ConversionICU& icuLib = UnicodeUtil::getConversionICU();
+			const auto desc = getDesc(timeStampTz.time_zone);
+			const UDate icuDate = timeStampToIcuDate(timeStampTz.utc_timestamp);
 
-			auto icuCalendar = getDesc(timeStampTz.time_zone)->getCalendar(icuLib, &icuErrorCode);
+			if (!desc->getUtcOffset(icuDate, &displacement))
+			{
+				UnicodeUtil::ConversionICU& icuLib = UnicodeUtil::getConversionICU();
+
+				auto icuCalendar = desc->getCalendar(icuLib, &icuErrorCode);
 
-			if (!icuCalendar)
-				status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_open.");
+				if (!icuCalendar)
+					status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_open.");
 
-			icuLib.ucalSetMillis(icuCalendar, timeStampToIcuDate(timeStampTz.utc_timestamp), &icuErrorCode);
+				icuLib.ucalSetMillis(icuCalendar, icuDate, &icuErrorCode);
 
-			if (U_FAILURE(icuErrorCode))
-				status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_setMillis.");
+				if (U_FAILURE(icuErrorCode))
+					status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_setMillis.");
 
-			displacement = (icuLib.ucalGet(icuCalendar, UCAL_ZONE_OFFSET, &icuErrorCode) +
-				icuLib.ucalGet(icuCalendar, UCAL_DST_OFFSET, &icuErrorCode)) / U_MILLIS_PER_MINUTE;
+				displacement = (icuLib.ucalGet(icuCalendar, UCAL_ZONE_OFFSET, &icuErrorCode) +
+					icuLib.ucalGet(icuCalendar, UCAL_DST_OFFSET, &icuErrorCode)) / U_MILLIS_PER_MINUTE;
 
-			if (U_FAILURE(icuErrorCode))
-				status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_get.");
+				if (U_FAILURE(icuErrorCode))
+					status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_get.");
+			}
 		}
 		catch (const Exception&)
 		{
@@ -0,0 +1,98 @@
+/*
+ *	PROGRAM:	Client/Server Common Code
+ *	MODULE:		BloomFilter.h
+ *	DESCRIPTION:	Bloom filter over hash values
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef CLASSES_BLOOM_FILTER_H
+#define CLASSES_BLOOM_FILTER_H
+
+#include "../common/classes/array.h"
+#include <utility>
+
+namespace Firebird {
+
+// Bloom filter over already computed hash values of some keys. It never
+// rejects an added hash and accepts about 3% of other ones while it's not
+// larger than the maximum size, 1MB.
+
+class BloomFilter
+{
+	static constexpr ULONG BITS_PER_KEY = 8;
+	static constexpr ULONG MAX_BITS = 8 * 1024 * 1024;
+	static constexpr ULONG PROBE_COUNT = 3;
+
+public:
+	BloomFilter(MemoryPool& pool, ULONG count)
+		: m_bits(pool)
+	{
+		ULONG size = 64;
+		while (size < MAX_BITS && size < (FB_UINT64) count * BITS_PER_KEY)
+			size <<= 1;
+
+		m_mask = size - 1;
+		m_bits.resize(size / 64, 0);
+	}
+
+	void add(ULONG hash) noexcept
+	{
+		const auto probe = getProbe(hash);
+
+		for (ULONG i = 0; i < PROBE_COUNT; i++)
+		{
+			const ULONG bit = (probe.first + i * probe.second) & m_mask;
+			m_bits[bit / 64] |= FB_UINT64(1) << (bit % 64);
+		}
+	}
+
+	bool check(ULONG hash) const noexcept
+	{
+		const auto probe = getProbe(hash);
+
+		for (ULONG i = 0; i < PROBE_COUNT; i++)
+		{
+			const ULONG bit = (probe.first + i * probe.second) & m_mask;
+
+			if (!(m_bits[bit / 64] & (FB_UINT64(1) << (bit % 64))))
+				return false;
+		}
+
+		return true;
+	}
+
+	// Size of the filter in bytes
+	FB_SIZE_T getSize() const noexcept
+	{
+		return m_bits.getCount() * sizeof(FB_UINT64);
+	}
+
+private:
+	// Derive the probe sequence from the hash value
+	static std::pair<ULONG, ULONG> getProbe(ULONG hash) noexcept
+	{
+		const FB_UINT64 mixed = hash * FB_CONST64(0x9E3779B97F4A7C15);
+		return std::make_pair(ULONG(mixed >> 32), ULONG(mixed) | 1);
+	}
+
+	Array<FB_UINT64> m_bits;
+	ULONG m_mask;
+};
+
+} // namespace Firebird
+
+#endif // CLASSES_BLOOM_FILTER_H
@@ -0,0 +1,169 @@
+/*
+ *	PROGRAM:	Client/Server Common Code
+ *	MODULE:		LruMap.h
+ *	DESCRIPTION:	Map with the least recently used eviction
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef CLASSES_LRU_MAP_H
+#define CLASSES_LRU_MAP_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/DoublyLinkedList.h"
+#include "../common/classes/GenericMap.h"
+#include <type_traits>
+#include <utility>
+
+namespace Firebird {
+
+// Map keeping its values in the order of use. Every value has a size given
+// by the caller, and shrink() evicts the least recently used values until
+// the total size fits the limit.
+//
+// Removed values are moved to a list passed by the caller, so it may release
+// them after unlocking the map. That list must use the pool of the map.
+
+template <typename K, typename V, typename KeyComparator = DefaultComparator<K> >
+class LruMap : public PermanentStorage
+{
+public:
+	struct Entry
+	{
+		Entry(MemoryPool& p, const K& aKey, V&& aValue, FB_SIZE_T aSize)
+			: key(aKey),
+			  value(moveValue(p, std::move(aValue))),
+			  size(aSize)
+		{
+		}
+
+		Entry(MemoryPool& p, Entry&& o)
+			: key(std::move(o.key)),
+			  value(moveValue(p, std::move(o.value))),
+			  size(o.size)
+		{
+		}
+
+		Entry(const Entry&) = delete;
+		Entry& operator=(const Entry&) = delete;
+
+		K key;
+		V value;
+		FB_SIZE_T size;
+
+	private:
+		static V moveValue(MemoryPool& p, V&& v)
+		{
+			if constexpr (std::is_constructible<V, MemoryPool&, V&&>::value)
+				return V(p, std::move(v));
+			else
+				return V(std::move(v));
+		}
+	};
+
+	typedef DoublyLinkedList<Entry> EntryList;
+
+	explicit LruMap(MemoryPool& p)
+		: PermanentStorage(p),
+		  map(p),
+		  entries(p)
+	{
+	}
+
+	// Find the value and make it the most recently used one
+	V* get(const K& key)
+	{
+		const auto iter = map.get(key);
+
+		if (!iter)
+			return nullptr;
+
+		entries.splice(entries.end(), entries, *iter);
+		return &(*iter)->value;
+	}
+
+	// Add the most recently used value, unless its key is already present
+	bool put(const K& key, V&& value, FB_SIZE_T valueSize)
+	{
+		if (map.get(key))
+			return false;
+
+		entries.pushBack(Entry(getPool(), key, std::move(value), valueSize));
+		map.put(key, --entries.end());
+		size += valueSize;
+
+		return true;
+	}
+
+	bool remove(const K& key, EntryList& removed)
+	{
+		const auto iter = map.get(key);
+
+		if (!iter)
+			return false;
+
+		const auto entry = *iter;
+		map.remove(key);
+		size -= entry->size;
+		removed.splice(removed.end(), entries, entry);
+
+		return true;
+	}
+
+	// Evict the least recently used values until the rest fits the limit
+	void shrink(FB_SIZE_T limit, EntryList& evicted)
+	{
+		while (size > limit && !entries.isEmpty())
+		{
+			const auto entry = entries.begin();
+			map.remove(entry->key);
+			size -= entry->size;
+			evicted.splice(evicted.end(), entries, entry);
+		}
+	}
+
+	void clear(EntryList& removed)
+	{
+		map.clear();
+		removed.splice(removed.end(), entries);
+		size = 0;
+	}
+
+	// Total size of the values
+	FB_SIZE_T getSize() const
+	{
+		return size;
+	}
+
+	FB_SIZE_T getCount() const
+	{
+		return entries.getCount();
+	}
+
+	bool isEmpty() const
+	{
+		return entries.isEmpty();
+	}
+
+private:
+	NonPooledMap<K, typename EntryList::Iterator, KeyComparator> map;
+	EntryList entries;		// most recently used at the end
+	FB_SIZE_T size = 0;
+};
+
+} // namespace Firebird
+
+#endif // CLASSES_LRU_MAP_H
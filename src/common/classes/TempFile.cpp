@@ -315,9 +315,30 @@ void TempFile::seek(const offset_t offset)
 
 void TempFile::extend(offset_t delta)
 {
+	const offset_t newSize = size + delta;
+
+#ifdef HAVE_POSIX_FALLOCATE
+	// Reserve the space without writing zeroes into it. Lack of space is
+	// reported here rather than by a later write, so the caller is able
+	// to switch to another temporary directory.
+	const int rc = os_utils::posix_fallocate(handle, (off_t) size, (off_t) delta);
+
+	if (rc == 0)
+	{
+		size = newSize;
+		return;
+	}
+
+	if (rc != EOPNOTSUPP && rc != EINVAL)
+	{
+		system_error::raise("posix_fallocate", rc);
+	}
+
+	// The file system can't reserve the space, write zeroes instead
+#endif
+
 	const char* const buffer = zeros().getBuffer();
 	const FB_SIZE_T bufferSize = zeros().getSize();
-	const offset_t newSize = size + delta;
 
 	for (offset_t offset = size; offset < newSize; offset += bufferSize)
 	{
@@ -326,6 +347,20 @@ void TempFile::extend(offset_t delta)
 	}
 }
 
+//
+// TempFile::prefetch
+//
+// Advises the OS to start reading the given range in background
+//
+
+void TempFile::prefetch(offset_t offset, FB_SIZE_T length) noexcept
+{
+#ifdef HAVE_POSIX_FADVISE
+	// Just a hint, errors don't matter
+	os_utils::posix_fadvise(handle, (off_t) offset, (off_t) length, POSIX_FADV_WILLNEED);
+#endif
+}
+
 //
 // TempFile::read
 //
@@ -59,6 +59,7 @@ public:
 	}
 
 	void extend(offset_t);
+	void prefetch(offset_t, FB_SIZE_T) noexcept;
 
 	const PathName& getName() const noexcept
 	{
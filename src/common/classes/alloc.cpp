@@ -63,10 +63,12 @@
 #include "../common/classes/init.h"
 #include "../common/classes/vector.h"
 #include "../common/classes/RefMutex.h"
+#include "../common/classes/Spinlock.h"
 #include "../common/config/config.h"
 #include "../common/os/os_utils.h"
 #include "../common/os/fbsyslog.h"
 #include "iberror.h"
+#include <mutex>
 
 #ifdef USE_VALGRIND
 #include <valgrind/memcheck.h>
@@ -136,6 +138,12 @@ size_t delayedExtentsPos = 0;
 // Could slowdown pool significantly !
 //#define VALIDATE_POOL
 
+// Per-thread caches of small blocks hide them from debugging and validation code
+#undef THREAD_CACHE
+#if !defined(DELAYED_FREE) && !defined(VALIDATE_POOL)
+#define THREAD_CACHE
+#endif
+
 typedef Firebird::AtomicCounter::counter_type StatInt;
 
 // We cache this amount of extents to avoid memory mapping overhead
@@ -266,6 +274,14 @@ typedef SLONG INT32;
 
 class MemBlock;
 class MemMediumHunk;
+class ThreadCache;
+
+// Blocks handed out and taken back by a thread cache, not yet added to the pool counters
+struct CachedBlockCounts
+{
+	int allocated;
+	int released;
+};
 
 class MemHeader
 {
@@ -1625,6 +1641,7 @@ private:
 	MemPool* parent;	// Parent pool if present
 	ExtentsCache* extentsCache;
 	AtomicCounter used_memory, mapped_memory;	// Memory used
+	bool threadCache;	// Small blocks are cached per thread
 
 private:
 
@@ -1681,10 +1698,26 @@ private:
 	static constexpr int RELEASE_DECR = 0x1;	// Decrement memory usage
 	static constexpr int RELEASE_RED = 0x2;		// Perform red zone checks (MEM_DEBUG only)
 
+	// Batch transfer of small blocks between the pool and thread caches.
+	// Blocks kept by the caches are not active, but the ones handed out
+	// by them are, so their counts are added to the pool counters too.
+	unsigned getBlocks(unsigned slot, MemBlock** to, unsigned count, CachedBlockCounts& counts);
+	void putBlocks(MemBlock** from, unsigned count, CachedBlockCounts& counts) noexcept;
+	void addCachedCounts(CachedBlockCounts& counts) noexcept;
+
 public:
 	void* allocate(size_t size ALLOC_PARAMS);
 	MemBlock* allocateRange(size_t from, size_t& size ALLOC_PARAMS);
 
+	// Put per-thread caches of small blocks in front of the pool.
+	// Must be called before the pool is shared between threads.
+	void enableThreadCache() noexcept
+	{
+#ifdef THREAD_CACHE
+		threadCache = true;
+#endif
+	}
+
 private:
 	virtual void memoryIsExhausted(void);
 	void* allocRaw(size_t length);
@@ -1828,8 +1861,271 @@ private:
 #endif // MEM_DEBUG
 
 	friend class MemoryPool;
+	friend class ThreadCache;
+};
+
+
+#ifdef THREAD_CACHE
+
+// Front end of the pools shared by many threads (SuperServer database pool for example).
+// Every thread keeps magazines (arrays of free small blocks of the same size class) for a
+// few pools, so most allocations and releases do not touch the pool's mutex. An empty
+// magazine is refilled from the pool and half of the full one is returned to the pool,
+// both by batches. Blocks are accounted as used by the pool only while they are allocated,
+// hence the pool's memory statistics do not change.
+
+class ThreadCache
+{
+public:
+	static constexpr unsigned POOLS = 4;			// pools cached by a thread
+	static constexpr unsigned DEPTH = 16;			// blocks in a magazine
+	static constexpr unsigned BATCH = DEPTH / 2;	// blocks moved to/from the pool at once
+
+	static MemBlock* allocate(MemPool* pool, size_t size);
+	static bool release(MemPool* pool, MemBlock* block) noexcept;
+
+	// Called by destroying pool - drop its blocks from caches of all threads
+	static void purge(MemPool* pool) noexcept;
+
+private:
+	struct Magazine
+	{
+		unsigned count;
+		MemBlock* blocks[DEPTH];
+	};
+
+	struct Entry
+	{
+		MemPool* pool;
+		CachedBlockCounts counts;
+		Magazine slots[LowLimits::TOTAL_ELEMENTS];
+	};
+
+	// Thread exit returns cached blocks to their pools
+	class Holder
+	{
+	public:
+		~Holder()
+		{
+			if (cache)
+				cache->destroy();
+
+			cache = nullptr;
+			dead = true;
+		}
+
+		ThreadCache* cache = nullptr;
+		bool dead = false;
+	};
+
+	static thread_local Holder holder;
+	static ThreadCache* registry;
+
+	SpinLock lock;		// taken by other threads only when a pool is destroyed
+	Entry entries[POOLS];
+	unsigned victim;
+	ThreadCache* next;
+	ThreadCache** prev;
+
+	ThreadCache()
+		: victim(0)
+	{
+		memset(entries, 0, sizeof(entries));
+	}
+
+	static Mutex& registryMutex()
+	{
+		// Never destroyed - threads may exit after the module cleanup
+		alignas(alignof(Mutex)) static char buffer[sizeof(Mutex)];
+		static Mutex* const mtx = new(buffer) Mutex;
+		return *mtx;
+	}
+
+	static ThreadCache* get() noexcept;
+	void destroy() noexcept;
+
+	Entry* findEntry(MemPool* pool, bool evict) noexcept;
+	static void flush(Entry* entry) noexcept;
+
+	static unsigned getSlot(size_t size)
+	{
+		return LowLimits::getSlot(size, SLOT_ALLOC);
+	}
 };
 
+thread_local ThreadCache::Holder ThreadCache::holder;
+ThreadCache* ThreadCache::registry = nullptr;
+
+ThreadCache* ThreadCache::get() noexcept
+{
+	if (holder.cache || holder.dead)
+		return holder.cache;
+
+	// Not allocated from the pools to avoid the recursion
+	void* memory = ::malloc(sizeof(ThreadCache));
+	if (!memory)
+		return nullptr;
+
+	ThreadCache* cache;
+	try
+	{
+		cache = new(memory) ThreadCache;
+	}
+	catch (...)
+	{
+		::free(memory);
+		return nullptr;
+	}
+
+	MutexLockGuard guard(registryMutex(), "ThreadCache::get");
+
+	cache->next = registry;
+	cache->prev = &registry;
+	if (registry)
+		registry->prev = &cache->next;
+	registry = cache;
+
+	holder.cache = cache;
+	return cache;
+}
+
+void ThreadCache::destroy() noexcept
+{
+	{	// scope
+		MutexLockGuard guard(registryMutex(), "ThreadCache::destroy");
+		std::lock_guard cacheGuard(lock);
+
+		for (auto& entry : entries)
+			flush(&entry);
+
+		*prev = next;
+		if (next)
+			next->prev = prev;
+	}
+
+	this->~ThreadCache();
+	::free(this);
+}
+
+void ThreadCache::purge(MemPool* pool) noexcept
+{
+	MutexLockGuard guard(registryMutex(), "ThreadCache::purge");
+
+	for (ThreadCache* cache = registry; cache; cache = cache->next)
+	{
+		std::lock_guard cacheGuard(cache->lock);
+
+		// Blocks are not returned - extents of the pool are going to be released
+		for (auto& entry : cache->entries)
+		{
+			if (entry.pool == pool)
+				memset(&entry, 0, sizeof(entry));
+		}
+	}
+}
+
+ThreadCache::Entry* ThreadCache::findEntry(MemPool* pool, bool evict) noexcept
+{
+	Entry* empty = nullptr;
+
+	for (auto& entry : entries)
+	{
+		if (entry.pool == pool)
+			return &entry;
+
+		if (!entry.pool && !empty)
+			empty = &entry;
+	}
+
+	if (!empty)
+	{
+		// Blocks released by the thread do not evict other pools, only allocations do
+		if (!evict)
+			return nullptr;
+
+		empty = &entries[victim++ % POOLS];
+		flush(empty);
+	}
+
+	empty->pool = pool;
+	return empty;
+}
+
+void ThreadCache::flush(Entry* entry) noexcept
+{
+	if (!entry->pool)
+		return;
+
+	for (auto& magazine : entry->slots)
+	{
+		if (magazine.count)
+			entry->pool->putBlocks(magazine.blocks, magazine.count, entry->counts);
+		magazine.count = 0;
+	}
+
+	if (entry->counts.allocated || entry->counts.released)
+		entry->pool->putBlocks(nullptr, 0, entry->counts);
+
+	entry->pool = nullptr;
+}
+
+MemBlock* ThreadCache::allocate(MemPool* pool, size_t size)
+{
+	const size_t length = ROUNDUP(size, MemPool::roundingSize) + offsetof(MemBlock, body);
+	if (length > LowLimits::TOP_LIMIT)
+		return nullptr;
+
+	ThreadCache* const cache = get();
+	if (!cache)
+		return nullptr;
+
+	const unsigned slot = getSlot(length);
+
+	std::lock_guard guard(cache->lock);
+
+	Entry* const entry = cache->findEntry(pool, true);
+	Magazine& magazine = entry->slots[slot];
+
+	if (!magazine.count)
+		magazine.count = pool->getBlocks(slot, magazine.blocks, BATCH, entry->counts);
+
+	entry->counts.allocated++;
+	return magazine.blocks[--magazine.count];
+}
+
+bool ThreadCache::release(MemPool* pool, MemBlock* block) noexcept
+{
+	const size_t length = block->getSize();
+	if (length > LowLimits::TOP_LIMIT)
+		return false;
+
+	ThreadCache* const cache = get();
+	if (!cache)
+		return false;
+
+	std::lock_guard guard(cache->lock);
+
+	Entry* const entry = cache->findEntry(pool, false);
+	if (!entry)
+		return false;
+
+	Magazine& magazine = entry->slots[getSlot(length)];
+	entry->counts.released++;
+
+	if (magazine.count == DEPTH)
+	{
+		// Return the oldest blocks to the pool
+		pool->putBlocks(magazine.blocks, BATCH, entry->counts);
+		magazine.count -= BATCH;
+		memmove(magazine.blocks, magazine.blocks + BATCH, magazine.count * sizeof(MemBlock*));
+	}
+
+	magazine.blocks[magazine.count++] = block;
+	return true;
+}
+
+#endif // THREAD_CACHE
+
 
 void DoubleLinkedList::putElement(MemBlock** to, MemBlock* block)
 {
@@ -1966,7 +2262,8 @@ MemPool::MemPool(MemoryStats& s, ExtentsCache* cache)
 	  parent_redirect(false),
 	  stats(&s),
 	  parent(NULL),
-	  extentsCache(cache)
+	  extentsCache(cache),
+	  threadCache(false)
 {
 	fb_assert(offsetof(MemBlock, body) == MEM_ALIGN(offsetof(MemBlock, body)));
 	initialize();
@@ -1977,7 +2274,8 @@ MemPool::MemPool(MemPool& p, MemoryStats& s, ExtentsCache* cache)
 	  parent_redirect(true),
 	  stats(&s),
 	  parent(&p),
-	  extentsCache(cache)
+	  extentsCache(cache),
+	  threadCache(false)
 {
 	initialize();
 }
@@ -2013,6 +2311,11 @@ void MemPool::initialize()
 
 MemPool::~MemPool(void)
 {
+#ifdef THREAD_CACHE
+	if (threadCache)
+		ThreadCache::purge(this);
+#endif
+
 	pool_destroying = true;
 
 	decrement_usage(used_memory.value());
@@ -2263,13 +2566,70 @@ void* MemPool::allocate(size_t size ALLOC_PARAMS_DEF)
 	Validator vld(this);
 #endif
 
+#ifdef THREAD_CACHE
+	MemBlock* memory = threadCache ? ThreadCache::allocate(this, size) : nullptr;
+
+	if (!memory)
+		memory = allocateRange(0, size ALLOC_PASS_ARGS);
+#else
 	MemBlock* memory = allocateRange(0, size ALLOC_PASS_ARGS);
+#endif
 
 	increment_usage(memory->getSize());
 
 	return &memory->body;
 }
 
+unsigned MemPool::getBlocks(unsigned slot, MemBlock** to, unsigned count, CachedBlockCounts& counts)
+{
+	MutexLockGuard guard(mutex, "MemPool::getBlocks");
+
+	addCachedCounts(counts);
+
+	const size_t length = LowLimits::getSize(slot) - offsetof(MemBlock, body);
+	unsigned n = 0;
+
+	try
+	{
+		for (; n < count; ++n)
+		{
+			size_t size = length;
+			MemBlock* const block = smallObjects.allocateBlock(this, 0, size);
+			fb_assert(block && size == length);
+
+			block->pool = this;
+			to[n] = block;
+		}
+	}
+	catch (...)
+	{
+		// Out of memory - be happy with what we've got
+		if (!n)
+			throw;
+	}
+
+	return n;
+}
+
+void MemPool::putBlocks(MemBlock** from, unsigned count, CachedBlockCounts& counts) noexcept
+{
+	MutexLockGuard guard(mutex, "MemPool::putBlocks");
+
+	addCachedCounts(counts);
+
+	for (unsigned n = 0; n < count; ++n)
+		smallObjects.deallocateBlock(from[n]);
+}
+
+void MemPool::addCachedCounts(CachedBlockCounts& counts) noexcept
+{
+	// Called with the pool mutex locked
+	blocksAllocated += counts.allocated;
+	blocksActive += counts.allocated - counts.released;
+
+	counts.allocated = counts.released = 0;
+}
+
 
 void MemPool::releaseMemory(void* object, bool flagExtent) noexcept
 {
@@ -2327,6 +2687,14 @@ void MemPool::releaseMemory(void* object, bool flagExtent) noexcept
 			pool->delayedFreePos = 0;
 #endif
 
+#ifdef THREAD_CACHE
+		if (pool->threadCache && !flagExtent && ThreadCache::release(pool, block))
+		{
+			pool->decrement_usage(block->getSize());
+			return;
+		}
+#endif
+
 		// Re-enable access to MemBlock
 		block->valgrindInternal();
 
@@ -2774,6 +3142,11 @@ void MemoryPool::deallocate(void* block) noexcept
 	pool->deallocate(block);
 }
 
+void MemoryPool::enableThreadCache() noexcept
+{
+	pool->enableThreadCache();
+}
+
 void MemoryPool::deletePool(MemoryPool* pool)
 {
 	while (pool->finalizers)
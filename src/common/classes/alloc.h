@@ -226,6 +226,10 @@ public:
 	// previously set group and added to new
 	void setStatsGroup(MemoryStats& stats) noexcept;
 
+	// Cache small blocks per thread to reduce contention on the pool shared
+	// between threads. Should be called before the pool is shared.
+	void enableThreadCache() noexcept;
+
 	// Initialize and finalize global memory pool
 	static void initDefaultPool();
 	static void cleanupDefaultPool();
@@ -0,0 +1,1743 @@
+/*
+ *	PROGRAM:	Client/Server Common Code
+ *	MODULE:		roaring_bitmap.h
+ *	DESCRIPTION:	compressed bitmap of integers
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/tree.h"
+#include <algorithm>
+#include <bit>
+
+namespace Firebird {
+
+// Drop-in replacement for SparseBitmap suited for large sets of values.
+//
+// Values are split into chunks of 64K by their upper bits. Chunks are kept
+// in a B+ tree, and every chunk stores the lower 16 bits of its values in
+// the smallest of three containers, the way roaring bitmaps do:
+//  - array: sorted 16-bit values, 2 bytes per value;
+//  - word list: sorted numbers of non-empty 64-bit words followed by the
+//    words themselves, 10 bytes per word. It's the best fit for values
+//    coming in clusters with gaps between them, like record numbers do;
+//  - bitset: all 1024 words of the chunk, 8KB.
+// Union and intersection merge whole containers word by word, bitsets are
+// combined in loops the compiler is able to vectorize.
+
+template <typename T>
+class RoaringBitmap : public AutoStorage
+{
+public:
+	// Default constructor, stack placement
+	RoaringBitmap() :
+		singular(false), singular_value(0), tree(getPool()), containersSize(0), defaultAccessor(this)
+	{ }
+
+	// Pooled constructor
+	explicit RoaringBitmap(MemoryPool& p) :
+		AutoStorage(p), singular(false), singular_value(0), tree(getPool()), containersSize(0),
+		defaultAccessor(this)
+	{ }
+
+	~RoaringBitmap()
+	{
+		clear();
+	}
+
+	// Default accessor methods
+	bool locate(T key) { return defaultAccessor.locate(locEqual, key); }
+
+	bool locate(LocType lt, T key) { return defaultAccessor.locate(lt, key); }
+
+	bool getFirst() { return defaultAccessor.getFirst(); }
+
+	bool getLast() { return defaultAccessor.getLast(); }
+
+	bool getNext() { return defaultAccessor.getNext(); }
+
+	bool getPrev() { return defaultAccessor.getPrev(); }
+
+	T current() const { return defaultAccessor.current(); }
+
+	// Set bit
+	void set(T value)
+	{
+		if (singular)
+		{
+			// If we are trying to set the same bit as already set - do nothing
+			if (singular_value == value)
+				return;
+
+			// Add singular value to the tree
+			fb_assert(tree.isEmpty());
+
+			singular = false;
+			setValue(singular_value);
+		}
+		else if (tree.isEmpty())
+		{
+			singular = true;
+			singular_value = value;
+			return;
+		}
+
+		setValue(value);
+	}
+
+	bool clear(T value)
+	{
+		if (singular)
+		{
+			fb_assert(tree.isEmpty());
+
+			if (value == singular_value)
+			{
+				singular = false;
+				return true;
+			}
+			return false;
+		}
+
+		const T key = value >> CHUNK_BITS;
+		if (tree.isPositioned(key) || tree.locate(key))
+		{
+			Container*& container = tree.current().container;
+
+			if (!removeValue(container, (USHORT) value))
+				return false;
+
+			if (!container->count)
+			{
+				release(container);
+				tree.fastRemove();
+			}
+
+			return true;
+		}
+		return false;
+	}
+
+	bool test(T value)
+	{
+		if (singular)
+		{
+			fb_assert(tree.isEmpty());
+			return (value == singular_value);
+		}
+
+		const T key = value >> CHUNK_BITS;
+		if (tree.isPositioned(key) || tree.locate(key))
+			return hasValue(tree.current().container, (USHORT) value);
+
+		return false;
+	}
+
+	static bool test(RoaringBitmap* bitmap, T value)
+	{
+		if (!bitmap)
+			return false;
+		return bitmap->test(value);
+	}
+
+	// Clear bitmap if it is not NULL
+	static void reset(RoaringBitmap* bitmap)
+	{
+		if (bitmap)
+			bitmap->clear();
+	}
+
+	size_t approxSize() const
+	{
+		return sizeof(*this) + tree.approxSize() + containersSize;
+	}
+
+	// Make bitmap empty
+	void clear()
+	{
+		singular = false;
+
+		if (tree.getFirst())
+		{
+			do {
+				release(tree.current().container);
+			} while (tree.getNext());
+		}
+
+		tree.clear();
+	}
+
+ 	// Compute the union of two bitmaps.
+	// Note: this method uses one of the bitmaps to return result
+	static RoaringBitmap** bit_or(RoaringBitmap** bitmap1, RoaringBitmap** bitmap2);
+
+ 	// Compute the intersection of two bitmaps.
+	// Note: this method uses one of the bitmaps to return result
+	static RoaringBitmap** bit_and(RoaringBitmap** bitmap1, RoaringBitmap** bitmap2);
+
+protected:
+	static constexpr unsigned CHUNK_BITS = 16;
+	static constexpr ULONG CHUNK_SIZE = 1 << CHUNK_BITS;
+	static constexpr ULONG WORD_BITS = 64;
+	static constexpr ULONG WORD_COUNT = CHUNK_SIZE / WORD_BITS;
+	static constexpr ULONG BITSET_SIZE = WORD_COUNT * sizeof(FB_UINT64);
+	static constexpr ULONG WORD_ENTRY_SIZE = sizeof(USHORT) + sizeof(FB_UINT64);
+	static constexpr ULONG MAX_ARRAY_COUNT = BITSET_SIZE / sizeof(USHORT);
+	static constexpr ULONG MIN_CAPACITY = 4;
+	static constexpr ULONG MERGE_ARRAY_COUNT = 256;	// arrays with more values together are united in a bitset
+
+	enum Kind : UCHAR { KIND_ARRAY, KIND_WORDS, KIND_BITSET };
+
+	// Container of the lower parts of values, followed by the data itself
+	struct Container
+	{
+		ULONG count;		// number of values stored
+		ULONG capacity;		// allocated entries of array or word list
+		ULONG used;			// entries used in word list
+		Kind kind;
+
+		// Values of array, or word numbers of word list
+		USHORT* values()
+		{
+			return reinterpret_cast<USHORT*>(this + 1);
+		}
+
+		const USHORT* values() const
+		{
+			return reinterpret_cast<const USHORT*>(this + 1);
+		}
+
+		// Words of bitset or word list
+		FB_UINT64* words()
+		{
+			return reinterpret_cast<FB_UINT64*>(reinterpret_cast<UCHAR*>(this + 1) + getOffset());
+		}
+
+		const FB_UINT64* words() const
+		{
+			return reinterpret_cast<const FB_UINT64*>(reinterpret_cast<const UCHAR*>(this + 1) + getOffset());
+		}
+
+	private:
+		ULONG getOffset() const
+		{
+			return (kind == KIND_WORDS) ? FB_ALIGN(capacity * sizeof(USHORT), sizeof(FB_UINT64)) : 0;
+		}
+	};
+
+	static_assert(sizeof(Container) % sizeof(FB_UINT64) == 0, "Container header must keep the data aligned");
+
+	struct Chunk
+	{
+		T key;					// value >> CHUNK_BITS
+		Container* container;	// lower bits of the values
+
+		inline static const T& generate(const void* /*sender*/, const Chunk& i)
+		{
+			return i.key;
+		}
+	};
+
+	typedef BePlusTree<Chunk, T, Chunk> ChunkTree;
+	typedef typename ChunkTree::Accessor ChunkTreeAccessor;
+
+	// Walks non-empty words of a container in ascending order
+	class WordCursor
+	{
+	public:
+		explicit WordCursor(const Container* c)
+			: container(c), pos(0), index(0), bits(0)
+		{}
+
+		bool next()
+		{
+			switch (container->kind)
+			{
+			case KIND_ARRAY:
+			{
+				const USHORT* const values = container->values();
+
+				if (pos >= container->count)
+					return false;
+
+				index = values[pos] / WORD_BITS;
+				bits = 0;
+
+				do {
+					bits |= FB_UINT64(1) << (values[pos] % WORD_BITS);
+				} while (++pos < container->count && values[pos] / WORD_BITS == index);
+
+				return true;
+			}
+
+			case KIND_WORDS:
+				if (pos >= container->used)
+					return false;
+
+				index = container->values()[pos];
+				bits = container->words()[pos++];
+				return true;
+
+			case KIND_BITSET:
+			{
+				const FB_UINT64* const words = container->words();
+
+				while (pos < WORD_COUNT && !words[pos])
+					pos++;
+
+				if (pos == WORD_COUNT)
+					return false;
+
+				index = pos;
+				bits = words[pos++];
+				return true;
+			}
+			}
+
+			return false;
+		}
+
+		const Container* const container;
+		ULONG pos;
+		ULONG index;
+		FB_UINT64 bits;
+	};
+
+	// Set if bitmap contains a single value only
+	bool singular;
+	T singular_value;
+
+	ChunkTree tree;
+	size_t containersSize;
+
+private:
+	RoaringBitmap(const RoaringBitmap& from); // Copy constructor. Not implemented for now.
+	RoaringBitmap& operator =(const RoaringBitmap& from); // Assignment operator. Not implemented for now.
+
+	static ULONG getDataSize(Kind kind, ULONG capacity)
+	{
+		switch (kind)
+		{
+		case KIND_ARRAY:
+			return FB_ALIGN(capacity * sizeof(USHORT), sizeof(FB_UINT64));
+		case KIND_WORDS:
+			return FB_ALIGN(capacity * sizeof(USHORT), sizeof(FB_UINT64)) + capacity * sizeof(FB_UINT64);
+		default:
+			return BITSET_SIZE;
+		}
+	}
+
+	// Pick the smallest container for the given number of values and non-empty words
+	static Kind getBestKind(ULONG count, ULONG wordCount)
+	{
+		const ULONG arraySize = count * sizeof(USHORT);
+		const ULONG listSize = wordCount * WORD_ENTRY_SIZE;
+
+		if (arraySize <= listSize && arraySize <= BITSET_SIZE)
+			return KIND_ARRAY;
+
+		return (listSize <= BITSET_SIZE) ? KIND_WORDS : KIND_BITSET;
+	}
+
+	static ULONG getGrownCapacity(ULONG capacity)
+	{
+		// Grow small containers fast and large ones modestly to not waste memory
+		if (capacity < 64)
+			return capacity * 2;
+
+		return FB_ALIGN(capacity < 256 ? capacity * 3 / 2 : capacity * 9 / 8, MIN_CAPACITY);
+	}
+
+	static ULONG countWords(const Container* container)
+	{
+		if (container->kind == KIND_WORDS)
+			return container->used;
+
+		ULONG wordCount = 0;
+		WordCursor cursor(container);
+
+		while (cursor.next())
+			wordCount++;
+
+		return wordCount;
+	}
+
+	static ULONG countBits(const FB_UINT64* words)
+	{
+		ULONG count = 0;
+
+		for (ULONG i = 0; i < WORD_COUNT; i++)
+			count += std::popcount(words[i]);
+
+		return count;
+	}
+
+	// Allocate an empty container
+	Container* allocate(Kind kind, ULONG capacity)
+	{
+		capacity = (kind == KIND_BITSET) ? 0 : FB_ALIGN(MAX(capacity, MIN_CAPACITY), MIN_CAPACITY);
+
+		const ULONG size = sizeof(Container) + getDataSize(kind, capacity);
+		FB_UINT64* const data = FB_NEW_POOL(getPool()) FB_UINT64[size / sizeof(FB_UINT64)];
+		containersSize += size;
+
+		Container* const container = reinterpret_cast<Container*>(data);
+		container->count = 0;
+		container->capacity = capacity;
+		container->used = 0;
+		container->kind = kind;
+
+		if (kind == KIND_BITSET)
+			memset(container->words(), 0, BITSET_SIZE);
+
+		return container;
+	}
+
+	void release(Container* container)
+	{
+		containersSize -= sizeof(Container) + getDataSize(container->kind, container->capacity);
+		delete[] reinterpret_cast<FB_UINT64*>(container);
+	}
+
+	// Append the word following all words already stored
+	static void appendWord(Container* container, ULONG index, FB_UINT64 bits)
+	{
+		fb_assert(bits);
+
+		switch (container->kind)
+		{
+		case KIND_ARRAY:
+		{
+			USHORT* const values = container->values();
+
+			for (; bits; bits &= bits - 1)
+			{
+				fb_assert(container->count < container->capacity);
+				values[container->count++] = (USHORT) (index * WORD_BITS + std::countr_zero(bits));
+			}
+			break;
+		}
+
+		case KIND_WORDS:
+			fb_assert(container->used < container->capacity);
+			container->values()[container->used] = (USHORT) index;
+			container->words()[container->used++] = bits;
+			container->count += std::popcount(bits);
+			break;
+
+		case KIND_BITSET:
+			container->words()[index] = bits;
+			container->count += std::popcount(bits);
+			break;
+		}
+	}
+
+	Container* convert(const Container* container, Kind kind, ULONG wordCount)
+	{
+		Container* const result =
+			allocate(kind, (kind == KIND_ARRAY) ? container->count : wordCount);
+
+		WordCursor cursor(container);
+
+		while (cursor.next())
+			appendWord(result, cursor.index, cursor.bits);
+
+		fb_assert(result->count == container->count);
+		return result;
+	}
+
+	Container* copy(const Container* container)
+	{
+		return convert(container, container->kind, countWords(container));
+	}
+
+	// Switch the container to the smallest representation of its contents.
+	// Merges call it for every container they produce, so a container up to
+	// twice as large as the best one is kept as is: converting it would cost
+	// more than the memory it saves.
+	void optimize(Container*& container)
+	{
+		if (!container->count)
+			return;
+
+		const ULONG wordCount = countWords(container);
+		const Kind kind = getBestKind(container->count, wordCount);
+		const ULONG needed = FB_ALIGN((kind == KIND_ARRAY) ? container->count : wordCount, MIN_CAPACITY);
+
+		if (getDataSize(container->kind, container->capacity) > 2 * getDataSize(kind, needed))
+		{
+			Container* const result = convert(container, kind, wordCount);
+			release(container);
+			container = result;
+		}
+	}
+
+	void setValue(T value)
+	{
+		const T key = value >> CHUNK_BITS;
+
+		if (!tree.isPositioned(key) && !tree.locate(key))
+		{
+			Chunk chunk;
+			chunk.key = key;
+			chunk.container = allocate(KIND_ARRAY, MIN_CAPACITY);
+			tree.add(chunk);
+			tree.locate(key);
+		}
+
+		addValue(tree.current().container, (USHORT) value);
+	}
+
+	void addValue(Container*& container, USHORT value)
+	{
+		const ULONG index = value / WORD_BITS;
+		const FB_UINT64 mask = FB_UINT64(1) << (value % WORD_BITS);
+
+		switch (container->kind)
+		{
+		case KIND_BITSET:
+		{
+			FB_UINT64& word = container->words()[index];
+
+			if (!(word & mask))
+			{
+				word |= mask;
+				container->count++;
+			}
+			return;
+		}
+
+		case KIND_ARRAY:
+		{
+			USHORT* values = container->values();
+			ULONG pos = container->count;
+
+			// Values are mostly set in ascending order, so check the tail first
+			if (pos && values[pos - 1] >= value)
+			{
+				pos = std::lower_bound(values, values + container->count, value) - values;
+
+				if (values[pos] == value)
+					return;
+			}
+
+			if (container->count == container->capacity)
+			{
+				const ULONG wordCount = countWords(container) + 1;
+				const Kind kind = getBestKind(container->count + 1, wordCount);
+
+				if (kind != KIND_ARRAY)
+				{
+					Container* const result = convert(container, kind, getGrownCapacity(wordCount));
+					release(container);
+					container = result;
+					addValue(container, value);
+					return;
+				}
+
+				Container* const grown = allocate(KIND_ARRAY,
+					MIN(getGrownCapacity(container->capacity), MAX_ARRAY_COUNT));
+				memcpy(grown->values(), values, container->count * sizeof(USHORT));
+				grown->count = container->count;
+				release(container);
+
+				container = grown;
+				values = container->values();
+			}
+
+			memmove(values + pos + 1, values + pos, (container->count - pos) * sizeof(USHORT));
+			values[pos] = value;
+			container->count++;
+			return;
+		}
+
+		case KIND_WORDS:
+		{
+			USHORT* indexes = container->values();
+			ULONG pos = container->used;
+
+			if (pos && indexes[pos - 1] >= index)
+				pos = std::lower_bound(indexes, indexes + container->used, index) - indexes;
+
+			if (pos < container->used && indexes[pos] == index)
+			{
+				FB_UINT64& word = container->words()[pos];
+
+				if (!(word & mask))
+				{
+					word |= mask;
+					container->count++;
+				}
+				return;
+			}
+
+			if (container->used == container->capacity)
+			{
+				const Kind kind = getBestKind(container->count + 1, container->used + 1);
+
+				if (kind != KIND_WORDS)
+				{
+					Container* const result = convert(container, kind, container->used);
+					release(container);
+					container = result;
+					addValue(container, value);
+					return;
+				}
+
+				Container* const grown = allocate(KIND_WORDS,
+					MIN(getGrownCapacity(container->capacity), BITSET_SIZE / WORD_ENTRY_SIZE));
+				memcpy(grown->values(), indexes, container->used * sizeof(USHORT));
+				memcpy(grown->words(), container->words(), container->used * sizeof(FB_UINT64));
+				grown->count = container->count;
+				grown->used = container->used;
+				release(container);
+
+				container = grown;
+				indexes = container->values();
+			}
+
+			FB_UINT64* const words = container->words();
+			const ULONG tail = container->used - pos;
+
+			memmove(indexes + pos + 1, indexes + pos, tail * sizeof(USHORT));
+			memmove(words + pos + 1, words + pos, tail * sizeof(FB_UINT64));
+			indexes[pos] = (USHORT) index;
+			words[pos] = mask;
+			container->used++;
+			container->count++;
+			return;
+		}
+		}
+	}
+
+	bool removeValue(Container*& container, USHORT value)
+	{
+		const ULONG index = value / WORD_BITS;
+		const FB_UINT64 mask = FB_UINT64(1) << (value % WORD_BITS);
+
+		switch (container->kind)
+		{
+		case KIND_BITSET:
+		{
+			FB_UINT64& word = container->words()[index];
+
+			if (!(word & mask))
+				return false;
+
+			word &= ~mask;
+
+			// Array of this size is twice as small as bitset, so no flip-flopping is possible
+			if (--container->count <= MAX_ARRAY_COUNT / 2)
+				optimize(container);
+
+			return true;
+		}
+
+		case KIND_ARRAY:
+		{
+			USHORT* const values = container->values();
+			const USHORT* const end = values + container->count;
+			USHORT* const ptr = std::lower_bound(values, values + container->count, value);
+
+			if (ptr == end || *ptr != value)
+				return false;
+
+			memmove(ptr, ptr + 1, (end - ptr - 1) * sizeof(USHORT));
+			container->count--;
+			return true;
+		}
+
+		case KIND_WORDS:
+		{
+			USHORT* const indexes = container->values();
+			const ULONG pos = std::lower_bound(indexes, indexes + container->used, index) - indexes;
+
+			if (pos == container->used || indexes[pos] != index)
+				return false;
+
+			FB_UINT64* const words = container->words();
+
+			if (!(words[pos] & mask))
+				return false;
+
+			container->count--;
+
+			if (!(words[pos] &= ~mask))
+			{
+				const ULONG tail = container->used - pos - 1;
+				memmove(indexes + pos, indexes + pos + 1, tail * sizeof(USHORT));
+				memmove(words + pos, words + pos + 1, tail * sizeof(FB_UINT64));
+				container->used--;
+			}
+			return true;
+		}
+		}
+
+		return false;
+	}
+
+	static bool hasValue(const Container* container, USHORT value)
+	{
+		const ULONG index = value / WORD_BITS;
+		const FB_UINT64 mask = FB_UINT64(1) << (value % WORD_BITS);
+
+		switch (container->kind)
+		{
+		case KIND_BITSET:
+			return container->words()[index] & mask;
+
+		case KIND_ARRAY:
+		{
+			const USHORT* const values = container->values();
+			return std::binary_search(values, values + container->count, value);
+		}
+
+		case KIND_WORDS:
+		{
+			const USHORT* const indexes = container->values();
+			const ULONG pos = std::lower_bound(indexes, indexes + container->used, index) - indexes;
+
+			return pos < container->used && indexes[pos] == index && (container->words()[pos] & mask);
+		}
+		}
+
+		return false;
+	}
+
+	// Add values of the source container to the destination one
+	void unite(Container*& dest, const Container* source)
+	{
+		if (dest->kind != KIND_BITSET && source->kind == KIND_BITSET)
+		{
+			Container* result = copy(source);
+			unite(result, dest);
+			release(dest);
+			dest = result;
+			return;
+		}
+
+		if (dest->kind == KIND_BITSET)
+		{
+			FB_UINT64* const destWords = dest->words();
+
+			if (source->kind == KIND_BITSET)
+			{
+				const FB_UINT64* const sourceWords = source->words();
+
+				for (ULONG i = 0; i < WORD_COUNT; i++)
+					destWords[i] |= sourceWords[i];
+			}
+			else
+			{
+				WordCursor cursor(source);
+
+				while (cursor.next())
+					destWords[cursor.index] |= cursor.bits;
+			}
+
+			dest->count = countBits(destWords);
+			return;
+		}
+
+		if (dest->kind == KIND_ARRAY && source->kind == KIND_ARRAY)
+		{
+			if (dest->count + source->count > MERGE_ARRAY_COUNT)
+			{
+				uniteInBitset(dest, source);
+				return;
+			}
+
+			const USHORT* const values2 = source->values();
+			const ULONG total = dest->count + source->count -
+				countCommon(dest->values(), dest->count, values2, source->count);
+
+			if (total > dest->capacity)
+			{
+				Container* const grown = allocate(KIND_ARRAY, total);
+				memcpy(grown->values(), dest->values(), dest->count * sizeof(USHORT));
+				grown->count = dest->count;
+				release(dest);
+				dest = grown;
+			}
+
+			// Merge from the end to do it in place
+			USHORT* const values = dest->values();
+			ULONG pos1 = dest->count, pos2 = source->count, out = total;
+
+			while (pos2)
+			{
+				if (pos1 && values[pos1 - 1] > values2[pos2 - 1])
+					values[--out] = values[--pos1];
+				else
+				{
+					if (pos1 && values[pos1 - 1] == values2[pos2 - 1])
+						pos1--;
+
+					values[--out] = values2[--pos2];
+				}
+			}
+
+			fb_assert(out == pos1);
+			dest->count = total;
+			optimize(dest);
+			return;
+		}
+
+		if (dest->kind == KIND_WORDS && source->kind == KIND_WORDS)
+		{
+			const USHORT* const indexes2 = source->values();
+			const FB_UINT64* const words2 = source->words();
+
+			if (sameWords(dest, source))
+			{
+				FB_UINT64* const words = dest->words();
+				ULONG count = 0;
+
+				for (ULONG i = 0; i < dest->used; i++)
+					count += std::popcount(words[i] |= words2[i]);
+
+				dest->count = count;
+				return;
+			}
+
+			const ULONG total = dest->used + source->used -
+				countCommon(dest->values(), dest->used, indexes2, source->used);
+
+			if (total > dest->capacity)
+			{
+				Container* const grown = allocate(KIND_WORDS, total);
+				memcpy(grown->values(), dest->values(), dest->used * sizeof(USHORT));
+				memcpy(grown->words(), dest->words(), dest->used * sizeof(FB_UINT64));
+				grown->count = dest->count;
+				grown->used = dest->used;
+				release(dest);
+				dest = grown;
+			}
+
+			// Merge from the end to do it in place
+			USHORT* const indexes = dest->values();
+			FB_UINT64* const words = dest->words();
+			ULONG pos1 = dest->used, pos2 = source->used, out = total;
+
+			while (pos2)
+			{
+				if (pos1 && indexes[pos1 - 1] > indexes2[pos2 - 1])
+				{
+					out--;
+					pos1--;
+					indexes[out] = indexes[pos1];
+					words[out] = words[pos1];
+				}
+				else
+				{
+					FB_UINT64 bits = words2[--pos2];
+
+					if (pos1 && indexes[pos1 - 1] == indexes2[pos2])
+					{
+						const FB_UINT64 oldBits = words[--pos1];
+						dest->count -= std::popcount(oldBits);
+						bits |= oldBits;
+					}
+
+					out--;
+					indexes[out] = indexes2[pos2];
+					words[out] = bits;
+					dest->count += std::popcount(bits);
+				}
+			}
+
+			fb_assert(out == pos1);
+			dest->used = total;
+			optimize(dest);
+			return;
+		}
+
+		Container* const result = allocate(KIND_WORDS, countWords(dest) + countWords(source));
+		mergeWords<true>(result, dest, source);
+
+		release(dest);
+		dest = result;
+		optimize(dest);
+	}
+
+	// Keep in the destination container only values present in the source one
+	void intersect(Container*& dest, const Container* source)
+	{
+		if (dest->kind == KIND_BITSET && source->kind == KIND_BITSET)
+		{
+			FB_UINT64* const destWords = dest->words();
+			const FB_UINT64* const sourceWords = source->words();
+
+			for (ULONG i = 0; i < WORD_COUNT; i++)
+				destWords[i] &= sourceWords[i];
+
+			dest->count = countBits(destWords);
+		}
+		else if (dest->kind == KIND_ARRAY && source->kind == KIND_ARRAY)
+		{
+			// Result is never longer than the destination, so do it in place
+			USHORT* const values = dest->values();
+			const USHORT* const values2 = source->values();
+			ULONG pos1 = 0, pos2 = 0, out = 0;
+
+			while (pos1 < dest->count && pos2 < source->count)
+			{
+				const USHORT value1 = values[pos1], value2 = values2[pos2];
+				values[out] = value1;
+				out += (value1 == value2);
+				pos1 += (value1 <= value2);
+				pos2 += (value2 <= value1);
+			}
+
+			dest->count = out;
+		}
+		else if (dest->kind == KIND_WORDS && source->kind == KIND_WORDS)
+		{
+			USHORT* const indexes = dest->values();
+			FB_UINT64* const words = dest->words();
+			const USHORT* const indexes2 = source->values();
+			const FB_UINT64* const words2 = source->words();
+			ULONG pos1 = 0, pos2 = 0, out = 0;
+
+			dest->count = 0;
+
+			if (sameWords(dest, source))
+			{
+				for (; pos1 < dest->used; pos1++)
+				{
+					const FB_UINT64 bits = words[pos1] & words2[pos1];
+					indexes[out] = indexes[pos1];
+					words[out] = bits;
+					out += (bits != 0);
+					dest->count += std::popcount(bits);
+				}
+
+				pos2 = source->used;
+			}
+
+			while (pos1 < dest->used && pos2 < source->used)
+			{
+				const USHORT index1 = indexes[pos1], index2 = indexes2[pos2];
+
+				if (index1 < index2)
+					pos1++;
+				else if (index2 < index1)
+					pos2++;
+				else
+				{
+					if (const FB_UINT64 bits = words[pos1] & words2[pos2])
+					{
+						indexes[out] = index1;
+						words[out++] = bits;
+						dest->count += std::popcount(bits);
+					}
+
+					pos1++;
+					pos2++;
+				}
+			}
+
+			dest->used = out;
+		}
+		else
+		{
+			Container* const result =
+				allocate(KIND_WORDS, MIN(countWords(dest), countWords(source)));
+			mergeWords<false>(result, dest, source);
+
+			release(dest);
+			dest = result;
+		}
+
+		optimize(dest);
+	}
+
+	// Word lists with the same non-empty words are the norm for record numbers
+	// of the same table, their words are combined one by one then
+	static bool sameWords(const Container* container1, const Container* container2)
+	{
+		return container1->used == container2->used &&
+			!memcmp(container1->values(), container2->values(), container1->used * sizeof(USHORT));
+	}
+
+	// Unite large arrays in a temporary bitset. Unlike a merge of sorted
+	// arrays, setting the bits doesn't wait for comparison of the previous
+	// values, and the result gets the best kind at once.
+	void uniteInBitset(Container*& dest, const Container* source)
+	{
+		FB_UINT64 words[WORD_COUNT] = {};
+
+		const auto setBits = [&words](const Container* container)
+		{
+			fb_assert(container->kind == KIND_ARRAY);
+			const USHORT* const values = container->values();
+
+			for (ULONG i = 0; i < container->count; i++)
+				words[values[i] / WORD_BITS] |= FB_UINT64(1) << (values[i] % WORD_BITS);
+		};
+
+		setBits(dest);
+		setBits(source);
+
+		ULONG count = 0, wordCount = 0;
+
+		for (ULONG i = 0; i < WORD_COUNT; i++)
+		{
+			count += std::popcount(words[i]);
+			wordCount += (words[i] != 0);
+		}
+
+		const Kind kind = getBestKind(count, wordCount);
+		Container* const result = allocate(kind, (kind == KIND_ARRAY) ? count : wordCount);
+
+		for (ULONG i = 0; i < WORD_COUNT; i++)
+		{
+			if (words[i])
+				appendWord(result, i, words[i]);
+		}
+
+		release(dest);
+		dest = result;
+	}
+
+	// Number of values present in both sorted arrays
+	static ULONG countCommon(const USHORT* values1, ULONG count1, const USHORT* values2, ULONG count2)
+	{
+		const USHORT* const end1 = values1 + count1;
+		const USHORT* const end2 = values2 + count2;
+		ULONG common = 0;
+
+		while (values1 < end1 && values2 < end2)
+		{
+			const USHORT value1 = *values1, value2 = *values2;
+			common += (value1 == value2);
+			values1 += (value1 <= value2);
+			values2 += (value2 <= value1);
+		}
+
+		return common;
+	}
+
+	// Store union or intersection of two containers into the empty word list
+	template <bool UNION>
+	static void mergeWords(Container* result, const Container* container1, const Container* container2)
+	{
+		fb_assert(result->kind == KIND_WORDS && !result->used);
+
+		USHORT* indexes = result->values();
+		FB_UINT64* words = result->words();
+		ULONG count = 0;
+
+		const auto append = [&](ULONG index, FB_UINT64 bits)
+		{
+			*indexes++ = (USHORT) index;
+			*words++ = bits;
+			count += std::popcount(bits);
+		};
+
+		if (container1->kind == KIND_WORDS && container2->kind == KIND_WORDS)
+		{
+			// Fast path for the most common case
+			const USHORT* const indexes1 = container1->values();
+			const USHORT* const indexes2 = container2->values();
+			const FB_UINT64* const words1 = container1->words();
+			const FB_UINT64* const words2 = container2->words();
+			ULONG pos1 = 0, pos2 = 0;
+
+			while (pos1 < container1->used && pos2 < container2->used)
+			{
+				const USHORT index1 = indexes1[pos1], index2 = indexes2[pos2];
+
+				if (index1 < index2)
+				{
+					if (UNION)
+						append(index1, words1[pos1]);
+					pos1++;
+				}
+				else if (index2 < index1)
+				{
+					if (UNION)
+						append(index2, words2[pos2]);
+					pos2++;
+				}
+				else
+				{
+					if (UNION)
+						append(index1, words1[pos1] | words2[pos2]);
+					else if (const FB_UINT64 bits = words1[pos1] & words2[pos2])
+						append(index1, bits);
+
+					pos1++;
+					pos2++;
+				}
+			}
+
+			if (UNION)
+			{
+				for (; pos1 < container1->used; pos1++)
+					append(indexes1[pos1], words1[pos1]);
+
+				for (; pos2 < container2->used; pos2++)
+					append(indexes2[pos2], words2[pos2]);
+			}
+		}
+		else
+		{
+			WordCursor cursor1(container1), cursor2(container2);
+			bool found1 = cursor1.next(), found2 = cursor2.next();
+
+			while (found1 && found2)
+			{
+				if (cursor1.index < cursor2.index)
+				{
+					if (UNION)
+						append(cursor1.index, cursor1.bits);
+					found1 = cursor1.next();
+				}
+				else if (cursor2.index < cursor1.index)
+				{
+					if (UNION)
+						append(cursor2.index, cursor2.bits);
+					found2 = cursor2.next();
+				}
+				else
+				{
+					if (UNION)
+						append(cursor1.index, cursor1.bits | cursor2.bits);
+					else if (const FB_UINT64 bits = cursor1.bits & cursor2.bits)
+						append(cursor1.index, bits);
+
+					found1 = cursor1.next();
+					found2 = cursor2.next();
+				}
+			}
+
+			if (UNION)
+			{
+				for (; found1; found1 = cursor1.next())
+					append(cursor1.index, cursor1.bits);
+
+				for (; found2; found2 = cursor2.next())
+					append(cursor2.index, cursor2.bits);
+			}
+		}
+
+		result->used = (ULONG) (indexes - result->values());
+		result->count = count;
+		fb_assert(result->used <= result->capacity);
+	}
+
+public:
+	class Accessor
+	{
+	public:
+		Accessor(RoaringBitmap* _bitmap) :
+			bitmap(_bitmap), treeAccessor(_bitmap ? &_bitmap->tree : NULL), position(0),
+			current_value(0)
+		{}
+
+		bool locate(T key)
+		{
+			return locate(locEqual, key);
+		}
+
+		// Position accessor on item having LocType relationship with given key
+		// If method returns false position of accessor is not defined.
+		bool locate(LocType lt, T key)
+		{
+			// Small convenience related to fact engine likes to use NULL bitmap pointers
+			if (!bitmap)
+				return false;
+
+			if (bitmap->singular)
+			{
+				// Trivial handling for singular bitmap
+				current_value = bitmap->singular_value;
+
+				switch (lt)
+				{
+				case locEqual:
+					return current_value == key;
+				case locGreatEqual:
+					return current_value >= key;
+				case locLessEqual:
+					return current_value <= key;
+				case locLess:
+					return current_value < key;
+				case locGreat:
+					return current_value > key;
+				}
+				return false;
+			}
+
+			// Transform locLess and locGreat to locLessEqual and locGreatEqual
+			switch (lt)
+			{
+				case locLess:
+					if (key == 0)
+						return false;
+					key--;
+					lt = locLessEqual;
+					break;
+				case locGreat:
+					if (key == ~(T)0)
+						return false;
+					key++;
+					lt = locGreatEqual;
+					break;
+				default:
+					break;
+			}
+
+			const T chunkKey = key >> CHUNK_BITS;
+			ULONG low = (ULONG) (key & (CHUNK_SIZE - 1));
+
+			switch (lt)
+			{
+				case locEqual:
+					if (!treeAccessor.locate(locEqual, chunkKey) || !seekNext(container(), low, position))
+						return false;
+
+					current_value = key;
+					return valueAt(container(), position) == low;
+
+				case locGreatEqual:
+					if (!treeAccessor.locate(locGreatEqual, chunkKey))
+						return false;
+
+					if (treeAccessor.current().key != chunkKey)
+						low = 0;
+
+					if (!seekNext(container(), low, position))
+					{
+						// Nothing suitable in this chunk, so take the first value of the next one
+						if (!treeAccessor.getNext())
+							return false;
+
+						seekNext(container(), 0, position);
+					}
+
+					setCurrent();
+					return true;
+
+				case locLessEqual:
+					if (!treeAccessor.locate(locLessEqual, chunkKey))
+						return false;
+
+					if (treeAccessor.current().key != chunkKey)
+						low = CHUNK_SIZE - 1;
+
+					if (!seekPrev(container(), low, position))
+					{
+						// Nothing suitable in this chunk, so take the last value of the previous one
+						if (!treeAccessor.getPrev())
+							return false;
+
+						seekPrev(container(), CHUNK_SIZE - 1, position);
+					}
+
+					setCurrent();
+					return true;
+
+				default:
+					break;
+			}
+			fb_assert(false); // Invalid constant is used ?
+			return false;
+		}
+
+		// If method returns false it means list is empty and
+		// position of accessor is not defined.
+		bool getFirst()
+		{
+			// Small convenience related to fact engine likes to use NULL bitmap pointers
+			if (!bitmap)
+				return false;
+
+			if (bitmap->singular)
+			{
+				current_value = bitmap->singular_value;
+				return true;
+			}
+
+			if (!treeAccessor.getFirst())
+				return false;
+
+			seekNext(container(), 0, position);
+			setCurrent();
+			return true;
+		}
+
+		// If method returns false it means list is empty and
+		// position of accessor is not defined.
+		bool getLast()
+		{
+			// Small convenience related to fact engine likes to use NULL bitmap pointers
+			if (!bitmap)
+				return false;
+
+			if (bitmap->singular)
+			{
+				current_value = bitmap->singular_value;
+				return true;
+			}
+
+			if (!treeAccessor.getLast())
+				return false;
+
+			seekPrev(container(), CHUNK_SIZE - 1, position);
+			setCurrent();
+			return true;
+		}
+
+		// Accessor position must be establised via successful call to getFirst(),
+		// getLast() or locate() before you can call this method
+		bool getNext()
+		{
+			if (bitmap->singular)
+				return false;
+
+			// Use temporary to avoid corrupting position if there is no next item in bitmap
+			ULONG pos = position;
+
+			if (!stepNext(container(), pos))
+			{
+				if (!treeAccessor.getNext())
+					return false;
+
+				seekNext(container(), 0, pos);
+			}
+
+			position = pos;
+			setCurrent();
+			return true;
+		}
+
+		// Accessor position must be establised via successful call to getFirst(),
+		// getLast() or locate() before you can call this method
+		bool getPrev()
+		{
+			if (bitmap->singular)
+				return false;
+
+			// Use temporary to avoid corrupting position if there is no previous item in bitmap
+			ULONG pos = position;
+
+			if (!stepPrev(container(), pos))
+			{
+				if (!treeAccessor.getPrev())
+					return false;
+
+				seekPrev(container(), CHUNK_SIZE - 1, pos);
+			}
+
+			position = pos;
+			setCurrent();
+			return true;
+		}
+
+	    T current() const { return current_value; }
+
+	private:
+		const Container* container() const
+		{
+			return treeAccessor.current().container;
+		}
+
+		void setCurrent()
+		{
+			current_value = (treeAccessor.current().key << CHUNK_BITS) | valueAt(container(), position);
+		}
+
+		// Position is an index for arrays, the value itself for bitsets,
+		// and an entry number followed by bit number for word lists
+
+		static ULONG valueAt(const Container* container, ULONG pos)
+		{
+			switch (container->kind)
+			{
+			case KIND_ARRAY:
+				return container->values()[pos];
+			case KIND_WORDS:
+				return container->values()[pos / WORD_BITS] * WORD_BITS + pos % WORD_BITS;
+			default:
+				return pos;
+			}
+		}
+
+		static ULONG lowestBit(FB_UINT64 bits)
+		{
+			return std::countr_zero(bits);
+		}
+
+		static ULONG highestBit(FB_UINT64 bits)
+		{
+			return WORD_BITS - 1 - std::countl_zero(bits);
+		}
+
+		// Find position of the first value not less than the given one
+		static bool seekNext(const Container* container, ULONG value, ULONG& pos)
+		{
+			const ULONG index = value / WORD_BITS;
+			const FB_UINT64 mask = ~FB_UINT64(0) << (value % WORD_BITS);
+
+			switch (container->kind)
+			{
+			case KIND_ARRAY:
+			{
+				const USHORT* const values = container->values();
+				pos = (ULONG) (std::lower_bound(values, values + container->count, value) - values);
+				return pos < container->count;
+			}
+
+			case KIND_WORDS:
+			{
+				const USHORT* const indexes = container->values();
+				const FB_UINT64* const words = container->words();
+				ULONG entry = (ULONG) (std::lower_bound(indexes, indexes + container->used, index) - indexes);
+
+				if (entry == container->used)
+					return false;
+
+				FB_UINT64 bits = words[entry];
+
+				if (indexes[entry] == index && !(bits &= mask))
+				{
+					if (++entry == container->used)
+						return false;
+
+					bits = words[entry];
+				}
+
+				pos = entry * WORD_BITS + lowestBit(bits);
+				return true;
+			}
+
+			default:
+			{
+				if (value >= CHUNK_SIZE)
+					return false;
+
+				const FB_UINT64* const words = container->words();
+				ULONG word = index;
+				FB_UINT64 bits = words[word] & mask;
+
+				while (!bits)
+				{
+					if (++word == WORD_COUNT)
+						return false;
+
+					bits = words[word];
+				}
+
+				pos = word * WORD_BITS + lowestBit(bits);
+				return true;
+			}
+			}
+		}
+
+		// Find position of the last value not greater than the given one
+		static bool seekPrev(const Container* container, ULONG value, ULONG& pos)
+		{
+			const ULONG index = value / WORD_BITS;
+			const FB_UINT64 mask = ~FB_UINT64(0) >> (WORD_BITS - 1 - value % WORD_BITS);
+
+			switch (container->kind)
+			{
+			case KIND_ARRAY:
+			{
+				const USHORT* const values = container->values();
+				pos = (ULONG) (std::upper_bound(values, values + container->count, value) - values);
+
+				if (!pos)
+					return false;
+
+				pos--;
+				return true;
+			}
+
+			case KIND_WORDS:
+			{
+				const USHORT* const indexes = container->values();
+				const FB_UINT64* const words = container->words();
+				ULONG entry = (ULONG) (std::upper_bound(indexes, indexes + container->used, index) - indexes);
+
+				if (!entry--)
+					return false;
+
+				FB_UINT64 bits = words[entry];
+
+				if (indexes[entry] == index && !(bits &= mask))
+				{
+					if (!entry--)
+						return false;
+
+					bits = words[entry];
+				}
+
+				pos = entry * WORD_BITS + highestBit(bits);
+				return true;
+			}
+
+			default:
+			{
+				const FB_UINT64* const words = container->words();
+				ULONG word = index;
+				FB_UINT64 bits = words[word] & mask;
+
+				while (!bits)
+				{
+					if (!word)
+						return false;
+
+					bits = words[--word];
+				}
+
+				pos = word * WORD_BITS + highestBit(bits);
+				return true;
+			}
+			}
+		}
+
+		// Move to the next position within the same container
+		static bool stepNext(const Container* container, ULONG& pos)
+		{
+			switch (container->kind)
+			{
+			case KIND_ARRAY:
+				if (pos + 1 >= container->count)
+					return false;
+
+				pos++;
+				return true;
+
+			case KIND_WORDS:
+			{
+				ULONG entry = pos / WORD_BITS;
+				const ULONG bit = pos % WORD_BITS;
+				const FB_UINT64* const words = container->words();
+				FB_UINT64 bits = (bit == WORD_BITS - 1) ? 0 : words[entry] & (~FB_UINT64(0) << (bit + 1));
+
+				if (!bits)
+				{
+					if (++entry == container->used)
+						return false;
+
+					bits = words[entry];
+				}
+
+				pos = entry * WORD_BITS + lowestBit(bits);
+				return true;
+			}
+
+			default:
+				return seekNext(container, pos + 1, pos);
+			}
+		}
+
+		// Move to the previous position within the same container
+		static bool stepPrev(const Container* container, ULONG& pos)
+		{
+			switch (container->kind)
+			{
+			case KIND_ARRAY:
+				if (!pos)
+					return false;
+
+				pos--;
+				return true;
+
+			case KIND_WORDS:
+			{
+				ULONG entry = pos / WORD_BITS;
+				const ULONG bit = pos % WORD_BITS;
+				const FB_UINT64* const words = container->words();
+				FB_UINT64 bits = words[entry] & ((FB_UINT64(1) << bit) - 1);
+
+				if (!bits)
+				{
+					if (!entry--)
+						return false;
+
+					bits = words[entry];
+				}
+
+				pos = entry * WORD_BITS + highestBit(bits);
+				return true;
+			}
+
+			default:
+				return pos && seekPrev(container, pos - 1, pos);
+			}
+		}
+
+		RoaringBitmap* bitmap;
+		ChunkTreeAccessor treeAccessor;
+		ULONG position;
+		T current_value;
+	};
+
+private:
+	Accessor defaultAccessor;
+
+	friend class Accessor;
+};
+
+template <typename T>
+RoaringBitmap<T>** RoaringBitmap<T>::bit_or(RoaringBitmap<T>** bitmap1, RoaringBitmap<T>** bitmap2)
+{
+	RoaringBitmap *map1, *map2;
+
+	// Handle the case when one or the other of the bitmaps is NULL
+	if (!bitmap1 || !(map1 = *bitmap1))
+		return bitmap2;
+
+	if (!bitmap2 || !(map2 = *bitmap2))
+		return bitmap1;
+
+	// Make sure we work on 2 different bitmaps
+	fb_assert(map1 != map2);
+
+	// First bitmap is singular. Set appropriate bit in second and return it
+	if (map1->singular)
+	{
+		map2->set(map1->singular_value);
+		return bitmap2;
+	}
+
+	// Second bitmap is singular. Set appropriate bit in first and return it
+	if (map2->singular)
+	{
+		map1->set(map2->singular_value);
+		return bitmap1;
+	}
+
+	RoaringBitmap *source, *dest, **result;
+
+	// If second bitmap seems larger then use it as a target
+	if (map2->tree.seemsBiggerThan(map1->tree))
+	{
+		dest = map2;
+		source = map1;
+		result = bitmap2;
+	}
+	else
+	{
+		dest = map1;
+		source = map2;
+		result = bitmap1;
+	}
+
+	ChunkTreeAccessor sourceAccessor(&source->tree);
+
+	if (!sourceAccessor.getFirst())
+		return result;
+
+	do {
+		const Chunk& sourceChunk = sourceAccessor.current();
+
+		if (dest->tree.locate(sourceChunk.key))
+			dest->unite(dest->tree.current().container, sourceChunk.container);
+		else
+		{
+			Chunk chunk;
+			chunk.key = sourceChunk.key;
+			chunk.container = dest->copy(sourceChunk.container);
+			dest->tree.add(chunk);
+		}
+	} while (sourceAccessor.getNext());
+
+	return result;
+}
+
+template <typename T>
+RoaringBitmap<T>** RoaringBitmap<T>::bit_and(RoaringBitmap<T>** bitmap1, RoaringBitmap<T>** bitmap2)
+{
+	RoaringBitmap *map1, *map2;
+
+	// Handle the case when one or the other of the bitmaps is NULL
+	if (!bitmap1 || !bitmap2 || !(map1 = *bitmap1) || !(map2 = *bitmap2))
+		return NULL;
+
+	// Make sure we work on 2 different bitmaps
+	fb_assert(map1 != map2);
+
+	// First bitmap is singular. Test appropriate bit in second and return first
+	if (map1->singular)
+	{
+		if (map2->test(map1->singular_value))
+			return bitmap1;
+
+		return NULL;
+	}
+
+	// Second bitmap is singular. Test appropriate bit in first and return second
+	if (map2->singular)
+	{
+		if (map1->test(map2->singular_value))
+			return bitmap2;
+
+		return NULL;
+	}
+
+	RoaringBitmap *source, *dest, **result;
+
+	// If second bitmap seems smaller then use it as a target
+	if (map1->tree.seemsBiggerThan(map2->tree))
+	{
+		dest = map2;
+		source = map1;
+		result = bitmap2;
+	}
+	else
+	{
+		dest = map1;
+		source = map2;
+		result = bitmap1;
+	}
+
+	bool destFound = dest->tree.getFirst();
+
+	while (destFound)
+	{
+		Chunk& destChunk = dest->tree.current();
+
+		if (source->tree.locate(destChunk.key))
+		{
+			dest->intersect(destChunk.container, source->tree.current().container);
+
+			if (destChunk.container->count)
+			{
+				destFound = dest->tree.getNext();
+				continue;
+			}
+		}
+
+		// Nothing left in this chunk
+		dest->release(destChunk.container);
+		destFound = dest->tree.fastRemove();
+	}
+
+	return result;
+}
+
+} // namespace Firebird
+
+#endif	// ROARING_BITMAP_H
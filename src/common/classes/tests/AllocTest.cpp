@@ -0,0 +1,54 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/alloc.h"
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Firebird;
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(AllocSuite)
+
+
+BOOST_AUTO_TEST_SUITE(AllocTests)
+
+BOOST_AUTO_TEST_CASE(ThreadCacheStatsTest)
+{
+	MemoryStats stats;
+	MemoryPool* pool = MemoryPool::createPool(NULL, stats);
+	pool->enableThreadCache();
+
+	std::vector<void*> blocks;
+	std::mt19937 rnd(1);
+
+	for (unsigned i = 0; i < 10000; i++)
+		blocks.push_back(pool->allocate(1 + rnd() % 2000));
+
+	const size_t used = stats.getCurrentUsage();
+	BOOST_TEST(used > 0u);
+
+	// Released blocks stay in the thread cache but are not accounted as used
+	for (unsigned i = 0; i < blocks.size(); i += 2)
+		pool->deallocate(blocks[i]);
+
+	BOOST_TEST(stats.getCurrentUsage() < used);
+
+	// Release in another thread
+	std::thread([&]() {
+		for (unsigned i = 1; i < blocks.size(); i += 2)
+			pool->deallocate(blocks[i]);
+	}).join();
+
+	BOOST_TEST(stats.getCurrentUsage() == 0u);
+
+	MemoryPool::deletePool(pool);
+	BOOST_TEST(stats.getCurrentMapping() == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// AllocTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// AllocSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
@@ -0,0 +1,89 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/BloomFilter.h"
+#include "../common/classes/Hash.h"
+
+using namespace Firebird;
+
+namespace
+{
+	ULONG hashOf(ULONG key)
+	{
+		return InternalHash::hash(sizeof(key), reinterpret_cast<const UCHAR*>(&key));
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(BloomFilterSuite)
+
+
+BOOST_AUTO_TEST_SUITE(BloomFilterTests)
+
+BOOST_AUTO_TEST_CASE(NoFalseNegativesTest)
+{
+	for (const ULONG count : {1u, 10u, 1000u, 100000u})
+	{
+		BloomFilter filter(*getDefaultMemoryPool(), count);
+
+		for (ULONG key = 0; key < count; key++)
+			filter.add(hashOf(key * 3));
+
+		for (ULONG key = 0; key < count; key++)
+		{
+			if (!filter.check(hashOf(key * 3)))
+			{
+				BOOST_TEST_INFO("count " << count << ", key " << key * 3);
+				BOOST_TEST(false);
+				break;
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FalsePositivesTest)
+{
+	constexpr ULONG COUNT = 100000;
+
+	BloomFilter filter(*getDefaultMemoryPool(), COUNT);
+
+	for (ULONG key = 0; key < COUNT; key++)
+		filter.add(hashOf(key));
+
+	ULONG positives = 0;
+
+	for (ULONG key = COUNT; key < COUNT * 11; key++)
+	{
+		if (filter.check(hashOf(key)))
+			positives++;
+	}
+
+	// About 3% with 8 bits per key and three probes, allow some slack
+	const double rate = double(positives) / (COUNT * 10);
+
+	BOOST_TEST_MESSAGE("Bloom filter false positives: " << rate * 100 << "%");
+	BOOST_TEST(rate < 0.06);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyTest)
+{
+	BloomFilter filter(*getDefaultMemoryPool(), 0);
+
+	for (ULONG key = 0; key < 1000; key++)
+		BOOST_TEST(!filter.check(hashOf(key)));
+}
+
+BOOST_AUTO_TEST_CASE(SizeTest)
+{
+	BOOST_TEST(BloomFilter(*getDefaultMemoryPool(), 0).getSize() == 8u);
+	BOOST_TEST(BloomFilter(*getDefaultMemoryPool(), 1000).getSize() == 1024u);
+
+	// Size is limited, so the filter just gets less selective for large sets
+	BOOST_TEST(BloomFilter(*getDefaultMemoryPool(), MAX_ULONG).getSize() == 1024u * 1024u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// BloomFilterTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BloomFilterSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
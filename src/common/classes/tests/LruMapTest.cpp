@@ -0,0 +1,163 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/LruMap.h"
+#include "../common/classes/array.h"
+#include <string>
+
+using namespace Firebird;
+
+namespace
+{
+	typedef LruMap<int, int> IntMap;
+
+	// Keys of the entries in the list order
+	std::string keysOf(const IntMap::EntryList& list)
+	{
+		std::string keys;
+
+		for (const auto& entry : list)
+		{
+			if (keys.length())
+				keys += ',';
+
+			keys += std::to_string(entry.key);
+		}
+
+		return keys;
+	}
+
+	// Value using the pool of its container
+	struct PooledValue
+	{
+		explicit PooledValue(MemoryPool& p)
+			: items(p)
+		{
+		}
+
+		PooledValue(MemoryPool& p, PooledValue&& o)
+			: items(p, o.items)
+		{
+		}
+
+		Array<int> items;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(LruMapSuite)
+
+
+BOOST_AUTO_TEST_SUITE(LruMapTests)
+
+BOOST_AUTO_TEST_CASE(PutGetTest)
+{
+	IntMap map(*getDefaultMemoryPool());
+
+	BOOST_TEST(map.isEmpty());
+	BOOST_TEST(!map.get(1));
+
+	BOOST_TEST(map.put(1, 10, 100));
+	BOOST_TEST(map.put(2, 20, 200));
+
+	// Key already present
+	BOOST_TEST(!map.put(1, 11, 100));
+
+	BOOST_TEST(map.getCount() == 2u);
+	BOOST_TEST(map.getSize() == 300u);
+	BOOST_TEST_REQUIRE(map.get(1));
+	BOOST_TEST(*map.get(1) == 10);
+	BOOST_TEST(*map.get(2) == 20);
+	BOOST_TEST(!map.get(3));
+
+	*map.get(1) = 12;
+	BOOST_TEST(*map.get(1) == 12);
+}
+
+BOOST_AUTO_TEST_CASE(ShrinkTest)
+{
+	IntMap map(*getDefaultMemoryPool());
+	IntMap::EntryList evicted(*getDefaultMemoryPool());
+
+	for (int i = 1; i <= 5; i++)
+		map.put(i, i * 10, 100);
+
+	// Nothing to do within the limit
+	map.shrink(500, evicted);
+	BOOST_TEST(evicted.isEmpty());
+	BOOST_TEST(map.getCount() == 5u);
+
+	// Lookup makes the entries the most recently used ones
+	map.get(2);
+	map.get(1);
+
+	map.shrink(300, evicted);
+	BOOST_TEST(keysOf(evicted) == "3,4");
+	BOOST_TEST(map.getCount() == 3u);
+	BOOST_TEST(map.getSize() == 300u);
+	BOOST_TEST(!map.get(3));
+	BOOST_TEST(!map.get(4));
+
+	map.put(6, 60, 250);
+	map.shrink(300, evicted);
+	BOOST_TEST(keysOf(evicted) == "3,4,5,2,1");
+	BOOST_TEST(map.getSize() == 250u);
+	BOOST_TEST(*map.get(6) == 60);
+
+	// Entry larger than the limit is evicted too
+	map.shrink(200, evicted);
+	BOOST_TEST(map.isEmpty());
+	BOOST_TEST(map.getSize() == 0u);
+
+	// Zero limit doesn't keep anything
+	map.put(7, 70, 1);
+	map.shrink(0, evicted);
+	BOOST_TEST(map.isEmpty());
+	BOOST_TEST(keysOf(evicted) == "3,4,5,2,1,6,7");
+}
+
+BOOST_AUTO_TEST_CASE(RemoveClearTest)
+{
+	IntMap map(*getDefaultMemoryPool());
+	IntMap::EntryList removed(*getDefaultMemoryPool());
+
+	for (int i = 1; i <= 4; i++)
+		map.put(i, i * 10, 10);
+
+	BOOST_TEST(map.remove(2, removed));
+	BOOST_TEST(!map.remove(2, removed));
+	BOOST_TEST(keysOf(removed) == "2");
+	BOOST_TEST(removed.front().value == 20);
+	BOOST_TEST(map.getSize() == 30u);
+
+	// Removed key may be added again
+	BOOST_TEST(map.put(2, 21, 10));
+	BOOST_TEST(*map.get(2) == 21);
+
+	map.clear(removed);
+	BOOST_TEST(map.isEmpty());
+	BOOST_TEST(map.getSize() == 0u);
+	BOOST_TEST(keysOf(removed) == "2,1,3,4,2");
+	BOOST_TEST(!map.get(1));
+}
+
+BOOST_AUTO_TEST_CASE(PooledValueTest)
+{
+	LruMap<int, PooledValue> map(*getDefaultMemoryPool());
+
+	PooledValue value(*getDefaultMemoryPool());
+	value.items.add(1);
+	value.items.add(2);
+
+	BOOST_TEST(map.put(1, std::move(value), 5));
+	BOOST_TEST_REQUIRE(map.get(1));
+	BOOST_TEST(map.get(1)->items.getCount() == 2u);
+	BOOST_TEST(map.get(1)->items[1] == 2);
+	BOOST_TEST(!map.get(2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// LruMapTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// LruMapSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
@@ -0,0 +1,238 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/roaring_bitmap.h"
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace Firebird;
+
+namespace
+{
+	typedef RoaringBitmap<FB_UINT64> Bitmap;
+	typedef std::set<FB_UINT64> ValueSet;
+
+	// Record numbers of a table with the given number of records per data page,
+	// every record matching the predicate with the given probability
+	void fillRecords(Bitmap& bitmap, std::vector<FB_UINT64>& values, unsigned pages,
+		unsigned perPage, double selectivity, unsigned seed, unsigned firstPage = 0)
+	{
+		constexpr unsigned MAX_RECORDS = 500;	// slots per data page
+		std::mt19937 rnd(seed);
+		std::uniform_real_distribution<double> dist(0, 1);
+
+		for (unsigned page = firstPage; page < firstPage + pages; page++)
+		{
+			for (unsigned line = 0; line < perPage; line++)
+			{
+				if (dist(rnd) < selectivity)
+				{
+					const FB_UINT64 number = (FB_UINT64) page * MAX_RECORDS + line;
+					bitmap.set(number);
+					values.push_back(number);
+				}
+			}
+		}
+	}
+
+	void checkContents(Bitmap& bitmap, const ValueSet& values)
+	{
+		Bitmap::Accessor accessor(&bitmap);
+		auto iter = values.begin();
+
+		if (accessor.getFirst())
+		{
+			do {
+				BOOST_REQUIRE(iter != values.end());
+				BOOST_REQUIRE_EQUAL(accessor.current(), *iter);
+				++iter;
+			} while (accessor.getNext());
+		}
+
+		BOOST_REQUIRE(iter == values.end());
+
+		// And backwards
+
+		auto riter = values.rbegin();
+
+		if (accessor.getLast())
+		{
+			do {
+				BOOST_REQUIRE(riter != values.rend());
+				BOOST_REQUIRE_EQUAL(accessor.current(), *riter);
+				++riter;
+			} while (accessor.getPrev());
+		}
+
+		BOOST_REQUIRE(riter == values.rend());
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(RoaringBitmapSuite)
+
+
+BOOST_AUTO_TEST_SUITE(RoaringBitmapTests)
+
+BOOST_AUTO_TEST_CASE(SetClearTest)
+{
+	// Sparse and dense chunks, with conversions between containers in both directions
+	for (const unsigned step : {1u, 3u, 17u, 1000u})
+	{
+		Bitmap bitmap(*getDefaultMemoryPool());
+		ValueSet values;
+		std::mt19937 rnd(step);
+
+		for (unsigned i = 0; i < 40000; i++)
+		{
+			const FB_UINT64 value = (FB_UINT64) (rnd() % 65536) * step + (rnd() % 3) * 65536 * 100;
+			bitmap.set(value);
+			values.insert(value);
+		}
+
+		checkContents(bitmap, values);
+
+		for (unsigned i = 0; i < 200000; i++)
+		{
+			const FB_UINT64 value = (FB_UINT64) (rnd() % 65536) * step + (rnd() % 3) * 65536 * 100;
+			BOOST_REQUIRE_EQUAL(bitmap.test(value), values.count(value) != 0);
+		}
+
+		std::vector<FB_UINT64> sorted(values.begin(), values.end());
+		std::shuffle(sorted.begin(), sorted.end(), rnd);
+
+		for (unsigned i = 0; i < sorted.size(); i++)
+		{
+			if (i % 4 == 0)
+				continue;
+
+			BOOST_REQUIRE(bitmap.clear(sorted[i]));
+			BOOST_REQUIRE(!bitmap.clear(sorted[i]));
+			values.erase(sorted[i]);
+		}
+
+		checkContents(bitmap, values);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(LocateTest)
+{
+	Bitmap bitmap(*getDefaultMemoryPool());
+	ValueSet values;
+
+	std::vector<FB_UINT64> numbers;
+	fillRecords(bitmap, numbers, 1000, 300, 0.05, 1);			// arrays
+	fillRecords(bitmap, numbers, 1000, 100, 0.5, 2, 1000);		// word lists
+	fillRecords(bitmap, numbers, 2000, 480, 0.9, 3, 2000);		// bitsets
+	values.insert(numbers.begin(), numbers.end());
+
+	Bitmap::Accessor accessor(&bitmap);
+	std::mt19937 rnd(4);
+
+	for (unsigned i = 0; i < 100000; i++)
+	{
+		const FB_UINT64 key = rnd() % (4000 * 500 + 1000);
+
+		BOOST_REQUIRE_EQUAL(accessor.locate(locEqual, key), values.count(key) != 0);
+
+		auto iter = values.lower_bound(key);
+		BOOST_REQUIRE_EQUAL(accessor.locate(locGreatEqual, key), iter != values.end());
+		if (iter != values.end())
+			BOOST_REQUIRE_EQUAL(accessor.current(), *iter);
+
+		iter = values.upper_bound(key);
+		BOOST_REQUIRE_EQUAL(accessor.locate(locGreat, key), iter != values.end());
+		if (iter != values.end())
+			BOOST_REQUIRE_EQUAL(accessor.current(), *iter);
+
+		iter = values.upper_bound(key);
+		const bool hasLessEqual = iter != values.begin();
+		BOOST_REQUIRE_EQUAL(accessor.locate(locLessEqual, key), hasLessEqual);
+		if (hasLessEqual)
+			BOOST_REQUIRE_EQUAL(accessor.current(), *--iter);
+
+		iter = values.lower_bound(key);
+		const bool hasLess = iter != values.begin();
+		BOOST_REQUIRE_EQUAL(accessor.locate(locLess, key), hasLess);
+		if (hasLess)
+			BOOST_REQUIRE_EQUAL(accessor.current(), *--iter);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CombineTest)
+{
+	for (const double selectivity1 : {0.001, 0.05, 0.5, 1.0})
+	{
+		for (const double selectivity2 : {0.001, 0.05, 0.5, 1.0})
+		{
+			std::vector<FB_UINT64> numbers1, numbers2;
+
+			Bitmap* map1 = FB_NEW_POOL(*getDefaultMemoryPool()) Bitmap(*getDefaultMemoryPool());
+			Bitmap* map2 = FB_NEW_POOL(*getDefaultMemoryPool()) Bitmap(*getDefaultMemoryPool());
+			fillRecords(*map1, numbers1, 1500, 480, selectivity1, 1);
+			fillRecords(*map2, numbers2, 1000, 200, selectivity2, 2);
+
+			ValueSet set1(numbers1.begin(), numbers1.end()), set2(numbers2.begin(), numbers2.end());
+			ValueSet expected;
+
+			// Union
+
+			std::set_union(set1.begin(), set1.end(), set2.begin(), set2.end(),
+				std::inserter(expected, expected.end()));
+
+			Bitmap** result = Bitmap::bit_or(&map1, &map2);
+			BOOST_REQUIRE(result);
+			checkContents(**result, expected);
+
+			// Intersection, one of the bitmaps is now the union
+
+			const ValueSet& other = (result == &map1) ? set2 : set1;
+			ValueSet expectedAnd;
+
+			std::set_intersection(expected.begin(), expected.end(), other.begin(), other.end(),
+				std::inserter(expectedAnd, expectedAnd.end()));
+
+			result = Bitmap::bit_and(&map1, &map2);
+			BOOST_REQUIRE(result);
+			checkContents(**result, expectedAnd);
+
+			delete map1;
+			delete map2;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SingularTest)
+{
+	Bitmap* map1 = FB_NEW_POOL(*getDefaultMemoryPool()) Bitmap(*getDefaultMemoryPool());
+	Bitmap* map2 = FB_NEW_POOL(*getDefaultMemoryPool()) Bitmap(*getDefaultMemoryPool());
+
+	map1->set(100);
+	BOOST_TEST(map1->test(100));
+	BOOST_TEST(map1->getFirst());
+	BOOST_TEST(map1->current() == 100u);
+	BOOST_TEST(!map1->getNext());
+
+	map2->set(5);
+	map2->set(100);
+	map2->set(1000000);
+
+	BOOST_TEST(Bitmap::bit_and(&map1, &map2) == &map1);
+
+	Bitmap** result = Bitmap::bit_or(&map1, &map2);
+	BOOST_TEST(result == &map2);
+	checkContents(**result, ValueSet{5, 100, 1000000});
+
+	map1->clear();
+	BOOST_TEST(!map1->getFirst());
+
+	delete map1;
+	delete map2;
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// RoaringBitmapTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// RoaringBitmapSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
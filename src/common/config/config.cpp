@@ -359,6 +359,10 @@ void Config::checkValues()
 {
 	checkIntForLoBound(KEY_TEMP_CACHE_LIMIT, 0, true);
 
+	checkIntForLoBound(KEY_UNDO_CACHE_LIMIT, 0, true);
+	checkIntForLoBound(KEY_STATEMENT_TEMP_CACHE_LIMIT, 0, true);
+	checkIntForLoBound(KEY_ATTACHMENT_TEMP_CACHE_LIMIT, 0, true);
+
 	checkIntForLoBound(KEY_TCP_REMOTE_BUFFER_SIZE, 1448, false);
 	checkIntForHiBound(KEY_TCP_REMOTE_BUFFER_SIZE, MAX_SSHORT, false);
 
@@ -419,6 +423,11 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_MAX_STATEMENT_CACHE_SIZE, 0, true);
 
+	checkIntForLoBound(KEY_SHARED_STATEMENT_CACHE_SIZE, 0, true);
+	checkIntForHiBound(KEY_SHARED_STATEMENT_CACHE_SIZE, MAX_ULONG, true);
+
+	checkIntForLoBound(KEY_MONITORING_PUBLISH_INTERVAL, 0, true);
+
 	checkIntForLoBound(KEY_MAX_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_MAX_PARALLEL_WORKERS, 64, false);	// todo: detect number of available cores
 
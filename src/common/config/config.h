@@ -187,6 +187,13 @@ enum ConfigKey
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
 	KEY_ALLOW_UPDATE_OVERWRITE,
+	KEY_MONITORING_PUBLISH_INTERVAL,
+	KEY_INSERT_PAGE_PER_ATTACHMENT,
+	KEY_UNDO_CACHE_LIMIT,
+	KEY_STATEMENT_TEMP_CACHE_LIMIT,
+	KEY_ATTACHMENT_TEMP_CACHE_LIMIT,
+	KEY_SHARED_STATEMENT_CACHE_SIZE,
+	KEY_SORT_COMPRESSION,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +307,14 @@ inline constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
 	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
-	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true}
+	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true},
+	{TYPE_INTEGER,	"MonitoringPublishInterval",	false,	0},		// seconds
+	{TYPE_BOOLEAN,	"InsertPagePerAttachment",	false,	false},
+	{TYPE_INTEGER,	"UndoCacheLimit",			false,	16 * 1048576},	// bytes
+	{TYPE_INTEGER,	"StatementTempCacheLimit",	false,	0},		// bytes
+	{TYPE_INTEGER,	"AttachmentTempCacheLimit",	false,	0},		// bytes
+	{TYPE_INTEGER,	"SharedStatementCacheSize",	false,	8 * 1048576},	// bytes
+	{TYPE_BOOLEAN,	"SortCompression",			false,	false}
 };
 
 
@@ -623,6 +637,23 @@ public:
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
 
 	CONFIG_GET_PER_DB_BOOL(getAllowUpdateOverwrite, KEY_ALLOW_UPDATE_OVERWRITE);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getMonitoringPublishInterval, KEY_MONITORING_PUBLISH_INTERVAL, getInt);
+
+	CONFIG_GET_PER_DB_BOOL(getInsertPagePerAttachment, KEY_INSERT_PAGE_PER_ATTACHMENT);
+
+	// Memory caching limit for the undo log of a transaction
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getUndoCacheLimit, KEY_UNDO_CACHE_LIMIT, getInt);
+
+	// Memory caching limits for sorts and record buffers of a statement and of an attachment
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getStatementTempCacheLimit, KEY_STATEMENT_TEMP_CACHE_LIMIT, getInt);
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getAttachmentTempCacheLimit, KEY_ATTACHMENT_TEMP_CACHE_LIMIT, getInt);
+
+	// Memory used to cache DSQL statements shared by attachments
+	CONFIG_GET_PER_DB_KEY(ULONG, getSharedStatementCacheSize, KEY_SHARED_STATEMENT_CACHE_SIZE, getInt);
+
+	// Compress sort runs written to temporary files
+	CONFIG_GET_PER_DB_BOOL(getSortCompression, KEY_SORT_COMPRESSION);
 };
 
 // Implementation of interface to access master configuration file
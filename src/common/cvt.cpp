@@ -36,8 +36,11 @@
  */
 
 #include "firebird.h"
+#include <charconv>
 #include <cmath>
 #include <cstddef>
+#include <limits>
+#include <type_traits>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -178,6 +181,7 @@ public:
 	virtual void nextDigit(unsigned digit, unsigned base) = 0;
 	virtual bool isLowerLimit() = 0;
 	virtual void neg() = 0;
+	virtual bool setValue(FB_UINT64 magnitude, bool negative) = 0;
 };
 
 template <class Traits>
@@ -237,6 +241,26 @@ public:
 		value = -value;
 	}
 
+	// Magnitude is expected to fit into SINT64, returns false if the value does not fit
+	bool setValue(FB_UINT64 magnitude, bool negative) override
+	{
+		typedef typename Traits::ValueType ValueType;
+
+		const SINT64 v = negative ? -SINT64(magnitude) : SINT64(magnitude);
+
+		if constexpr (std::is_integral_v<ValueType>)
+		{
+			if (v > std::numeric_limits<ValueType>::max() || v < std::numeric_limits<ValueType>::min())
+				return false;
+
+			value = static_cast<ValueType>(v);
+		}
+		else
+			value.set(v, 0);
+
+		return true;
+	}
+
 protected:
 	typename Traits::ValueType value;
 	typename Traits::ValueType* return_value;
@@ -248,6 +272,44 @@ static constexpr double eps_double = 1e-14;
 static constexpr double eps_float  = 1e-5;
 
 
+// Convert eight decimal digits at once, returns false if any of the characters is not a digit
+static inline bool parse_eight_digits(const char* p, ULONG* result)
+{
+#ifndef WORDS_BIGENDIAN
+	FB_UINT64 chunk;
+	memcpy(&chunk, p, sizeof(chunk));
+
+	if ((chunk & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030 ||
+		((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030)
+	{
+		return false;
+	}
+
+	// Combine adjacent digits into pairs, then pairs into quads and quads into the result
+	chunk -= 0x3030303030303030;
+	chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FF;
+	chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFF;
+	chunk = (chunk * 10000 + (chunk >> 32)) & 0xFFFFFFFF;
+
+	*result = static_cast<ULONG>(chunk);
+#else
+	ULONG value = 0;
+
+	for (const char* const end = p + 8; p < end; p++)
+	{
+		if (!DIGIT(*p))
+			return false;
+
+		value = value * 10 + (*p - '0');
+	}
+
+	*result = value;
+#endif
+
+	return true;
+}
+
+
 static void validateTimeStamp(const ISC_TIMESTAMP timestamp, const EXPECT_DATETIME expectedType, const dsc* desc,
 	Callbacks* cb)
 {
@@ -576,20 +638,20 @@ static void integer_to_text(const dsc* from, dsc* to, Callbacks* cb)
 		u = -n;
 	}
 
-    string temp;
+	// Leave room in front of the digits for the leading zeroes added below
 
-	do {
-		temp += (u % 10) + '0';
-		u /= 10;
-	} while (u);
+	char temp[MAX_SCHAR + 1 + std::numeric_limits<FB_UINT64>::digits10 + 1];
+	char* const digits = temp + MAX_SCHAR + 1;
+	const char* const digitsEnd = std::to_chars(digits, temp + sizeof(temp), u).ptr;
+	char* p = digits;
 
-	SSHORT l = (SSHORT) temp.length();
+	SSHORT l = (SSHORT) (digitsEnd - digits);
 
 	// if scale < 0, we need at least abs(scale)+1 digits, so add
 	// any leading zeroes required.
 	while (l + scale <= 0)
 	{
-		temp += '0';
+		*--p = '0';
 		l++;
 	}
 	// postassertion: l+scale > 0
@@ -608,7 +670,6 @@ static void integer_to_text(const dsc* from, dsc* to, Callbacks* cb)
 	    CVT_conversion_error(from, cb->err);
 	}
 
-	const UCHAR* p = (UCHAR*) temp.c_str() + temp.length();
 	UCHAR* q = (to->dsc_dtype == dtype_varying) ? to->dsc_address + sizeof(USHORT) : to->dsc_address;
 	const UCHAR* start = q;
 
@@ -621,20 +682,17 @@ static void integer_to_text(const dsc* from, dsc* to, Callbacks* cb)
 
 	if (scale >= 0)
 	{
-		do {
-			*q++ = *--p;
-		} while (--l);
+		memcpy(q, p, l);
+		q += l;
 	}
 	else
 	{
 		l += scale;	// l > 0 (see postassertion: l + scale > 0 above)
-		do {
-			*q++ = *--p;
-		} while (--l);
+		memcpy(q, p, l);
+		q += l;
 		*q++ = '.';
-		do {
-			*q++ = *--p;
-		} while (++scale);
+		memcpy(q, p + l, -scale);
+		q += -scale;
 	}
 
 	length = cb->validateLength(cb->getToCharset(to->getCharSet()), to->getCharSet(), length, start, TEXT_LEN(to));
@@ -1508,6 +1566,19 @@ double CVT_get_double(const dsc* desc, DecimalStatus decSt, ErrorFunction err, b
 				{
 					digit_seen = true;
 					past_sign = true;
+
+					// Take eight digits at once while the accumulated value is exact,
+					// result is the same as when adding them one by one
+					ULONG digits;
+					if (value < 1e7 && end - p >= 8 && parse_eight_digits(p, &digits))
+					{
+						if (fraction)
+							scale += 8;
+						value = value * 1e8 + digits;
+						p += 7;
+						continue;
+					}
+
 					if (fraction)
 						scale++;
 					value = value * 10. + (*p - '0');
@@ -2675,6 +2746,73 @@ double CVT_power_of_ten(const int scale)
 
 static void hex_to_value(const char*& string, const char* end, RetPtr* retValue);
 
+static bool decompose_decimal(const char* p, const char* end, RetPtr* return_value, SSHORT* scale)
+{
+/**************************************
+ *
+ *      d e c o m p o s e _ d e c i m a l
+ *
+ **************************************
+ *
+ * Functional description
+ *      Fast path for the plain [+|-]digits[.digits] numbers
+ *      short enough to never overflow 64-bit integer.
+ *      Returns false leaving the value untouched if the
+ *      string should be processed by the generic code.
+ *
+ **************************************/
+	constexpr unsigned MAX_DIGITS = std::numeric_limits<SINT64>::digits10;
+
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = (*p++ == '-');
+
+	FB_UINT64 magnitude = 0;
+	unsigned count = 0;
+
+	const auto digitRun = [&]() -> unsigned
+	{
+		const char* const start = p;
+		ULONG digits;
+
+		while (end - p >= 8 && count + 8 <= MAX_DIGITS && parse_eight_digits(p, &digits))
+		{
+			magnitude = magnitude * 100000000 + digits;
+			count += 8;
+			p += 8;
+		}
+
+		while (p < end && DIGIT(*p) && count < MAX_DIGITS)
+		{
+			magnitude = magnitude * 10 + (*p++ - '0');
+			count++;
+		}
+
+		return static_cast<unsigned>(p - start);
+	};
+
+	digitRun();
+
+	unsigned fractionDigits = 0;
+	if (p < end && *p == '.')
+	{
+		p++;
+		fractionDigits = digitRun();
+	}
+
+	// Nothing but trailing spaces is allowed after the number,
+	// too long numbers and exponents are left for the generic code
+
+	while (p < end && *p == ' ')
+		++p;
+
+	if (p != end || count == 0 || !return_value->setValue(magnitude, negative))
+		return false;
+
+	*scale = -static_cast<SSHORT>(fractionDigits);
+	return true;
+}
+
 static SSHORT cvt_decompose(const char*	string,
 							USHORT		length,
 							RetPtr*		return_value,
@@ -2751,6 +2889,9 @@ static SSHORT cvt_decompose(const char*	string,
 		return 0; // 0 scale for hex literals
 	}
 
+	if (decompose_decimal(p, end, return_value, &scale))
+		return scale;
+
 	for (; p < end; p++)
 	{
 		if (DIGIT(*p))
@@ -324,6 +324,24 @@ namespace os_utils
 	}
 #endif
 
+#ifdef HAVE_POSIX_FALLOCATE
+	inline int posix_fallocate(int fd, off_t offset, off_t len)
+	{
+		int rc;
+
+		do
+		{
+#ifdef LSB_BUILD
+			rc = posix_fallocate64(fd, offset, len);
+#else
+			rc = ::posix_fallocate(fd, offset, len);
+#endif
+		} while (rc != 0 && SYSCALL_INTERRUPTED(rc));
+
+		return rc;
+	}
+#endif
+
 	inline int getrlimit(int resource, struct rlimit* rlim)
 	{
 		int rc;
@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstring>
 #include <source_location>
+#include <string>
 #include "../common/tests/CvtTestUtils.h"
 
 #include "../common/StatusArg.h"
@@ -789,4 +790,125 @@ BOOST_AUTO_TEST_SUITE_END()	// FunctionalTest
 BOOST_AUTO_TEST_SUITE_END()	// CVTStringToFormatDateTime
 
 BOOST_AUTO_TEST_SUITE_END() // CVTDatetimeFormat
+
+
+BOOST_AUTO_TEST_SUITE(CVTNumberConversion)
+
+static void errFunc(const Firebird::Arg::StatusVector& v)
+{
+	v.raise();
+}
+
+MockCallback cb(errFunc, std::bind(mockGetLocalDate, 2023));
+
+static SINT64 stringToInt64(const std::string& str, SSHORT scale = 0)
+{
+	dsc desc;
+	desc.makeText(static_cast<USHORT>(str.length()), ttype_ascii,
+		reinterpret_cast<UCHAR*>(const_cast<char*>(str.c_str())));
+
+	return CVT_get_int64(&desc, scale, DecimalStatus::DEFAULT, errFunc);
+}
+
+static SLONG stringToLong(const std::string& str, SSHORT scale = 0)
+{
+	dsc desc;
+	desc.makeText(static_cast<USHORT>(str.length()), ttype_ascii,
+		reinterpret_cast<UCHAR*>(const_cast<char*>(str.c_str())));
+
+	return CVT_get_long(&desc, scale, DecimalStatus::DEFAULT, errFunc);
+}
+
+static double stringToDouble(const std::string& str)
+{
+	dsc desc;
+	desc.makeText(static_cast<USHORT>(str.length()), ttype_ascii,
+		reinterpret_cast<UCHAR*>(const_cast<char*>(str.c_str())));
+
+	return CVT_get_double(&desc, DecimalStatus::DEFAULT, errFunc);
+}
+
+static std::string int64ToString(SINT64 value, SCHAR scale = 0)
+{
+	dsc from;
+	from.makeInt64(scale, &value);
+
+	UCHAR buffer[sizeof(USHORT) + 200];
+	dsc to;
+	to.makeVarying(sizeof(buffer) - sizeof(USHORT), ttype_ascii, buffer);
+
+	CVT_move_common(&from, &to, DecimalStatus::DEFAULT, &cb);
+
+	const vary* v = reinterpret_cast<const vary*>(buffer);
+	return std::string(v->vary_string, v->vary_length);
+}
+
+
+BOOST_AUTO_TEST_SUITE(FunctionalTest)
+
+BOOST_AUTO_TEST_CASE(CVTStringToIntegerTest)
+{
+	BOOST_TEST(stringToInt64("0") == 0);
+	BOOST_TEST(stringToInt64("-0") == 0);
+	BOOST_TEST(stringToInt64("  123  ") == 123);
+	BOOST_TEST(stringToInt64("+12345678") == 12345678);
+	BOOST_TEST(stringToInt64("-123456789012345678") == -123456789012345678);
+	BOOST_TEST(stringToInt64("9223372036854775807") == MAX_SINT64);
+	BOOST_TEST(stringToInt64("-9223372036854775808") == MIN_SINT64);
+	BOOST_TEST(stringToInt64("0000000000000000000000001") == 1);
+	BOOST_TEST(stringToInt64("0x10") == 16);
+	BOOST_TEST(stringToInt64("12e3") == 12000);
+
+	// Fractional digits are rounded according to the scale
+	BOOST_TEST(stringToInt64("123.456", -2) == 12346);
+	BOOST_TEST(stringToInt64("-123.456", -2) == -12346);
+	BOOST_TEST(stringToInt64(".5", -1) == 5);
+	BOOST_TEST(stringToInt64("5.", -1) == 50);
+	BOOST_TEST(stringToInt64("12345678.87654321", -8) == 1234567887654321);
+
+	BOOST_TEST(stringToLong("2147483647") == MAX_SLONG);
+	BOOST_TEST(stringToLong("-2147483648") == MIN_SLONG);
+	BOOST_TEST(stringToLong("2147483647.000") == MAX_SLONG);
+
+	BOOST_CHECK_THROW(stringToLong("2147483648"), Exception);
+	BOOST_CHECK_THROW(stringToInt64("9223372036854775808"), Exception);
+	BOOST_CHECK_THROW(stringToInt64(""), Exception);
+	BOOST_CHECK_THROW(stringToInt64("-"), Exception);
+	BOOST_CHECK_THROW(stringToInt64("."), Exception);
+	BOOST_CHECK_THROW(stringToInt64("- 1"), Exception);
+	BOOST_CHECK_THROW(stringToInt64("1 2"), Exception);
+	BOOST_CHECK_THROW(stringToInt64("1.2.3"), Exception);
+	BOOST_CHECK_THROW(stringToInt64("12345678x"), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(CVTStringToDoubleTest)
+{
+	BOOST_TEST(stringToDouble("0") == 0.0);
+	BOOST_TEST(stringToDouble("-1.5") == -1.5);
+	BOOST_TEST(stringToDouble("  12345678  ") == 12345678.0);
+	BOOST_TEST(stringToDouble("123456789012345") == 123456789012345.0);
+	BOOST_TEST(stringToDouble("1234567.25") == 1234567.25);
+	BOOST_TEST(stringToDouble("1.5e3") == 1500.0);
+
+	BOOST_CHECK_THROW(stringToDouble("1.2.3"), Exception);
+	BOOST_CHECK_THROW(stringToDouble("12345678x"), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(CVTIntegerToStringTest)
+{
+	BOOST_TEST(int64ToString(0) == "0");
+	BOOST_TEST(int64ToString(-7) == "-7");
+	BOOST_TEST(int64ToString(MAX_SINT64) == "9223372036854775807");
+	BOOST_TEST(int64ToString(MIN_SINT64) == "-9223372036854775808");
+	BOOST_TEST(int64ToString(12345, -2) == "123.45");
+	BOOST_TEST(int64ToString(-5, -3) == "-0.005");
+	BOOST_TEST(int64ToString(0, -2) == "0.00");
+	BOOST_TEST(int64ToString(123, 2) == "12300");
+	BOOST_TEST(int64ToString(MIN_SINT64, -18) == "-9.223372036854775808");
+	BOOST_TEST(int64ToString(1, -100) == "0." + std::string(99, '0') + "1");
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// FunctionalTest
+
+BOOST_AUTO_TEST_SUITE_END() // CVTNumberConversion
 BOOST_AUTO_TEST_SUITE_END()	// CVTSuite
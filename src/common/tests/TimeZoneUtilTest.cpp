@@ -0,0 +1,117 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/TimeZoneUtil.h"
+#include "../common/classes/timestamp.h"
+#include <cstring>
+
+using namespace Firebird;
+
+namespace
+{
+	USHORT region(const char* name)
+	{
+		return TimeZoneUtil::parseRegion(name, static_cast<unsigned>(strlen(name)));
+	}
+
+	ISC_TIMESTAMP makeTimeStamp(int year, int month, int day, int hours, int minutes, int seconds = 0)
+	{
+		struct tm times;
+		memset(&times, 0, sizeof(times));
+		times.tm_year = year - 1900;
+		times.tm_mon = month - 1;
+		times.tm_mday = day;
+		times.tm_hour = hours;
+		times.tm_min = minutes;
+		times.tm_sec = seconds;
+
+		return NoThrowTimeStamp::encode_timestamp(&times);
+	}
+
+	SSHORT utcOffset(const ISC_TIMESTAMP& utc, USHORT timeZone)
+	{
+		ISC_TIMESTAMP_TZ timeStampTz;
+		timeStampTz.utc_timestamp = utc;
+		timeStampTz.time_zone = timeZone;
+
+		SSHORT offset;
+		TimeZoneUtil::extractOffset(timeStampTz, &offset);
+		return offset;
+	}
+
+	SINT64 utcTicks(int year, int month, int day, int hours, int minutes, int seconds = 0)
+	{
+		return TimeStamp::timeStampToTicks(makeTimeStamp(year, month, day, hours, minutes, seconds));
+	}
+
+	SINT64 localToUtc(const ISC_TIMESTAMP& local, USHORT timeZone)
+	{
+		ISC_TIMESTAMP_TZ timeStampTz;
+		timeStampTz.utc_timestamp = local;
+		timeStampTz.time_zone = timeZone;
+
+		TimeZoneUtil::localTimeStampToUtc(timeStampTz);
+		return TimeStamp::timeStampToTicks(timeStampTz.utc_timestamp);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(TimeZoneUtilSuite)
+
+
+BOOST_AUTO_TEST_SUITE(TimeZoneUtilTests)
+
+BOOST_AUTO_TEST_CASE(RegionUtcOffsetTest)
+{
+	// Offsets at every transition must be the same as reported by the ICU based rule iterator
+	for (const auto name : {"America/New_York", "America/Sao_Paulo", "Europe/London",
+		"Australia/Lord_Howe", "Asia/Kolkata"})
+	{
+		const USHORT timeZone = region(name);
+
+		ISC_TIMESTAMP_TZ from, to;
+		from.utc_timestamp = makeTimeStamp(1850, 1, 1, 0, 0);
+		from.time_zone = TimeZoneUtil::GMT_ZONE;
+		to.utc_timestamp = makeTimeStamp(2100, 1, 1, 0, 0);
+		to.time_zone = TimeZoneUtil::GMT_ZONE;
+
+		TimeZoneRuleIterator iterator(timeZone, from, to);
+
+		while (iterator.next())
+		{
+			const SSHORT offset = iterator.zoneOffset + iterator.dstOffset;
+
+			BOOST_TEST_INFO(name);
+			BOOST_TEST(utcOffset(iterator.startTimestamp.utc_timestamp, timeZone) == offset);
+			BOOST_TEST(utcOffset(iterator.endTimestamp.utc_timestamp, timeZone) == offset);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(RegionLocalTimeTest)
+{
+	const USHORT newYork = region("America/New_York");
+
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 7, 1, 12, 0), newYork) == utcTicks(2023, 7, 1, 16, 0));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 12, 31, 23, 59, 59), newYork) ==
+		utcTicks(2024, 1, 1, 4, 59, 59));
+
+	// Skipped and repeated wall times are converted using the offset before the transition
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 3, 12, 1, 59, 59), newYork) == utcTicks(2023, 3, 12, 6, 59, 59));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 3, 12, 2, 30), newYork) == utcTicks(2023, 3, 12, 7, 30));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 3, 12, 3, 0), newYork) == utcTicks(2023, 3, 12, 7, 0));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 11, 5, 0, 59, 59), newYork) == utcTicks(2023, 11, 5, 4, 59, 59));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 11, 5, 1, 30), newYork) == utcTicks(2023, 11, 5, 5, 30));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 11, 5, 2, 0), newYork) == utcTicks(2023, 11, 5, 7, 0));
+
+	const USHORT london = region("Europe/London");
+
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 3, 26, 1, 30), london) == utcTicks(2023, 3, 26, 1, 30));
+	BOOST_TEST(localToUtc(makeTimeStamp(2023, 10, 29, 1, 30), london) == utcTicks(2023, 10, 29, 0, 30));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// TimeZoneUtilTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// TimeZoneUtilSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
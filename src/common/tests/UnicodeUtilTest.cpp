@@ -0,0 +1,139 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/unicode_util.h"
+#include "../common/intlobj_new.h"
+#include <string>
+#include <vector>
+
+using namespace Firebird;
+
+namespace
+{
+	std::string makeAscii(ULONG length)
+	{
+		std::string str;
+
+		for (ULONG i = 0; i < length; i++)
+			str += static_cast<char>(' ' + i % 95);
+
+		return str;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(UnicodeUtilSuite)
+
+
+BOOST_AUTO_TEST_SUITE(UnicodeUtilTests)
+
+BOOST_AUTO_TEST_CASE(AsciiPrefixTest)
+{
+	// Put a non-ASCII character at every position around the vector width
+	for (ULONG length = 0; length < 70; length++)
+	{
+		const std::string ascii = makeAscii(length);
+		const auto str = reinterpret_cast<const UCHAR*>(ascii.data());
+
+		BOOST_TEST(UnicodeUtil::utf8AsciiPrefix(length, str) == length);
+
+		std::vector<USHORT> wide(ascii.begin(), ascii.end());
+		BOOST_TEST(UnicodeUtil::utf16AsciiPrefix(length, wide.data()) == length);
+
+		for (ULONG pos = 0; pos < length; pos++)
+		{
+			std::string mixed = ascii;
+			mixed[pos] = '\xC3';
+			BOOST_TEST(UnicodeUtil::utf8AsciiPrefix(length, reinterpret_cast<const UCHAR*>(mixed.data())) == pos);
+
+			std::vector<USHORT> mixedWide = wide;
+			mixedWide[pos] = 0x80;
+			BOOST_TEST(UnicodeUtil::utf16AsciiPrefix(length, mixedWide.data()) == pos);
+
+			mixedWide[pos] = 0x100;
+			BOOST_TEST(UnicodeUtil::utf16AsciiPrefix(length, mixedWide.data()) == pos);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AsciiConversionTest)
+{
+	const std::string ascii = makeAscii(100);
+	const auto src = reinterpret_cast<const UCHAR*>(ascii.data());
+	const ULONG srcLen = static_cast<ULONG>(ascii.length());
+
+	USHORT errCode;
+	ULONG errPosition;
+
+	std::vector<USHORT> wide(srcLen);
+	BOOST_TEST(UnicodeUtil::utf8ToUtf16(srcLen, src, srcLen * sizeof(USHORT), wide.data(),
+		&errCode, &errPosition) == srcLen * sizeof(USHORT));
+	BOOST_TEST(errCode == 0);
+	BOOST_TEST(std::equal(wide.begin(), wide.end(), ascii.begin()));
+
+	std::vector<UCHAR> narrow(srcLen);
+	BOOST_TEST(UnicodeUtil::utf16ToUtf8(srcLen * sizeof(USHORT), wide.data(), srcLen, narrow.data(),
+		&errCode, &errPosition) == srcLen);
+	BOOST_TEST(errCode == 0);
+	BOOST_TEST(std::equal(narrow.begin(), narrow.end(), ascii.begin()));
+
+	BOOST_TEST(UnicodeUtil::utf8WellFormed(srcLen, src, &errPosition));
+	BOOST_TEST(UnicodeUtil::utf8Length(srcLen, src) == srcLen);
+
+	// Output buffer shorter than the ASCII run
+	BOOST_TEST(UnicodeUtil::utf8ToUtf16(srcLen, src, 40 * sizeof(USHORT), wide.data(),
+		&errCode, &errPosition) == 40 * sizeof(USHORT));
+	BOOST_TEST(errCode == CS_TRUNCATION_ERROR);
+	BOOST_TEST(errPosition == 40u);
+
+	BOOST_TEST(UnicodeUtil::utf16ToUtf8(srcLen * sizeof(USHORT), wide.data(), 40, narrow.data(),
+		&errCode, &errPosition) == 40u);
+	BOOST_TEST(errCode == CS_TRUNCATION_ERROR);
+	BOOST_TEST(errPosition == 40 * sizeof(USHORT));
+}
+
+BOOST_AUTO_TEST_CASE(MixedUtf16ToUtf8Test)
+{
+	// ASCII runs around two- and three-byte characters and a surrogate pair
+	std::vector<USHORT> src;
+	std::string expected;
+
+	for (unsigned i = 0; i < 40; i++)
+	{
+		src.push_back('a' + i % 26);
+		expected += static_cast<char>('a' + i % 26);
+
+		if (i % 17 == 0)
+		{
+			src.push_back(0xE9);
+			expected += "\xC3\xA9";
+		}
+		else if (i % 19 == 0)
+		{
+			src.push_back(0x20AC);
+			expected += "\xE2\x82\xAC";
+		}
+		else if (i == 30)
+		{
+			src.push_back(0xD83D);
+			src.push_back(0xDE00);
+			expected += "\xF0\x9F\x98\x80";
+		}
+	}
+
+	USHORT errCode;
+	ULONG errPosition;
+	std::vector<UCHAR> dst(src.size() * 4);
+
+	const ULONG len = UnicodeUtil::utf16ToUtf8(static_cast<ULONG>(src.size() * sizeof(USHORT)), src.data(),
+		static_cast<ULONG>(dst.size()), dst.data(), &errCode, &errPosition);
+
+	BOOST_TEST(errCode == 0);
+	BOOST_TEST(std::string(dst.begin(), dst.begin() + len) == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// UnicodeUtilTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// UnicodeUtilSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
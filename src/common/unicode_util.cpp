@@ -35,6 +35,7 @@
 #include "../common/gdsassert.h"
 #include "../common/classes/auto.h"
 #include "../common/classes/GenericMap.h"
+#include "../common/classes/Hash.h"
 #include "../common/classes/init.h"
 #include "../common/classes/objects_array.h"
 #include "../common/classes/rwlock.h"
@@ -48,10 +49,17 @@
 #include <unicode/ucol.h>
 #include <unicode/uversion.h>
 
+#include <atomic>
+
 #if U_ICU_VERSION_MAJOR_NUM >= 51
 #	include <unicode/utf_old.h>
 #endif
 
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UNICODE_USE_SSE2
+#endif
+
 
 using namespace Firebird;
 
@@ -716,6 +724,104 @@ ULONG UnicodeUtil::utf16UpperCase(ULONG srcLen, const USHORT* src, ULONG dstLen,
 }
 
 
+namespace
+{
+	// Widen count ASCII characters to UTF-16
+	void asciiToUtf16(const UCHAR* src, ULONG count, USHORT* dst) noexcept
+	{
+		ULONG n = 0;
+
+#ifdef UNICODE_USE_SSE2
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; n + sizeof(__m128i) <= count; n += sizeof(__m128i))
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_unpacklo_epi8(v, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n + 8), _mm_unpackhi_epi8(v, zero));
+		}
+#endif
+
+		for (; n < count; ++n)
+			dst[n] = src[n];
+	}
+
+	// Narrow count UTF-16 code units known to be ASCII
+	void utf16ToAscii(const USHORT* src, ULONG count, UCHAR* dst) noexcept
+	{
+		ULONG n = 0;
+
+#ifdef UNICODE_USE_SSE2
+		for (; n + sizeof(__m128i) <= count; n += sizeof(__m128i))
+		{
+			const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n));
+			const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n + 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_packus_epi16(lo, hi));
+		}
+#endif
+
+		for (; n < count; ++n)
+			dst[n] = static_cast<UCHAR>(src[n]);
+	}
+}
+
+
+// Return the number of leading ASCII characters of the UTF-8 string
+ULONG UnicodeUtil::utf8AsciiPrefix(ULONG len, const UCHAR* str) noexcept
+{
+	ULONG n = 0;
+
+#ifdef UNICODE_USE_SSE2
+	for (; n + sizeof(__m128i) <= len; n += sizeof(__m128i))
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + n));
+
+		if (_mm_movemask_epi8(v))
+			break;
+	}
+#endif
+
+	for (; n + sizeof(FB_UINT64) <= len; n += sizeof(FB_UINT64))
+	{
+		FB_UINT64 v;
+		memcpy(&v, str + n, sizeof(v));
+
+		if (v & FB_CONST64(0x8080808080808080))
+			break;
+	}
+
+	while (n < len && str[n] <= 0x7F)
+		++n;
+
+	return n;
+}
+
+
+// Return the number of leading ASCII characters of the UTF-16 string of len code units
+ULONG UnicodeUtil::utf16AsciiPrefix(ULONG len, const USHORT* str) noexcept
+{
+	ULONG n = 0;
+
+#ifdef UNICODE_USE_SSE2
+	const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; n + 8 <= len; n += 8)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + n));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, nonAscii), zero)) != 0xFFFF)
+			break;
+	}
+#endif
+
+	while (n < len && str[n] <= 0x7F)
+		++n;
+
+	return n;
+}
+
+
 ULONG UnicodeUtil::utf16ToUtf8(ULONG srcLen, const USHORT* src, ULONG dstLen, UCHAR* dst,
 							   USHORT* err_code, ULONG* err_position) noexcept
 {
@@ -736,6 +842,20 @@ ULONG UnicodeUtil::utf16ToUtf8(ULONG srcLen, const USHORT* src, ULONG dstLen, UC
 
 	for (ULONG i = 0; i < srcLen; )
 	{
+		// copy runs of ASCII characters in bulk
+		if (src[i] <= 0x7F)
+		{
+			const ULONG count = MIN(utf16AsciiPrefix(srcLen - i, src + i), static_cast<ULONG>(dstEnd - dst));
+
+			if (count)
+			{
+				utf16ToAscii(src + i, count, dst);
+				i += count;
+				dst += count;
+				continue;
+			}
+		}
+
 		if (dstEnd - dst == 0)
 		{
 			*err_code = CS_TRUNCATION_ERROR;
@@ -799,10 +919,24 @@ ULONG UnicodeUtil::utf8ToUtf16(ULONG srcLen, const UCHAR* src, ULONG dstLen, USH
 
 	const USHORT* const dstStart = dst;
 	const USHORT* const dstEnd = dst + dstLen / sizeof(*dst);
-	ConversionICU& cIcu(getConversionICU());
+	ConversionICU* cIcu = NULL;
 
 	for (ULONG i = 0; i < srcLen; )
 	{
+		// copy runs of ASCII characters in bulk
+		if (src[i] <= 0x7F)
+		{
+			const ULONG count = MIN(utf8AsciiPrefix(srcLen - i, src + i), static_cast<ULONG>(dstEnd - dst));
+
+			if (count)
+			{
+				asciiToUtf16(src + i, count, dst);
+				i += count;
+				dst += count;
+				continue;
+			}
+		}
+
 		if (dstEnd - dst == 0)
 		{
 			*err_code = CS_TRUNCATION_ERROR;
@@ -818,7 +952,10 @@ ULONG UnicodeUtil::utf8ToUtf16(ULONG srcLen, const UCHAR* src, ULONG dstLen, USH
 		{
 			*err_position = i - 1;
 
-			c = cIcu.utf8_nextCharSafeBody(src, reinterpret_cast<int32_t*>(&i), srcLen, c, -1);
+			if (!cIcu)
+				cIcu = &getConversionICU();
+
+			c = cIcu->utf8_nextCharSafeBody(src, reinterpret_cast<int32_t*>(&i), srcLen, c, -1);
 
 			if (c < 0)
 			{
@@ -972,6 +1109,40 @@ SSHORT UnicodeUtil::utf16Compare(ULONG len1, const USHORT* str1, ULONG len2, con
 }
 
 
+// Return character length of the UTF-8 string.
+// If the string is malformed, count number of bytes after the offending character.
+ULONG UnicodeUtil::utf8Length(ULONG len, const UCHAR* str)
+{
+	ConversionICU* cIcu = NULL;
+	ULONG charLength = 0;
+
+	for (ULONG i = 0; i < len; )
+	{
+		const ULONG ascii = utf8AsciiPrefix(len - i, str + i);
+		i += ascii;
+		charLength += ascii;
+
+		if (i >= len)
+			break;
+
+		const ULONG save_i = i;
+		UChar32 c = str[i++];
+
+		if (!cIcu)
+			cIcu = &getConversionICU();
+
+		c = cIcu->utf8_nextCharSafeBody(str, reinterpret_cast<int32_t*>(&i), len, c, -1);
+
+		if (c < 0)
+			return charLength + len - save_i;
+
+		++charLength;
+	}
+
+	return charLength;
+}
+
+
 ULONG UnicodeUtil::utf16Length(ULONG len, const USHORT* str)
 {
 	fb_assert(len % sizeof(*str) == 0);
@@ -1034,23 +1205,29 @@ INTL_BOOL UnicodeUtil::utf8WellFormed(ULONG len, const UCHAR* str, ULONG* offend
 {
 	fb_assert(str != NULL);
 
-	ConversionICU& cIcu(getConversionICU());
+	ConversionICU* cIcu = NULL;
+
 	for (ULONG i = 0; i < len; )
 	{
+		// skip runs of ASCII characters in bulk
+		i += utf8AsciiPrefix(len - i, str + i);
+
+		if (i >= len)
+			break;
+
+		const ULONG save_i = i;
 		UChar32 c = str[i++];
 
-		if (c > 0x7F)
-		{
-			const ULONG save_i = i - 1;
+		if (!cIcu)
+			cIcu = &getConversionICU();
 
-			c = cIcu.utf8_nextCharSafeBody(str, reinterpret_cast<int32_t*>(&i), len, c, -1);
+		c = cIcu->utf8_nextCharSafeBody(str, reinterpret_cast<int32_t*>(&i), len, c, -1);
 
-			if (c < 0)
-			{
-				if (offending_position)
-					*offending_position = save_i;
-				return false;	// malformed
-			}
+		if (c < 0)
+		{
+			if (offending_position)
+				*offending_position = save_i;
+			return false;	// malformed
 		}
 	}
 
@@ -1411,6 +1588,73 @@ UnicodeUtil::ICU* UnicodeUtil::getCollVersion(const Firebird::string& icuVersion
 	return icu;
 }
 
+namespace
+{
+	// Per-thread cache of recently built sort keys of short strings. Sorts, hash joins
+	// and index builds often see the same values many times, and looking a key up here
+	// is much cheaper than building it with ICU.
+
+	constexpr unsigned SORT_KEY_CACHE_SIZE = 32;
+	constexpr unsigned SORT_KEY_CACHE_STRING = 32;	// characters
+	constexpr unsigned SORT_KEY_CACHE_KEY = 96;		// bytes
+
+	struct SortKeyCacheEntry
+	{
+		FB_UINT64 collation;	// serial number of the collation, zero for an unused entry
+		USHORT keyType;
+		USHORT strLength;		// characters
+		USHORT keyLength;
+		USHORT str[SORT_KEY_CACHE_STRING];
+		UCHAR key[SORT_KEY_CACHE_KEY];
+	};
+
+	thread_local SortKeyCacheEntry sortKeyCache[SORT_KEY_CACHE_SIZE];
+
+	// A miss costs about a fifth of the ICU call it doesn't save, so with mostly
+	// distinct values the cache is a loss. Lookups are counted in windows, and
+	// after a window with less than a quarter of hits the cache is bypassed
+	// for a while before it's probed again.
+
+	constexpr unsigned SORT_KEY_CACHE_WINDOW = 256;		// lookups
+	constexpr unsigned SORT_KEY_CACHE_BYPASS = 4096;	// keys built without the cache
+
+	struct SortKeyCacheStats
+	{
+		unsigned lookups;
+		unsigned hits;
+		unsigned bypass;	// keys to build before the cache is used again
+
+		bool useCache()
+		{
+			if (!bypass)
+				return true;
+
+			--bypass;
+			return false;
+		}
+
+		void addLookup(bool hit)
+		{
+			if (hit)
+				++hits;
+
+			if (++lookups == SORT_KEY_CACHE_WINDOW)
+			{
+				if (hits < SORT_KEY_CACHE_WINDOW / 4)
+					bypass = SORT_KEY_CACHE_BYPASS;
+
+				lookups = hits = 0;
+			}
+		}
+	};
+
+	thread_local SortKeyCacheStats sortKeyCacheStats;
+
+	// Collations are numbered to never match the cached keys of a destroyed one
+	std::atomic<FB_UINT64> collationSerial(0);
+}
+
+
 UnicodeUtil::Utf16Collation* UnicodeUtil::Utf16Collation::create(
 	texttype* tt, USHORT attributes,
 	Firebird::IntlUtil::SpecificAttributesMap& specificAttributes, const Firebird::string& configInfo)
@@ -1597,6 +1841,7 @@ UnicodeUtil::Utf16Collation* UnicodeUtil::Utf16Collation::create(
 	obj->sortCollator = sortCollator;
 	obj->numericSort = isNumericSort;
 	obj->maxContractionsPrefixLength = 0;
+	obj->serial = ++collationSerial;
 
 	USet* contractions = icu->usetOpen(1, 0);
 	// status not verified here.
@@ -1932,12 +2177,43 @@ USHORT UnicodeUtil::Utf16Collation::stringToKey(USHORT srcLen, const USHORT* src
 		return keyLen + 2;
 	}
 
+	SortKeyCacheEntry* cacheEntry = NULL;
+
+	if (srcLenLong <= SORT_KEY_CACHE_STRING && sortKeyCacheStats.useCache())
+	{
+		cacheEntry = &sortKeyCache[DefaultHash<USHORT>::hash(src, srcLenLong * sizeof(*src), SORT_KEY_CACHE_SIZE)];
+
+		const bool hit = cacheEntry->collation == serial && cacheEntry->keyType == key_type &&
+			cacheEntry->strLength == srcLenLong && memcmp(cacheEntry->str, src, srcLenLong * sizeof(*src)) == 0;
+
+		sortKeyCacheStats.addLookup(hit);
+
+		if (hit)
+		{
+			if (cacheEntry->keyLength > dstLen)
+				return INTL_BAD_KEY_LENGTH;
+
+			memcpy(dst, cacheEntry->key, cacheEntry->keyLength);
+			return cacheEntry->keyLength;
+		}
+	}
+
 	const ULONG keyLen = icu->ucolGetSortKey(coll,
 		reinterpret_cast<const UChar*>(src), srcLenLong, dst, dstLen);
 
 	if (keyLen == 0 || keyLen > dstLen || keyLen > MAX_USHORT)
 		return INTL_BAD_KEY_LENGTH;
 
+	if (cacheEntry && keyLen <= SORT_KEY_CACHE_KEY)
+	{
+		cacheEntry->collation = serial;
+		cacheEntry->keyType = key_type;
+		cacheEntry->strLength = static_cast<USHORT>(srcLenLong);
+		cacheEntry->keyLength = static_cast<USHORT>(keyLen);
+		memcpy(cacheEntry->str, src, srcLenLong * sizeof(*src));
+		memcpy(cacheEntry->key, dst, keyLen);
+	}
+
 	return keyLen;
 }
 
@@ -1976,6 +2252,10 @@ SSHORT UnicodeUtil::Utf16Collation::compare(ULONG len1, const USHORT* str1,
 		len2 = pad - str2 + 1;
 	}
 
+	// identical strings are equal in any collation
+	if (len1 == len2 && memcmp(str1, str2, len1 * sizeof(*str1)) == 0)
+		return 0;
+
 	len1 *= sizeof(*str1);
 	len2 *= sizeof(*str2);
 
@@ -2084,6 +2364,23 @@ void UnicodeUtil::Utf16Collation::normalize(ULONG* strLen, const USHORT** str, b
 
 	if (attributes & TEXTTYPE_ATTR_CASE_INSENSITIVE)
 	{
+		const ULONG len = *strLen / sizeof(USHORT);
+
+		// ASCII strings are uppercased without ICU, accents removal doesn't change them
+		if (utf16AsciiPrefix(len, *str) == len)
+		{
+			USHORT* const upper = buffer.getBuffer(len);
+
+			for (ULONG i = 0; i < len; ++i)
+			{
+				const USHORT c = (*str)[i];
+				upper[i] = (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+			}
+
+			*str = upper;
+			return;
+		}
+
 		*strLen = utf16UpperCase(*strLen, *str, *strLen,
 			buffer.getBuffer(*strLen / sizeof(USHORT)), NULL);
 		*str = buffer.begin();
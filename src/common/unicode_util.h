@@ -159,6 +159,7 @@ public:
 	static SSHORT utf16Compare(ULONG len1, const USHORT* str1, ULONG len2, const USHORT* str2,
 							   INTL_BOOL* error_flag);
 
+	static ULONG utf8Length(ULONG len, const UCHAR* str);
 	static ULONG utf16Length(ULONG len, const USHORT* str);
 	static ULONG utf16Substring(ULONG srcLen, const USHORT* src, ULONG dstLen, USHORT* dst,
 								ULONG startPos, ULONG length) noexcept;
@@ -168,6 +169,10 @@ public:
 
 	static void utf8Normalize(Firebird::UCharBuffer& data);
 
+	// ASCII fast paths, vectorized where supported
+	static ULONG utf8AsciiPrefix(ULONG len, const UCHAR* str) noexcept;
+	static ULONG utf16AsciiPrefix(ULONG len, const USHORT* str) noexcept;
+
 	static ConversionICU& getConversionICU();
 	static ICU* loadICU(const Firebird::string& icuVersion, const Firebird::string& configInfo);
 	static void getICUVersion(ICU* icu, int& majorVersion, int& minorVersion) noexcept;
@@ -250,6 +255,7 @@ public:
 		ContractionsPrefixMap contractionsPrefix;
 		unsigned maxContractionsPrefixLength;	// number of characters
 		bool numericSort;
+		FB_UINT64 serial;	// identifies the collation in the sort key cache
 	};
 
 	friend class Utf16Collation;
@@ -1207,7 +1207,7 @@ public:
 	}
 
 	static SSHORT store(thread_db* tdbb, jrd_tra* transaction, const QualifiedName& name,
-		fb_sysflag sysFlag, SINT64 value, SLONG step);
+		fb_sysflag sysFlag, SINT64 value, SLONG step, std::optional<SLONG> cache = std::nullopt);
 
 public:
 	Firebird::string internalPrint(NodePrinter& printer) const override;
@@ -1247,6 +1247,7 @@ public:
 	QualifiedName name;
 	std::optional<SINT64> value;
 	std::optional<SLONG> step;
+	std::optional<SLONG> cache;
 };
 
 
@@ -1549,6 +1550,7 @@ public:
 		std::optional<IdentityType> type;
 		std::optional<SINT64> startValue;
 		std::optional<SLONG> increment;
+		std::optional<SLONG> cache;
 		bool restart;	// used in ALTER
 	};
 
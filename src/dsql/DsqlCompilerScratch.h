@@ -344,6 +344,7 @@ public:
 	Firebird::Stack<SelectExprNode*> currCtes;	// current processing CTE's
 	dsql_ctx* recursiveCtx = nullptr;		// context of recursive CTE
 	USHORT recursiveCtxId = 0;				// id of recursive union stream context
+	USHORT sharedUnionNumber = 0;			// Last id given to a materialized CTE
 	bool processingWindow = false;			// processing window functions
 	bool checkConstraintTrigger = false;	// compiling a check constraint trigger
 	bool aggregatePhaseReturn = false;		// aggregate section return is phase-local
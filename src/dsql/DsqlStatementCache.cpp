@@ -26,6 +26,7 @@
 #include "../jrd/Attachment.h"
 #include "../jrd/Statement.h"
 #include "../jrd/lck.h"
+#include "../jrd/met.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -110,14 +111,40 @@ RefPtr<DsqlStatement> DsqlStatementCache::getStatement(thread_db* tdbb, const st
 		return dsqlStatement;
 	}
 
+	if (canShare(tdbb, isInternalRequest))
+	{
+		string verifyKey;
+		buildSharedVerifyKey(tdbb, verifyKey);
+
+		const auto dbb = tdbb->getDatabase();
+		return dbb->dbb_shared_statement_cache->getStatement(tdbb, key, verifyKey);
+	}
+
 	return {};
 }
 
 void DsqlStatementCache::putStatement(thread_db* tdbb, const string& text, USHORT clientDialect,
-	bool isInternalRequest, RefPtr<DsqlStatement> dsqlStatement)
+	bool isInternalRequest, RefPtr<DsqlStatement> dsqlStatement, MdcVersion mdcVersion)
 {
 	fb_assert(dsqlStatement->isDml());
 
+	RefStrPtr key;
+	buildStatementKey(tdbb, key, text, clientDialect, isInternalRequest);
+
+	// Positioned updates and deletes depend on the cursors of this attachment
+	const auto dmlStatement = static_cast<DsqlDmlStatement*>(dsqlStatement.getPtr());
+
+	if (canShare(tdbb, isInternalRequest) && dmlStatement->parentCursorName.isEmpty())
+	{
+		string verifyKey;
+		buildSharedVerifyKey(tdbb, verifyKey);
+
+		const auto dbb = tdbb->getDatabase();
+
+		if (dbb->dbb_shared_statement_cache->putStatement(tdbb, key, verifyKey, dsqlStatement, mdcVersion))
+			return;
+	}
+
 	ensureLockIsCreated(tdbb);
 
 	if (isEmpty())
@@ -130,9 +157,6 @@ void DsqlStatementCache::putStatement(thread_db* tdbb, const string& text, USHOR
 
 	const unsigned statementSize = dsqlStatement->getSize();
 
-	RefStrPtr key;
-	buildStatementKey(tdbb, key, text, clientDialect, isInternalRequest);
-
 	StatementEntry newStatement(getPool());
 	newStatement.key = key;
 	newStatement.size = statementSize;
@@ -243,6 +267,10 @@ void DsqlStatementCache::purgeAllAttachments(thread_db* tdbb)
 {
 	purge(tdbb, false);
 
+	// Statements shared by other attachments are also checked against the metadata version
+	// when looked up, this just frees them earlier
+	tdbb->getDatabase()->dbb_shared_statement_cache->purge(tdbb);
+
 	fb_assert(!lock || lock->lck_logical == LCK_SR);
 
 	Lock tempLock(tdbb, 0, LCK_dsql_statement_cache);
@@ -269,9 +297,10 @@ void DsqlStatementCache::buildStatementKey(thread_db* tdbb, RefStrPtr& key, cons
 
 	const SSHORT charSetId = isInternalRequest ? CS_METADATA : attachment->att_charset;
 	const int debugOptions = (int) attachment->getDebugOptions().getDsqlKeepBlr();
+	const auto& firstRows = attachment->att_opt_first_rows;
 
 	key = FB_NEW_POOL(getPool()) RefString(getPool());
-	key->resize(1 + sizeof(charSetId) + text.length() + 1 + searchPathLen + 1);
+	key->resize(1 + sizeof(charSetId) + text.length() + 1 + searchPathLen + 1 + 1);
 
 	char* p = key->begin();
 	*p++ = (clientDialect << 2) | (int(isInternalRequest) << 1) | debugOptions;
@@ -286,7 +315,8 @@ void DsqlStatementCache::buildStatementKey(thread_db* tdbb, RefStrPtr& key, cons
 		p += pathItem.length() + 1;
 	}
 
-	*p = '\0';
+	*p++ = '\0';
+	*p = firstRows.isUnknown() ? 2 : (int) firstRows.asBool();
 
 	fb_assert(p + 1 == key->end());
 }
@@ -311,6 +341,31 @@ void DsqlStatementCache::buildVerifyKey(thread_db* tdbb, string& key, bool isInt
 	}
 }
 
+// Access check key for statements shared by attachments of different users.
+void DsqlStatementCache::buildSharedVerifyKey(thread_db* tdbb, string& key)
+{
+	const auto attachment = tdbb->getAttachment();
+	fb_assert(attachment->att_user);
+
+	const auto& userName = attachment->att_user->getUserName();
+	key.printf("%d,%s,", int(userName.length()), userName.c_str());
+
+	string roleKey;
+	buildVerifyKey(tdbb, roleKey, false);
+	key += roleKey;
+}
+
+// Statements of this attachment may be looked up and stored in the database-wide cache.
+bool DsqlStatementCache::canShare(thread_db* tdbb, bool isInternalRequest) const
+{
+	const auto attachment = tdbb->getAttachment();
+
+	// Local temporary tables are visible to their attachment only and may hide
+	// the persistent tables with the same name
+	return isActive() && !isInternalRequest && attachment->att_user &&
+		attachment->att_local_temporary_tables.isEmpty() && DsqlSharedStatementCache::isEnabled(tdbb);
+}
+
 void DsqlStatementCache::shrink()
 {
 #ifdef DSQL_STATEMENT_CACHE_DEBUG
@@ -358,3 +413,120 @@ void DsqlStatementCache::dump()
 	printf("\n");
 }
 #endif
+
+
+// Class DsqlSharedStatementCache
+
+DsqlSharedStatementCache::DsqlSharedStatementCache(MemoryPool& o)
+	: PermanentStorage(o),
+	  statements(o)
+{
+}
+
+DsqlSharedStatementCache::~DsqlSharedStatementCache()
+{
+	// Statements are released with the database pools
+	fb_assert(statements.isEmpty());
+}
+
+bool DsqlSharedStatementCache::isEnabled(thread_db* tdbb)
+{
+	return tdbb->getDatabase()->dbb_config->getSharedStatementCacheSize() > 0;
+}
+
+RefPtr<DsqlStatement> DsqlSharedStatementCache::getStatement(thread_db* tdbb, const RefStrPtr& key,
+	const string& verifyKey)
+{
+	const MdcVersion mdcVersion = MetadataCache::get(tdbb)->getFrontVersion();
+
+	// Statements are released after the mutex is unlocked
+	StatementMap::EntryList stale(getPool());
+	RefPtr<DsqlStatement> dsqlStatement;
+
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+
+		const auto entry = statements.get(key);
+
+		if (!entry)
+			return {};
+
+		if (entry->mdcVersion != mdcVersion)
+		{
+			// Metadata was changed after the statement was compiled
+			statements.remove(key, stale);
+			return {};
+		}
+
+		dsqlStatement = entry->dsqlStatement;
+
+		FB_SIZE_T verifyPos;
+		if (entry->verifyCache.find(verifyKey, verifyPos))
+			return dsqlStatement;
+	}
+
+	// Access check may read the security classes, don't do it holding the mutex
+	dsqlStatement->getStatement()->verifyAccess(tdbb);
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	if (const auto entry = statements.get(key))
+	{
+		FB_SIZE_T verifyPos;
+		if (entry->dsqlStatement.getPtr() == dsqlStatement.getPtr() &&
+			!entry->verifyCache.find(verifyKey, verifyPos))
+		{
+			entry->verifyCache.insert(verifyPos, verifyKey);
+		}
+	}
+
+	return dsqlStatement;
+}
+
+// Returns false if the statement cannot be shared and should be cached by its attachment.
+bool DsqlSharedStatementCache::putStatement(thread_db* tdbb, const RefStrPtr& key, const string& verifyKey,
+	RefPtr<DsqlStatement> dsqlStatement, MdcVersion mdcVersion)
+{
+	// Statement compiled while metadata was changing may already be stale
+	if (MetadataCache::get(tdbb)->getFrontVersion() != mdcVersion)
+		return false;
+
+	const FB_SIZE_T maxCacheSize = tdbb->getDatabase()->dbb_config->getSharedStatementCacheSize();
+	const FB_SIZE_T statementSize = dsqlStatement->getSize();
+
+	// Larger statement would evict everything else and then itself
+	if (statementSize > maxCacheSize)
+		return false;
+
+	// Statements are released after the mutex is unlocked
+	StatementMap::EntryList evicted(getPool());
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	StatementEntry newStatement(getPool());
+	newStatement.dsqlStatement = dsqlStatement;
+	newStatement.mdcVersion = mdcVersion;
+	newStatement.verifyCache.add(verifyKey);
+
+	const RefStrPtr sharedKey(FB_NEW_POOL(getPool()) RefString(getPool(), *key));
+
+	// Somebody else has prepared the same statement concurrently
+	if (!statements.put(sharedKey, std::move(newStatement), statementSize))
+		return false;
+
+	dsqlStatement->setShared();
+
+	// Statements still used by some attachment are released by their last user
+	statements.shrink(maxCacheSize, evicted);
+
+	return true;
+}
+
+void DsqlSharedStatementCache::purge(thread_db* /*tdbb*/)
+{
+	StatementMap::EntryList purged(getPool());
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	statements.clear(purged);
+}
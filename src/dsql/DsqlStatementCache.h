@@ -29,6 +29,8 @@
 #include "../common/classes/DoublyLinkedList.h"
 #include "../common/classes/fb_string.h"
 #include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/LruMap.h"
 #include "../common/classes/objects_array.h"
 #include "../common/classes/RefCounted.h"
 
@@ -104,7 +106,7 @@ public:
 		USHORT clientDialect, bool isInternalRequest);
 
 	void putStatement(thread_db* tdbb, const Firebird::string& text, USHORT clientDialect, bool isInternalRequest,
-		Firebird::RefPtr<DsqlStatement> dsqlStatement);
+		Firebird::RefPtr<DsqlStatement> dsqlStatement, MdcVersion mdcVersion);
 
 	void removeStatement(thread_db* tdbb, DsqlStatement* statement);
 	void statementGoingInactive(Firebird::RefStrPtr& key);
@@ -122,6 +124,8 @@ private:
 		USHORT clientDialect, bool isInternalRequest);
 
 	void buildVerifyKey(thread_db* tdbb, Firebird::string& key, bool isInternalRequest);
+	void buildSharedVerifyKey(thread_db* tdbb, Firebird::string& key);
+	bool canShare(thread_db* tdbb, bool isInternalRequest) const;
 	void shrink();
 	void ensureLockIsCreated(thread_db* tdbb);
 
@@ -143,6 +147,69 @@ private:
 };
 
 
+// Database-wide cache of DML statements, shared by attachments with the same compilation settings.
+// Every attachment uses its own requests of a shared statement, so only the compiled tree is shared.
+class DsqlSharedStatementCache final : public Firebird::PermanentStorage
+{
+private:
+	struct StatementEntry
+	{
+		explicit StatementEntry(MemoryPool& p)
+			: verifyCache(p)
+		{
+		}
+
+		StatementEntry(MemoryPool& p, StatementEntry&& o)
+			: dsqlStatement(std::move(o.dsqlStatement)),
+			  verifyCache(p, std::move(o.verifyCache)),
+			  mdcVersion(o.mdcVersion)
+		{
+		}
+
+		StatementEntry(const StatementEntry&) = delete;
+		StatementEntry& operator=(const StatementEntry&) = delete;
+
+		Firebird::RefPtr<DsqlStatement> dsqlStatement;
+		Firebird::SortedObjectsArray<Firebird::string> verifyCache;
+		MdcVersion mdcVersion = 0;	// metadata version the statement was compiled with
+	};
+
+	class RefStrPtrComparator
+	{
+	public:
+		static bool greaterThan(const Firebird::RefStrPtr& i1, const Firebird::RefStrPtr& i2)
+		{
+			return *i1 > *i2;
+		}
+	};
+
+	typedef Firebird::LruMap<Firebird::RefStrPtr, StatementEntry, RefStrPtrComparator> StatementMap;
+
+public:
+	explicit DsqlSharedStatementCache(MemoryPool& o);
+	~DsqlSharedStatementCache();
+
+	DsqlSharedStatementCache(const DsqlSharedStatementCache&) = delete;
+	DsqlSharedStatementCache& operator=(const DsqlSharedStatementCache&) = delete;
+
+public:
+	// Statements are shared unless SharedStatementCacheSize is zero
+	static bool isEnabled(thread_db* tdbb);
+
+	Firebird::RefPtr<DsqlStatement> getStatement(thread_db* tdbb, const Firebird::RefStrPtr& key,
+		const Firebird::string& verifyKey);
+
+	bool putStatement(thread_db* tdbb, const Firebird::RefStrPtr& key, const Firebird::string& verifyKey,
+		Firebird::RefPtr<DsqlStatement> dsqlStatement, MdcVersion mdcVersion);
+
+	void purge(thread_db* tdbb);
+
+private:
+	Firebird::Mutex mutex;
+	StatementMap statements;
+};
+
+
 }	// namespace Jrd
 
 #endif // DSQL_STATEMENT_CACHE_H
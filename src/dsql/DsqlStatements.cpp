@@ -78,11 +78,32 @@ void DsqlStatement::release()
 		else
 		{
 			doRelease();
-			dsqlAttachment->deletePool(&getPool());
+
+			if (shared)
+				JRD_get_thread_data()->getDatabase()->deletePool(&getPool());
+			else
+				dsqlAttachment->deletePool(&getPool());
 		}
 	}
 }
 
+// Make the statement usable by other attachments, it may outlive the attachment that prepared it.
+void DsqlStatement::setShared()
+{
+	fb_assert(isDml() && !cacheKey);
+
+	if (schemaSearchPath)
+	{
+		schemaSearchPath = FB_NEW_POOL(getPool())
+			AnyRef<ObjectsArray<MetaString>>(getPool(), *schemaSearchPath);
+	}
+
+	getStatement()->flags |= Statement::FLAG_SHARED;
+
+	dsqlAttachment = nullptr;
+	shared = true;
+}
+
 void DsqlStatement::doRelease()
 {
 	fb_assert(!cacheKey.hasData());
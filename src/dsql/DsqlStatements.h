@@ -123,6 +123,9 @@ public:
 
 	const auto getSchemaSearchPath() const { return schemaSearchPath; }
 
+	bool isShared() const { return shared; }
+	void setShared();
+
 public:
 	virtual bool isDml() const
 	{
@@ -168,6 +171,7 @@ protected:
 	dsql_msg* receiveMsg = nullptr;				// Per record message to be received
 	DsqlCompilerScratch* scratch = nullptr;
 	Firebird::RefPtr<Firebird::AnyRef<Firebird::ObjectsArray<Firebird::MetaString>>> schemaSearchPath;
+	bool shared = false;	// used by many attachments, dsqlAttachment is not valid
 
 private:
 	Firebird::AtomicCounter refCounter;
@@ -7068,6 +7068,7 @@ ValueExprNode* FieldNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 
 	// SMB_SET uses ULONG, not USHORT
 	SBM_SET(tdbb->getDefaultPool(), &csb->csb_rpt[fieldStream].csb_fields, fieldId);
+	csb->csb_rpt[fieldStream].csb_field_refs++;
 
 	if (csb->csb_rpt[fieldStream].csb_relation || csb->csb_rpt[fieldStream].csb_procedure)
 		format = CMP_format(tdbb, csb, fieldStream);
@@ -7367,7 +7368,11 @@ dsc* GenIdNode::execute(thread_db* tdbb, Request* request) const
 			status_exception::raise(Arg::Gds(isc_cant_modify_sysobj) << "generator" << generator.name.toQuotedString());
 	}
 
-	const SINT64 new_val = DPM_gen_id(tdbb, generator.id, false, change);
+	// NEXT VALUE FOR (identity columns too) of a sequence declared with CACHE
+	// takes values from the reserved block
+	const SINT64 new_val = (implicit && change && generator.cache > 1) ?
+		DPM_gen_id_cached(tdbb, generator.id, step, generator.cache) :
+		DPM_gen_id(tdbb, generator.id, false, change);
 
 	if (dialect1)
 		impure->make_long((SLONG) new_val);
@@ -10570,6 +10575,10 @@ ValueExprNode* RecordKeyNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 {
 	ValueExprNode::pass2(tdbb, csb);
 
+	// Record version is taken from the record header, so treat it as a field reference
+	if (blrOp != blr_dbkey)
+		csb->csb_rpt[recStream].csb_field_refs++;
+
 	dsc desc;
 	getDesc(tdbb, csb, &desc);
 	impureOffset = csb->allocImpure<impure_value>();
@@ -14500,6 +14509,7 @@ Firebird::string GeneratorItem::internalPrint(NodePrinter& printer) const
 	NODE_PRINT(printer, id);
 	NODE_PRINT(printer, name);
 	NODE_PRINT(printer, secName);
+	NODE_PRINT(printer, cache);
 
 	return "GeneratorItem";
 }
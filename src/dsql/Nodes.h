@@ -1226,6 +1226,7 @@ public:
 	static constexpr USHORT DFLAG_LATERAL					= 0x80;
 	static constexpr USHORT DFLAG_PLAN_ITEM					= 0x100;
 	static constexpr USHORT DFLAG_BODY_WRAPPER				= 0x200;
+	static constexpr USHORT DFLAG_CTE_MATERIALIZE			= 0x400;	// CTE evaluated once for all its references
 
 	RecordSourceNode(Type aType, MemoryPool& pool)
 		: ExprNode(aType, pool),
@@ -1756,7 +1757,7 @@ class GeneratorItem : public Printable
 {
 public:
 	GeneratorItem(Firebird::MemoryPool& pool, const QualifiedName& name)
-		: id(0), name(pool, name), secName(pool)
+		: id(0), name(pool, name), secName(pool), cache(0)
 	{}
 
 	GeneratorItem& operator=(const GeneratorItem& other)
@@ -1764,6 +1765,7 @@ public:
 		id = other.id;
 		name = other.name;
 		secName = other.secName;
+		cache = other.cache;
 		return *this;
 	}
 
@@ -1774,6 +1776,7 @@ public:
 	SLONG id;
 	QualifiedName name;
 	QualifiedName secName;
+	SLONG cache;	// number of values reserved at once, 0 or 1 - no caching
 };
 
 typedef Firebird::Array<StreamType> StreamMap;
@@ -562,6 +562,7 @@ static RefPtr<DsqlStatement> prepareStatement(thread_db* tdbb, dsql_dbb* databas
 	}
 
 	string textStr(text, textLength);
+	const MdcVersion mdcVersion = MetadataCache::get(tdbb)->getFrontVersion();
 	const bool isStatementCacheActive = database->dbb_statement_cache->isActive() &&
 		(transaction ? (!transaction->isDdl()) : true);
 
@@ -675,7 +676,7 @@ static RefPtr<DsqlStatement> prepareStatement(thread_db* tdbb, dsql_dbb* databas
 		if (isStatementCacheActive && dsqlStatement->isDml())
 		{
 			database->dbb_statement_cache->putStatement(tdbb,
-				textStr, clientDialect, isInternalRequest, dsqlStatement);
+				textStr, clientDialect, isInternalRequest, dsqlStatement, mdcVersion);
 		}
 
 		return dsqlStatement;
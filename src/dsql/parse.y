@@ -731,6 +731,8 @@ using namespace Firebird;
 %token <metaNamePtr> WITHIN
 %token <metaNamePtr> RDB_RESET_CONTEXT
 %token <metaNamePtr> CONSTANT
+%token <metaNamePtr> MATERIALIZED
+%token <metaNamePtr> CACHE
 
 // precedence declarations for expression evaluation
 
@@ -2065,6 +2067,7 @@ create_sequence_options($seqNode)
 create_seq_option($seqNode)
 	: start_with_opt($seqNode)
 	| step_option($seqNode)
+	| cache_option($seqNode)
 	;
 
 %type start_with_opt(<createAlterSequenceNode>)
@@ -2082,6 +2085,12 @@ step_option($seqNode)
 		{ setClause($seqNode->step, "INCREMENT BY", $3); }
 	;
 
+%type cache_option(<createAlterSequenceNode>)
+cache_option($seqNode)
+	: CACHE signed_long_integer
+		{ setClause($seqNode->cache, "CACHE", $2); }
+	;
+
 by_noise
 	: // nothing
 	| BY
@@ -2097,7 +2106,7 @@ replace_sequence_clause
 	  replace_sequence_options($2)
 		{
 			// Remove this to implement CORE-5137
-			if (!$2->restartSpecified && !$2->step.has_value())
+			if (!$2->restartSpecified && !$2->step.has_value() && !$2->cache.has_value())
 				yyerrorIncompleteCmd(YYPOSNARG(3));
 			$$ = $2;
 		}
@@ -2117,6 +2126,7 @@ replace_seq_option($seqNode)
 		}
 	| start_with_opt($seqNode)
 	| step_option($seqNode)
+	| cache_option($seqNode)
 	;
 
 %type <createAlterSequenceNode> alter_sequence_clause
@@ -2130,8 +2140,11 @@ alter_sequence_clause
 		}
 	  alter_sequence_options($2)
 		{
-			if (!$2->restartSpecified && !$2->value.has_value() && !$2->step.has_value())
+			if (!$2->restartSpecified && !$2->value.has_value() && !$2->step.has_value() &&
+				!$2->cache.has_value())
+			{
 				yyerrorIncompleteCmd(YYPOSNARG(3));
+			}
 			$$ = $2;
 		}
 
@@ -2145,6 +2158,7 @@ alter_sequence_options($seqNode)
 alter_seq_option($seqNode)
 	: restart_option($seqNode)
 	| step_option($seqNode)
+	| cache_option($seqNode)
 	;
 
 
@@ -2722,6 +2736,8 @@ identity_clause_option($identityOptions)
 		{ setClause($identityOptions->startValue, "START WITH", $3); }
 	| INCREMENT by_noise signed_long_integer
 		{ setClause($identityOptions->increment, "INCREMENT BY", $3); }
+	| CACHE signed_long_integer
+		{ setClause($identityOptions->cache, "CACHE", $2); }
 	;
 
 // value does allow parens around it, but there is a problem getting the source text.
@@ -5175,6 +5191,8 @@ alter_identity_clause_option($identityOptions)
 		}
 	| SET INCREMENT by_noise signed_long_integer
 		{ setClause($identityOptions->increment, "SET INCREMENT BY", $4); }
+	| SET CACHE signed_long_integer
+		{ setClause($identityOptions->cache, "SET CACHE", $3); }
 	;
 
 %type <boolVal> drop_behaviour
@@ -6807,15 +6825,23 @@ with_list
 
 %type <selectExprNode> with_item
 with_item
-	: valid_symbol_name derived_column_list AS '(' select_expr ')'
+	: valid_symbol_name derived_column_list AS cte_materialized_opt '(' select_expr ')'
 		{
-			$$ = $5;
+			$$ = $6;
 			$$->dsqlFlags |= RecordSourceNode::DFLAG_DERIVED;
 			$$->alias = $1->c_str();
 			$$->columns = $2;
+			$$->materialized = $4;
 		}
 	;
 
+%type <triState> cte_materialized_opt
+cte_materialized_opt
+	: /* nothing */			{ $$ = TriState(); }
+	| MATERIALIZED			{ $$ = TriState(true); }
+	| NOT MATERIALIZED		{ $$ = TriState(false); }
+	;
+
 %type <selectExprNode> column_select
 column_select
 	: select_expr
@@ -10581,12 +10607,14 @@ non_reserved_word
 	| BIN_AND_AGG
 	| BIN_OR_AGG
 	| BIN_XOR_AGG
+	| CACHE
 	| CONSTANT
 	| DOWNTO
 	| ERROR
 	| FINISH
 	| FORMAT
 	| GENERATE_SERIES
+	| MATERIALIZED
 	| OWNER
 	| SEARCH_PATH
 	| SCHEMA
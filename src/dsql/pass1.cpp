@@ -181,6 +181,7 @@ using namespace Firebird;
 
 static ValueListNode* pass1_group_by_list(DsqlCompilerScratch*, ValueListNode*, ValueListNode*);
 static ValueExprNode* pass1_make_derived_field(thread_db*, DsqlCompilerScratch*, ValueExprNode*);
+static void pass1_materialize_ctes(DsqlCompilerScratch*, SelectExprNode*);
 static RseNode* pass1_rse(DsqlCompilerScratch*, RecordSourceNode*, ValueListNode*, RowsClause*, bool, bool, USHORT);
 static RseNode* pass1_rse_impl(DsqlCompilerScratch*, RecordSourceNode*, ValueListNode*, RowsClause*, bool, bool, USHORT);
 static ValueListNode* pass1_sel_list(DsqlCompilerScratch*, ValueListNode*);
@@ -671,6 +672,9 @@ RseNode* PASS1_rse(DsqlCompilerScratch* dsqlScratch,
 	const bool updateLock = select ? select->withLock : false;
 	const bool skipLocked = select ? select->skipLocked : false;
 
+	if (select)
+		pass1_materialize_ctes(dsqlScratch, input);
+
 	dsqlScratch->scopeLevel++;
 	RseNode* node = pass1_rse(dsqlScratch, input, NULL, NULL, updateLock, skipLocked, 0);
 	dsqlScratch->scopeLevel--;
@@ -1149,17 +1153,35 @@ RseNode* PASS1_derived_table(DsqlCompilerScratch* dsqlScratch, SelectExprNode* i
 		//   Good thing is that only 1 recordstream is made for the sub-select, but
 		//   the worse thing is that a UNION currently can't be used in
 		//   deciding the JOIN order.
+		// The same wrapping is used for a CTE that should be evaluated once: the union
+		// is marked as shared by all references to the CTE when generating BLR.
 		bool foundSubSelect = false;
 		if (auto queryNode = nodeAs<RseNode>(query))
 			foundSubSelect = SubSelectFinder::find(dsqlScratch->getPool(), queryNode->dsqlSelectList);
 
-		if (foundSubSelect)
+		const bool materialize = (input->dsqlFlags & RecordSourceNode::DFLAG_CTE_MATERIALIZE);
+
+		if (foundSubSelect || materialize)
 		{
 			UnionSourceNode* unionExpr = FB_NEW_POOL(pool) UnionSourceNode(pool);
 			unionExpr->dsqlClauses = FB_NEW_POOL(pool) RecSourceListNode(pool, 1);
 			unionExpr->dsqlClauses->items[0] = input;
 			unionExpr->dsqlAll = true;
+
+			const auto sendMsg = dsqlScratch->getDsqlStatement()->getSendMsg();
+			const USHORT paramIndex = sendMsg ? sendMsg->msg_index : 0;
+
 			rse = pass1_union(dsqlScratch, unionExpr, NULL, NULL, false, false, 0);
+
+			if (materialize)
+			{
+				unionExpr->dsqlCte = input;
+				input->dsqlReferences++;
+
+				// Every reference gets its own input parameters, so the CTE cannot be shared.
+				if (sendMsg && sendMsg->msg_index != paramIndex)
+					input->dsqlFlags &= ~RecordSourceNode::DFLAG_CTE_MATERIALIZE;
+			}
 		}
 		else
 			rse = PASS1_rse(dsqlScratch, input, select);
@@ -1879,6 +1901,97 @@ RecordSourceNode* PASS1_relation(DsqlCompilerScratch* dsqlScratch, RecordSourceN
 }
 
 
+// Decide which CTEs of a top-level query are evaluated once and shared among all their references.
+// Only CTEs with an explicit MATERIALIZED hint which are referenced more than once are chosen, as
+// a shared result hides the CTE from the optimizer: parent conditions are not delivered into it.
+// CTEs of a recursive WITH clause are left alone, as they may be referenced from the recursive member.
+// The hint is ignored in PSQL: the result is shared for the whole request execution, while a PSQL
+// loop may change data or variables the CTE depends on.
+static void pass1_materialize_ctes(DsqlCompilerScratch* dsqlScratch, SelectExprNode* input)
+{
+	if (dsqlScratch->isPsql())
+		return;
+
+	// Cursors wrap the query into a derived table.
+	if (!input->withClause)
+	{
+		if (const auto querySpec = nodeAs<SelectExprNode>(input->querySpec))
+			input = querySpec;
+	}
+
+	const auto withClause = input->withClause.getObject();
+
+	if (!withClause || withClause->recursive)
+		return;
+
+	for (const auto cte : *withClause)
+	{
+		if (cte->materialized.valueOr(false) && PASS1_cte_references(input, cte->alias) > 1)
+			cte->dsqlFlags |= RecordSourceNode::DFLAG_CTE_MATERIALIZE;
+	}
+}
+
+
+// Count references to a CTE by its alias in a query tree not processed yet. References which are
+// not found here (e.g. made through another CTE) make the result lower, never higher.
+unsigned PASS1_cte_references(ExprNode* node, const string& alias)
+{
+	if (!node)
+		return 0;
+
+	QualifiedName name;
+
+	if (const auto relNode = nodeAs<RelationSourceNode>(node))
+		name = relNode->dsqlName;
+	else if (const auto procNode = nodeAs<ProcedureSourceNode>(node); procNode && !procNode->inputSources)
+		name = procNode->dsqlName;
+
+	if (name.object.hasData())
+		return (name.schema.isEmpty() && name.package.isEmpty() && alias == name.object.c_str()) ? 1 : 0;
+
+	unsigned count = 0;
+
+	if (const auto selNode = nodeAs<SelectExprNode>(node))
+	{
+		if (const auto withClause = selNode->withClause.getObject())
+		{
+			for (const auto cte : *withClause)
+			{
+				// The CTE is hidden by the nested one with the same name
+				if (cte->alias == alias)
+					return 0;
+			}
+
+			for (const auto cte : *withClause)
+				count += PASS1_cte_references(cte, alias);
+		}
+
+		count += PASS1_cte_references(selNode->querySpec, alias);
+		count += PASS1_cte_references(selNode->orderClause, alias);
+
+		return count;
+	}
+
+	if (const auto unionNode = nodeAs<UnionSourceNode>(node))
+		return PASS1_cte_references(unionNode->dsqlClauses, alias);
+
+	if (const auto rseNode = nodeAs<RseNode>(node))
+	{
+		count += PASS1_cte_references(rseNode->dsqlFrom, alias);
+		count += PASS1_cte_references(rseNode->dsqlGroup, alias);
+		count += PASS1_cte_references(rseNode->dsqlHaving, alias);
+	}
+
+	NodeRefsHolder holder(*getDefaultMemoryPool());
+	node->getChildren(holder, true);
+
+	for (const auto ref : holder.refs)
+		count += PASS1_cte_references(*ref, alias);
+
+	return count;
+}
+
+
 // Wrapper for pass1_rse_impl. Substitute recursive CTE alias (if needed) and call pass1_rse_impl.
 static RseNode* pass1_rse(DsqlCompilerScratch* dsqlScratch, RecordSourceNode* input,
 	ValueListNode* order, RowsClause* rows, bool updateLock, bool skipLocked, USHORT flags)
@@ -43,6 +43,7 @@ bool PASS1_compare_alias(const Jrd::QualifiedName& contextAlias, const Jrd::Qual
 bool PASS1_compare_alias(const Firebird::ObjectsArray<Jrd::QualifiedName>& contextAlias,
 	const Firebird::ObjectsArray<Jrd::QualifiedName>& lookupAlias);
 Jrd::BoolExprNode* PASS1_compose(Jrd::BoolExprNode*, Jrd::BoolExprNode*, UCHAR);
+unsigned PASS1_cte_references(Jrd::ExprNode*, const Firebird::string&);
 Jrd::DeclareCursorNode* PASS1_cursor_name(Jrd::DsqlCompilerScratch*, const Jrd::MetaName&, USHORT, bool);
 Jrd::RseNode* PASS1_derived_table(Jrd::DsqlCompilerScratch*, Jrd::SelectExprNode*, const char*,
 	const Jrd::SelectNode* = nullptr);
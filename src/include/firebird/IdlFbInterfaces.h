@@ -7843,6 +7843,14 @@ namespace Firebird
 		static CLOOP_CONSTEXPR unsigned RECORD_FRAGMENT_READS = 12;
 		static CLOOP_CONSTEXPR unsigned RECORD_RPT_READS = 13;
 		static CLOOP_CONSTEXPR unsigned RECORD_IMGC = 14;
+		static CLOOP_CONSTEXPR unsigned RECORD_WAIT_TIME = 15;
+		static CLOOP_CONSTEXPR unsigned RECORD_GC_TIME = 16;
+		static CLOOP_CONSTEXPR unsigned RECORD_INSERT_WAITS = 17;
+		static CLOOP_CONSTEXPR unsigned WAIT_LATCHES = 0;
+		static CLOOP_CONSTEXPR unsigned WAIT_LOCKS = 1;
+		static CLOOP_CONSTEXPR unsigned WAIT_PAGE_READS = 2;
+		static CLOOP_CONSTEXPR unsigned WAIT_PAGE_WRITES = 3;
+		static CLOOP_CONSTEXPR unsigned WAIT_SORT_IO = 4;
 
 		unsigned getObjectCount()
 		{
@@ -7902,6 +7910,7 @@ namespace Firebird
 
 		static CLOOP_CONSTEXPR unsigned COUNTER_GROUP_PAGES = 0;
 		static CLOOP_CONSTEXPR unsigned COUNTER_GROUP_TABLES = 1;
+		static CLOOP_CONSTEXPR unsigned COUNTER_GROUP_WAITS = 2;
 
 		ISC_UINT64 getElapsedTime()
 		{
@@ -554,4 +554,7 @@
 #define blr_invoke_agg_function_args					(unsigned char) 3
 #define blr_invoke_agg_function_filter				(unsigned char) 4
 
+// Union evaluated once and shared by all its references with the same id
+#define blr_union_shared			(unsigned char) 238
+
 #endif // FIREBIRD_IMPL_BLR_H
@@ -4186,6 +4186,14 @@ type
 		const RECORD_FRAGMENT_READS = Cardinal(12);
 		const RECORD_RPT_READS = Cardinal(13);
 		const RECORD_IMGC = Cardinal(14);
+		const RECORD_WAIT_TIME = Cardinal(15);
+		const RECORD_GC_TIME = Cardinal(16);
+		const RECORD_INSERT_WAITS = Cardinal(17);
+		const WAIT_LATCHES = Cardinal(0);
+		const WAIT_LOCKS = Cardinal(1);
+		const WAIT_PAGE_READS = Cardinal(2);
+		const WAIT_PAGE_WRITES = Cardinal(3);
+		const WAIT_SORT_IO = Cardinal(4);
 
 		function getObjectCount(): Cardinal;
 		function getMaxCounterIndex(): Cardinal;
@@ -4214,6 +4222,7 @@ type
 		const VERSION = 2;
 		const COUNTER_GROUP_PAGES = Cardinal(0);
 		const COUNTER_GROUP_TABLES = Cardinal(1);
+		const COUNTER_GROUP_WAITS = Cardinal(2);
 
 		function getElapsedTime(): QWord;
 		function getFetchedRecords(): QWord;
@@ -6240,6 +6249,7 @@ const
 	 isc_dyn_cannot_infer_schema = 336068929;
 	 isc_dyn_column_name_exists = 336068931;
 	 isc_dyn_function_mismatch = 336068935;
+	 isc_dyn_invalid_sequence_cache = 336068936;
 	 isc_gbak_unknown_switch = 336330753;
 	 isc_gbak_page_size_missing = 336330754;
 	 isc_gbak_page_size_toobig = 336330755;
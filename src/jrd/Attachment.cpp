@@ -199,6 +199,7 @@ Jrd::Attachment::Attachment(MemoryPool* pool, Database* dbb, JProvider* provider
 	  att_ss_user(nullptr),
 	  att_active_snapshots(*pool),
 	  att_requests(*pool),
+	  att_monitor_time(0),
 	  att_lock_owner_id(Database::getLockOwnerId()),
 	  att_backup_state_counter(0),
 	  att_stats(*pool),
@@ -230,6 +231,7 @@ Jrd::Attachment::Attachment(MemoryPool* pool, Database* dbb, JProvider* provider
 	  att_system_schema_search_path(FB_NEW_POOL(*pool) AnyRef<ObjectsArray<MetaString>>(*pool)),
 	  att_unqualified_charset_resolved_cache_search_path(att_schema_search_path),
 	  att_unqualified_charset_resolved_cache(*pool),
+	  att_insert_pages(*pool),
 	  att_parallel_workers(0),
 	  att_local_temporary_tables(*pool),
 	  att_repl_appliers(*pool),
@@ -573,6 +575,16 @@ bool Attachment::hasActiveRequests() const noexcept
 }
 
 
+// Quota of memory cached by temporary spaces of all statements of the attachment
+TempCacheQuota* Jrd::Attachment::getTempCacheQuota()
+{
+	if (!att_temp_cache_quota)
+		att_temp_cache_quota = FB_NEW TempCacheQuota(att_database->dbb_config->getAttachmentTempCacheLimit());
+
+	return att_temp_cache_quota;
+}
+
+
 void Jrd::Attachment::initLocks(thread_db* tdbb)
 {
 	// Take out lock on attachment id
@@ -36,6 +36,7 @@
 #include "../jrd/RuntimeStatistics.h"
 #include "../jrd/Coercion.h"
 #include "../jrd/LocalTemporaryTable.h"
+#include "../jrd/TempSpace.h"
 
 #include "../common/classes/ByteChunk.h"
 #include "../common/classes/GenericMap.h"
@@ -533,6 +534,7 @@ public:
 	Lock*		att_cancel_lock;			// Lock to cancel the active request
 	Lock*		att_monitor_lock;			// Lock for monitoring purposes
 	ULONG		att_monitor_generation;		// Monitoring state generation
+	SINT64		att_monitor_time;			// When monitoring state was dumped last time
 	Lock*		att_profiler_listener_lock;	// Lock for remote profiler listener
 	const ULONG	att_lock_owner_id;			// ID for the lock manager
 	SLONG		att_lock_owner_handle;		// Handle for the lock manager
@@ -602,6 +604,14 @@ public:
 		att_unqualified_charset_resolved_cache_search_path;
 	Firebird::NonPooledMap<MetaName, QualifiedName> att_unqualified_charset_resolved_cache;
 
+	struct InsertPage
+	{
+		ULONG page;			// data page number
+		ULONG sequence;		// its sequence in the relation, to find it on the pointer page
+	};
+
+	Firebird::NonPooledMap<MetaId, InsertPage> att_insert_pages;	// Per-relation data pages to insert into
+
 	int att_parallel_workers;
 	Firebird::TriState att_opt_first_rows;
 
@@ -631,6 +641,8 @@ public:
 
 	bool locksmith(thread_db* tdbb, SystemPrivilege sp) const;
 
+	TempCacheQuota* getTempCacheQuota();
+
 	jrd_tra* getSysTransaction() noexcept;
 	void setSysTransaction(jrd_tra* trans) noexcept;		// used only by TRA_init
 	jrd_tra* getMetaTransaction(thread_db* tdbb);			// RORC to read metadata
@@ -806,6 +818,7 @@ private:
 	unsigned int att_idle_timeout;		// seconds
 	unsigned int att_stmt_timeout;		// milliseconds
 	Firebird::RefPtr<Firebird::TimerImpl> att_idle_timer;
+	Firebird::RefPtr<TempCacheQuota> att_temp_cache_quota;	// memory cached by temp spaces of all statements
 
 	Firebird::Array<DsqlBatch*> att_batches;
 	InitialOptions att_initial_options;	// Initial session options
@@ -42,6 +42,7 @@
 #include "../common/os/os_utils.h"
 #include "../jrd/met.h"
 #include "../jrd/Statement.h"
+#include "../dsql/DsqlStatementCache.h"
 
 // Thread data block
 #include "../common/ThreadData.h"
@@ -221,6 +222,7 @@ namespace Jrd
 		delete dbb_monitoring_data;
 		delete dbb_backup_manager;
 		delete dbb_crypto_manager;
+		delete dbb_shared_statement_cache;
 		delete dbb_mdc;
 
 		fb_assert(dbb_pools[0] == dbb_permanent);
@@ -889,6 +891,8 @@ namespace Jrd
 		dbb_compatibility_index(~0U),
 		dbb_dic(*p),
 		dbb_mdc(FB_NEW_POOL(*p) MetadataCache(*p)),
+		dbb_shared_statement_cache(FB_NEW_POOL(*p) DsqlSharedStatementCache(*p)),
+		dbb_gen_cache(*p),
 		dbb_user_ids(*p),
 		dbb_del_pages(*p)
 	{
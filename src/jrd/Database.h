@@ -95,6 +95,7 @@ class GarbageCollector;
 class CryptoManager;
 class KeywordsMap;
 class MetadataCache;
+class DsqlSharedStatementCache;
 class ExtEngineManager;
 class RelationPermanent;
 
@@ -309,6 +310,15 @@ public:
 	{
 		Firebird::MemoryStats temp_stats;
 		MemoryPool* const pool = MemoryPool::createPool(NULL, temp_stats);
+
+		// Database pool is used by all attachments in SuperServer, metadata cache
+		// is allocated from it too. Statement, request and transaction pools are
+		// not cached: they are used by one attachment at a time, so they have no
+		// contention to avoid, and they're destroyed often while every destroyed
+		// cached pool has to be purged from the caches of all threads.
+		if (shared)
+			pool->enableThreadCache();
+
 		Database* const dbb = FB_NEW_POOL(*pool) Database(pool, pConf, shared);
 		pool->setStatsGroup(dbb->dbb_memory_stats);
 		return dbb;
@@ -468,6 +478,42 @@ public:
 	Firebird::InitInstance<Keywords, Keywords::Allocator, Firebird::TraditionalDelete> dbb_keywords;
 
 	MetadataCache* dbb_mdc;
+	DsqlSharedStatementCache* dbb_shared_statement_cache;	// DSQL statements shared by attachments
+
+	// Block of values reserved by a sequence declared with CACHE
+	struct CachedGenerator
+	{
+		SINT64 value;	// last value handed out
+		SLONG step;		// increment the block was reserved with
+		SLONG left;		// values still available in the block
+
+		// Block of cache values reserved by moving the generator to last,
+		// its first value is handed out by the caller
+		static CachedGenerator reserve(SINT64 last, SLONG step, SLONG cache)
+		{
+			CachedGenerator block;
+			block.step = step;
+			block.left = cache - 1;
+			block.value = last - (SINT64) step * (cache - 1);
+			return block;
+		}
+
+		// Hand out the next value, unless the block is exhausted or was
+		// reserved with another increment
+		bool next(SLONG aStep, SINT64& result)
+		{
+			if (!left || step != aStep)
+				return false;
+
+			left--;
+			value += step;
+			result = value;
+			return true;
+		}
+	};
+
+	Firebird::NonPooledMap<SLONG, CachedGenerator> dbb_gen_cache;	// reserved blocks by generator id
+	Firebird::Mutex dbb_gen_cache_mutex;
 
 private:
 	Firebird::GenericMap<Firebird::Pair<Firebird::Left<
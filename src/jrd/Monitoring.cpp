@@ -50,6 +50,7 @@
 #include "../jrd/met.h"
 #include "../jrd/Statement.h"
 #include "../jrd/optimizer/Optimizer.h"
+#include "../common/utils_proto.h"
 #include <numeric>
 
 #ifdef WIN_NT
@@ -68,8 +69,9 @@ namespace
 	class DumpWriter final : public SnapshotData::DumpRecord::Writer
 	{
 	public:
-		DumpWriter(MonitoringData* data, AttNumber att_id, const char* user_name, ULONG generation)
-			: dump(data), offset(dump->setup(att_id, user_name, generation))
+		DumpWriter(MonitoringData* data, AttNumber att_id, const char* user_name,
+				   ULONG generation, SINT64 dump_time)
+			: dump(data), offset(dump->setup(att_id, user_name, generation, dump_time))
 		{
 			fb_assert(offset);
 		}
@@ -112,16 +114,16 @@ namespace
 
 const Format* MonitoringTableScan::getFormat(thread_db* tdbb, RelationPermanent* relation) const
 {
-	const auto* const snapshot = MonitoringSnapshot::create(tdbb);
-	return snapshot->getData(relation)->getFormat();
+	const auto snapshot = MonitoringSnapshot::create(tdbb);
+	return snapshot->getData(tdbb, relation)->getFormat();
 }
 
 
 bool MonitoringTableScan::retrieveRecord(thread_db* tdbb, jrd_rel* relation,
 										 FB_UINT64 position, Record* record) const
 {
-	const auto* const snapshot = MonitoringSnapshot::create(tdbb);
-	if (!snapshot->getData(getPermanent(relation))->fetch(position, record))
+	const auto snapshot = MonitoringSnapshot::create(tdbb);
+	if (!snapshot->getData(tdbb, getPermanent(relation))->fetch(position, record))
 		return false;
 
 	if (relation->getId() == rel_mon_attachments || relation->getId() == rel_mon_statements)
@@ -254,11 +256,13 @@ void MonitoringData::release()
 }
 
 
-void MonitoringData::enumerate(const char* userName, ULONG generation, SessionList& sessions)
+void MonitoringData::enumerate(const char* userName, ULONG generation, SINT64 dumpLimit,
+	SessionList& sessions)
 {
 	const bool init = sessions.isEmpty();
 
-	// When initializing, collect all sessions older than the given generation.
+	// When initializing, collect all sessions older than the given generation,
+	// except those that have dumped their state not earlier than dumpLimit (if set).
 	// Otherwise, remove sessions that have updated their generation.
 
 	for (ULONG offset = HEADER_SIZE; offset < m_sharedMemory->getHeader()->used;)
@@ -271,8 +275,11 @@ void MonitoringData::enumerate(const char* userName, ULONG generation, SessionLi
 		{
 			if (init)
 			{
-				if (element->generation < generation)
+				if (element->generation < generation &&
+					!(dumpLimit && element->dumpTime >= dumpLimit))
+				{
 					sessions.add(element->attId);
+				}
 			}
 			else if (element->generation >= generation)
 				sessions.findAndRemove(element->attId);
@@ -306,7 +313,7 @@ void MonitoringData::read(const char* userName, TempSpace& temp)
 }
 
 
-ULONG MonitoringData::setup(AttNumber att_id, const char* userName, ULONG generation)
+ULONG MonitoringData::setup(AttNumber att_id, const char* userName, ULONG generation, SINT64 dumpTime)
 {
 	const FB_UINT64 offset = FB_ALIGN(m_sharedMemory->getHeader()->used, FB_ALIGNMENT);
 	const ULONG delta = offset + sizeof(Element) - m_sharedMemory->getHeader()->used;
@@ -321,6 +328,7 @@ ULONG MonitoringData::setup(AttNumber att_id, const char* userName, ULONG genera
 	snprintf(element->userName, sizeof(element->userName), "%s", userName);
 	element->generation = generation;
 	element->length = 0;
+	element->dumpTime = dumpTime;
 	m_sharedMemory->getHeader()->used += delta;
 	return offset;
 }
@@ -446,7 +454,7 @@ MonitoringSnapshot* MonitoringSnapshot::create(thread_db* tdbb)
 
 
 MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
-	: SnapshotData(pool)
+	: SnapshotData(pool), m_pool(pool), m_dump(pool, SCRATCH), m_locations(pool), m_blobs(pool)
 {
 	PAG_header(tdbb, true);
 
@@ -455,23 +463,6 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 
 	const auto selfAttId = attachment->att_attachment_id;
 
-	// Initialize record buffers
-	const auto dbb_buffer = allocBuffer(tdbb, pool, rel_mon_database);
-	const auto att_buffer = allocBuffer(tdbb, pool, rel_mon_attachments);
-	const auto tra_buffer = allocBuffer(tdbb, pool, rel_mon_transactions);
-	const auto cmp_stmt_buffer = dbb->getEncodedOdsVersion() >= ODS_13_1 ?
-		allocBuffer(tdbb, pool, rel_mon_compiled_statements) :
-		nullptr;
-	const auto stmt_buffer = allocBuffer(tdbb, pool, rel_mon_statements);
-	const auto call_buffer = allocBuffer(tdbb, pool, rel_mon_calls);
-	const auto io_stat_buffer = allocBuffer(tdbb, pool, rel_mon_io_stats);
-	const auto rec_stat_buffer = allocBuffer(tdbb, pool, rel_mon_rec_stats);
-	const auto ctx_var_buffer = allocBuffer(tdbb, pool, rel_mon_ctx_vars);
-	const auto mem_usage_buffer = allocBuffer(tdbb, pool, rel_mon_mem_usage);
-	const auto tab_stat_buffer = allocBuffer(tdbb, pool, rel_mon_tab_stats);
-	const auto local_temp_tables_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_tables);
-	const auto local_temp_table_columns_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_table_columns);
-
 	// Increment the global monitor generation
 
 	const auto generation = dbb->newMonitorGeneration();
@@ -482,10 +473,12 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 
 	// Enumerate active sessions and ensure they have dumped their state.
 	// Check that by comparing the session generation with the current one.
+	// Sessions that have published their state recently enough are not signalled.
 
 	const auto locksmith = attachment->locksmith(tdbb, MONITOR_ANY_ATTACHMENT);
 	const auto userName = attachment->getEffectiveUserName();
 	const auto userNamePtr = locksmith ? nullptr : userName.c_str();
+	const auto publishLimit = Monitoring::getPublishLimit(dbb);
 
 	Lock temp_lock(tdbb, sizeof(AttNumber), LCK_monitor), *lock = &temp_lock;
 	MonitoringData::SessionList sessions(pool);
@@ -497,7 +490,7 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 		{ // scope for the guard
 
 			MonitoringData::Guard guard(dbb->dbb_monitoring_data);
-			dbb->dbb_monitoring_data->enumerate(userNamePtr, generation, sessions);
+			dbb->dbb_monitoring_data->enumerate(userNamePtr, generation, publishLimit, sessions);
 		}
 
 		if (!sessions.hasData())
@@ -535,171 +528,151 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 	// Collect monitoring data. Start by gathering database-level info,
 	// it goes directly to the temporary space (as it's not stored in the shared dump).
 
-	TempSpace temp_space(pool, SCRATCH);
-
 	{ // scope for putDatabase and its utilities
 
-		TempWriter writer(temp_space);
+		TempWriter writer(m_dump);
 		SnapshotData::DumpRecord tempRecord(pool, writer);
 
 		Monitoring::putDatabase(tdbb, tempRecord);
 	}
 
-	// Read the dump into a temporary space
+	// Read the dump into a temporary space. It's parsed into the record buffers
+	// lazily, when the particular monitoring table is accessed for the first time.
 
 	{ // scope for the guard
 
 		MonitoringData::Guard guard(dbb->dbb_monitoring_data);
-		dbb->dbb_monitoring_data->read(userNamePtr, temp_space);
+		dbb->dbb_monitoring_data->read(userNamePtr, m_dump);
 	}
 
-	// Parse the dump
+	// Walk the dump once remembering where the records of every table are
 
-	// BlobID's of statement text and plan
-	struct StmtBlobs { bid text; bid plan; };
+	MonitoringData::Reader reader(pool, m_dump);
 
-	// Map compiled statement id to blobs ids
-	NonPooledMap<FB_UINT64, StmtBlobs> blobsMap(pool);
+	DumpLocation location;
+	while (reader.skipRecord(location.relId, location.offset))
+		m_locations.add(location);
+}
 
-	MonitoringData::Reader reader(pool, temp_space);
 
-	SnapshotData::DumpRecord dumpRecord(pool);
-	while (reader.getRecord(dumpRecord))
-	{
-		const int rid = dumpRecord.getRelationId();
+RecordBuffer* MonitoringSnapshot::getData(thread_db* tdbb, const RelationPermanent* relation)
+{
+	fb_assert(relation);
+
+	const auto rel_id = relation->getId();
+
+	if (const auto buffer = getData(rel_id))
+		return buffer;
+
+	parseDump(tdbb, rel_id);
+
+	return getData(rel_id);
+}
+
+
+void MonitoringSnapshot::parseDump(thread_db* tdbb, int rel_id)
+{
+	const auto dbb = tdbb->getDatabase();
+	const bool mapBlobs = (dbb->getEncodedOdsVersion() >= ODS_13_1);
+
+	// Statements refer to the text and plan blobs of the compiled statements,
+	// so the latter must be parsed first
 
-		RecordBuffer* buffer = nullptr;
-		Record* record = nullptr;
+	if (mapBlobs && rel_id == rel_mon_statements && !getData(rel_mon_compiled_statements))
+		parseDump(tdbb, rel_mon_compiled_statements);
 
-		switch (rid)
+	const auto buffer = allocBuffer(tdbb, m_pool, rel_id);
+
+	MonitoringData::Reader reader(m_pool, m_dump);
+	SnapshotData::DumpRecord dumpRecord(m_pool);
+
+	for (const auto& location : m_locations)
+	{
+		if (location.relId != rel_id)
+			continue;
+
+		reader.seek(location.offset);
+		if (!reader.getRecord(dumpRecord) || dumpRecord.getRelationId() != rel_id)
 		{
-		case rel_mon_database:
-			buffer = dbb_buffer;
-			break;
-		case rel_mon_attachments:
-			buffer = att_buffer;
-			break;
-		case rel_mon_transactions:
-			buffer = tra_buffer;
-			break;
-		case rel_mon_compiled_statements:
-			buffer = cmp_stmt_buffer;
-			break;
-		case rel_mon_statements:
-			buffer = stmt_buffer;
-			break;
-		case rel_mon_calls:
-			buffer = call_buffer;
-			break;
-		case rel_mon_io_stats:
-			buffer = io_stat_buffer;
-			break;
-		case rel_mon_rec_stats:
-			buffer = rec_stat_buffer;
-			break;
-		case rel_mon_ctx_vars:
-			buffer = ctx_var_buffer;
-			break;
-		case rel_mon_mem_usage:
-			buffer = mem_usage_buffer;
-			break;
-		case rel_mon_tab_stats:
-			buffer = tab_stat_buffer;
-			break;
-		case rel_mon_local_temp_tables:
-			buffer = local_temp_tables_buffer;
-			break;
-		case rel_mon_local_temp_table_columns:
-			buffer = local_temp_table_columns_buffer;
-			break;
-		default:
 			fb_assert(false);
+			continue;
 		}
 
-		if (buffer)
-		{
-			record = buffer->getTempRecord();
-			record->nullify();
-		}
+		Record* const record = buffer->getTempRecord();
+		record->nullify();
 
 		bool store_record = false;
 
 		SnapshotData::DumpField dumpField;
 		while (dumpRecord.getField(dumpField))
 		{
-			if (record)
-			{
-				putField(tdbb, record, dumpField);
-				store_record = true;
-			}
+			putField(tdbb, record, dumpField);
+			store_record = true;
 		}
 
-		if (store_record)
+		if (!store_record)
+			continue;
+
+		if (mapBlobs)
 		{
-			if (dbb->getEncodedOdsVersion() >= ODS_13_1)
-			{
-				// The code below requires that rel_mon_compiled_statements put
-				// into dump before	rel_mon_statements, see also dumpAttachment()
+			FB_UINT64 stmtId;
+			StmtBlobs stmtBlobs;
+			dsc desc;
 
-				FB_UINT64 stmtId;
-				StmtBlobs stmtBlobs;
-				dsc desc;
+			if ((rel_id == rel_mon_compiled_statements) && EVL_field(nullptr, record, f_mon_cmp_stmt_id, &desc))
+			{
+				fb_assert(desc.dsc_dtype == dtype_int64);
+				stmtId = *(FB_UINT64*) desc.dsc_address;
 
-				if ((rid == rel_mon_compiled_statements) && EVL_field(nullptr, record, f_mon_cmp_stmt_id, &desc))
+				if (EVL_field(nullptr, record, f_mon_cmp_stmt_sql_text, &desc))
 				{
-					fb_assert(desc.dsc_dtype == dtype_int64);
-					stmtId = *(FB_UINT64*) desc.dsc_address;
+					fb_assert(desc.isBlob());
+					stmtBlobs.text = *reinterpret_cast<bid*>(desc.dsc_address);
+				}
+				else
+					stmtBlobs.text.clear();
 
-					if (EVL_field(nullptr, record, f_mon_cmp_stmt_sql_text, &desc))
-					{
-						fb_assert(desc.isBlob());
-						stmtBlobs.text = *reinterpret_cast<bid*>(desc.dsc_address);
-					}
-					else
-						stmtBlobs.text.clear();
+				if (EVL_field(nullptr, record, f_mon_cmp_stmt_expl_plan, &desc))
+				{
+					fb_assert(desc.isBlob());
+					stmtBlobs.plan = *reinterpret_cast<bid*>(desc.dsc_address);
+				}
+				else
+					stmtBlobs.plan.clear();
 
-					if (EVL_field(nullptr, record, f_mon_cmp_stmt_expl_plan, &desc))
-					{
-						fb_assert(desc.isBlob());
-						stmtBlobs.plan = *reinterpret_cast<bid*>(desc.dsc_address);
-					}
-					else
-						stmtBlobs.plan.clear();
+				if (!stmtBlobs.text.isEmpty() || !stmtBlobs.plan.isEmpty())
+					m_blobs.put(stmtId, stmtBlobs);
+			}
+			else if ((rel_id == rel_mon_statements) && EVL_field(nullptr, record, f_mon_stmt_cmp_stmt_id, &desc))
+			{
+				fb_assert(desc.dsc_dtype == dtype_int64);
+				stmtId = *(FB_UINT64*) desc.dsc_address;
 
-					if (!stmtBlobs.text.isEmpty() || !stmtBlobs.plan.isEmpty())
-						blobsMap.put(stmtId, stmtBlobs);
-				}
-				else if ((rid == rel_mon_statements) && EVL_field(nullptr, record, f_mon_stmt_cmp_stmt_id, &desc))
+				if (m_blobs.get(stmtId, stmtBlobs))
 				{
-					fb_assert(desc.dsc_dtype == dtype_int64);
-					stmtId = *(FB_UINT64*) desc.dsc_address;
-
-					if (blobsMap.get(stmtId, stmtBlobs))
+					if (!stmtBlobs.text.isEmpty())
 					{
-						if (!stmtBlobs.text.isEmpty())
+						record->clearNull(f_mon_stmt_sql_text);
+						if (EVL_field(nullptr, record, f_mon_stmt_sql_text, &desc))
 						{
-							record->clearNull(f_mon_stmt_sql_text);
-							if (EVL_field(nullptr, record, f_mon_stmt_sql_text, &desc))
-							{
-								fb_assert(desc.isBlob());
-								*reinterpret_cast<bid*>(desc.dsc_address) = stmtBlobs.text;
-							}
+							fb_assert(desc.isBlob());
+							*reinterpret_cast<bid*>(desc.dsc_address) = stmtBlobs.text;
 						}
-						if (!stmtBlobs.plan.isEmpty())
+					}
+					if (!stmtBlobs.plan.isEmpty())
+					{
+						record->clearNull(f_mon_stmt_expl_plan);
+						if (EVL_field(nullptr, record, f_mon_stmt_expl_plan, &desc))
 						{
-							record->clearNull(f_mon_stmt_expl_plan);
-							if (EVL_field(nullptr, record, f_mon_stmt_expl_plan, &desc))
-							{
-								fb_assert(desc.isBlob());
-								*reinterpret_cast<bid*>(desc.dsc_address) = stmtBlobs.plan;
-							}
+							fb_assert(desc.isBlob());
+							*reinterpret_cast<bid*>(desc.dsc_address) = stmtBlobs.plan;
 						}
 					}
 				}
 			}
-
-			buffer->store(record);
 		}
+
+		buffer->store(record);
 	}
 }
 
@@ -1348,6 +1321,11 @@ void Monitoring::putRequest(thread_db* tdbb, SnapshotData::DumpRecord& record, c
 	if (dbb->getEncodedOdsVersion() >= ODS_13_1)
 		record.storeInteger(f_mon_stmt_cmp_stmt_id, statement->getStatementId());
 
+	// memory cached by sorts and record buffers, number of them spilled to disk
+	const auto quota = request->req_temp_cache_quota.getPtr();
+	record.storeInteger(f_mon_stmt_temp_cache_used, quota ? quota->getUsage() : 0);
+	record.storeInteger(f_mon_stmt_temp_cache_spills, quota ? quota->getSpills() : 0);
+
 	record.write();
 
 	putStatistics(tdbb, record, request->req_stats, stat_id, stat_statement);
@@ -1518,6 +1496,11 @@ void Monitoring::putStatistics(thread_db* tdbb, SnapshotData::DumpRecord& record
 	record.storeInteger(f_mon_io_page_writes, statistics[PageStatType::WRITES]);
 	record.storeInteger(f_mon_io_page_fetches, statistics[PageStatType::FETCHES]);
 	record.storeInteger(f_mon_io_page_marks, statistics[PageStatType::MARKS]);
+	record.storeInteger(f_mon_io_page_read_time, statistics[WaitStatType::PAGE_READS]);
+	record.storeInteger(f_mon_io_page_write_time, statistics[WaitStatType::PAGE_WRITES]);
+	record.storeInteger(f_mon_io_latch_wait_time, statistics[WaitStatType::LATCH_WAITS]);
+	record.storeInteger(f_mon_io_lock_wait_time, statistics[WaitStatType::LOCK_WAITS]);
+	record.storeInteger(f_mon_io_sort_io_time, statistics[WaitStatType::SORT_IO]);
 	record.write();
 
 	// logical I/O statistics (global)
@@ -1539,6 +1522,9 @@ void Monitoring::putStatistics(thread_db* tdbb, SnapshotData::DumpRecord& record
 	record.storeInteger(f_mon_rec_frg_reads, statistics[RecordStatType::FRAGMENT_READS]);
 	record.storeInteger(f_mon_rec_rpt_reads, statistics[RecordStatType::RPT_READS]);
 	record.storeInteger(f_mon_rec_imgc, statistics[RecordStatType::IMGC]);
+	record.storeInteger(f_mon_rec_wait_time, statistics[RecordStatType::WAIT_TIME]);
+	record.storeInteger(f_mon_rec_gc_time, statistics[RecordStatType::GC_TIME]);
+	record.storeInteger(f_mon_rec_insert_waits, statistics[RecordStatType::INSERT_WAITS]);
 	record.write();
 
 	// logical I/O statistics (table wise)
@@ -1608,6 +1594,9 @@ void Monitoring::putStatistics(thread_db* tdbb, SnapshotData::DumpRecord& record
 		record.storeInteger(f_mon_rec_frg_reads, counts[RecordStatType::FRAGMENT_READS]);
 		record.storeInteger(f_mon_rec_rpt_reads, counts[RecordStatType::RPT_READS]);
 		record.storeInteger(f_mon_rec_imgc, counts[RecordStatType::IMGC]);
+		record.storeInteger(f_mon_rec_wait_time, counts[RecordStatType::WAIT_TIME]);
+		record.storeInteger(f_mon_rec_gc_time, counts[RecordStatType::GC_TIME]);
+		record.storeInteger(f_mon_rec_insert_waits, counts[RecordStatType::INSERT_WAITS]);
 		record.write();
 	}
 }
@@ -1662,8 +1651,10 @@ void Monitoring::checkState(thread_db* tdbb)
 
 	if (const auto generation = checkGeneration(dbb, attachment))
 	{
-		// Dump attachment state
-		dumpAttachment(tdbb, attachment, generation);
+		// Dump attachment state, unless it was published recently enough
+		// to be used by the monitoring snapshots as is
+		if (!checkPublished(dbb, attachment))
+			dumpAttachment(tdbb, attachment, generation);
 	}
 
 	if (attachment->att_flags & ATT_monitor_disabled)
@@ -1675,6 +1666,21 @@ void Monitoring::checkState(thread_db* tdbb)
 }
 
 
+SINT64 Monitoring::getPublishLimit(const Database* dbb)
+{
+	// Return the oldest dump time that is still considered fresh,
+	// or zero if every snapshot must ask the sessions to dump their state
+
+	const ULONG interval = dbb->dbb_config->getMonitoringPublishInterval();
+
+	if (!interval)
+		return 0;
+
+	return fb_utils::query_performance_counter() -
+		(SINT64) interval * fb_utils::query_performance_frequency();
+}
+
+
 void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG generation)
 {
 	if (!attachment->att_user)
@@ -1691,11 +1697,13 @@ void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG g
 	fb_assert(dbb->dbb_monitoring_data);
 
 	attachment->att_monitor_generation = generation;
+	attachment->att_monitor_time = fb_utils::query_performance_counter();
 
 	MonitoringData::Guard guard(dbb->dbb_monitoring_data);
 	dbb->dbb_monitoring_data->cleanup(attId);
 
-	DumpWriter writer(dbb->dbb_monitoring_data, attId, userName.c_str(), generation);
+	DumpWriter writer(dbb->dbb_monitoring_data, attId, userName.c_str(), generation,
+		attachment->att_monitor_time);
 	SnapshotData::DumpRecord record(pool, writer);
 
 	putAttachment(tdbb, record, attachment);
@@ -1783,7 +1791,7 @@ void Monitoring::publishAttachment(thread_db* tdbb)
 		dbb->getMonitorGeneration();
 
 	MonitoringData::Guard guard(dbb->dbb_monitoring_data);
-	dbb->dbb_monitoring_data->setup(attachment->att_attachment_id, userName, generation);
+	dbb->dbb_monitoring_data->setup(attachment->att_attachment_id, userName, generation, 0);
 
 	attachment->att_flags |= ATT_monitor_init;
 }
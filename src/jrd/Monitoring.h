@@ -267,7 +267,7 @@ struct MonitoringHeader : public Firebird::MemoryHeader
 
 class MonitoringData final : public Firebird::PermanentStorage, public Firebird::IpcObject
 {
-	static constexpr USHORT MONITOR_VERSION = 6;
+	static constexpr USHORT MONITOR_VERSION = 7;
 	static constexpr ULONG DEFAULT_SIZE = 1048576;
 
 	typedef MonitoringHeader Header;
@@ -278,6 +278,7 @@ class MonitoringData final : public Firebird::PermanentStorage, public Firebird:
 		TEXT userName[USERNAME_LENGTH + 1];
 		ULONG generation;
 		ULONG length;
+		SINT64 dumpTime;
 
 		inline ULONG getBlockLength() const
 		{
@@ -333,6 +334,32 @@ public:
 			return false;
 		}
 
+		// Skip the next record returning its relation id and location
+		bool skipRecord(int& relId, offset_t& location)
+		{
+			if (offset < source.getSize())
+			{
+				ULONG length;
+				source.read(offset, &length, sizeof(ULONG));
+
+				UCHAR id = 0;
+				if (length)
+					source.read(offset + sizeof(ULONG), &id, sizeof(UCHAR));
+
+				relId = id;
+				location = offset;
+				offset += sizeof(ULONG) + length;
+				return true;
+			}
+
+			return false;
+		}
+
+		void seek(offset_t location)
+		{
+			offset = location;
+		}
+
 	private:
 		TempSpace& source;
 		offset_t offset;
@@ -360,9 +387,9 @@ public:
 	void acquire();
 	void release();
 
-	void enumerate(const char*, ULONG, SessionList&);
+	void enumerate(const char*, ULONG, SINT64, SessionList&);
 	void read(const char*, TempSpace&);
-	ULONG setup(AttNumber, const char*, ULONG);
+	ULONG setup(AttNumber, const char*, ULONG, SINT64);
 	void write(ULONG, ULONG, const void*);
 
 	void cleanup(AttNumber);
@@ -393,11 +420,29 @@ protected:
 
 class MonitoringSnapshot final : public SnapshotData
 {
+	// BlobID's of statement text and plan
+	struct StmtBlobs { bid text; bid plan; };
+
+	// Location of a record in the dump
+	struct DumpLocation { int relId; offset_t offset; };
+
 public:
 	static MonitoringSnapshot* create(thread_db* tdbb);
 
+	using SnapshotData::getData;
+	RecordBuffer* getData(thread_db* tdbb, const RelationPermanent* relation);
+
 protected:
 	MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool);
+
+private:
+	void parseDump(thread_db* tdbb, int rel_id);
+
+	MemoryPool& m_pool;
+	TempSpace m_dump;
+	Firebird::Array<DumpLocation> m_locations;
+	// Map compiled statement id to blobs ids
+	Firebird::NonPooledMap<FB_UINT64, StmtBlobs> m_blobs;
 };
 
 
@@ -418,6 +463,14 @@ public:
 
 	static void checkState(thread_db* tdbb);
 
+	static SINT64 getPublishLimit(const Database* dbb);
+
+	static bool checkPublished(const Database* dbb, const Attachment* attachment)
+	{
+		const auto limit = getPublishLimit(dbb);
+		return limit && attachment->att_monitor_time >= limit;
+	}
+
 	static void dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG generation);
 
 	static void publishAttachment(thread_db* tdbb);
@@ -49,8 +49,13 @@ offset_t RecordBuffer::store(const Record* new_record)
 	fb_assert(new_record->getLength() == length);
 
 	if (!space)
+	{
 		space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH);
 
+		if (const auto request = JRD_get_thread_data()->getRequest())
+			space->setCacheQuota(request->getTempCacheQuota());
+	}
+
 	space->write(count * length, new_record->getData(), length);
 
 	return count++;
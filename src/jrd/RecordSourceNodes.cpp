@@ -2209,6 +2209,14 @@ UnionSourceNode* UnionSourceNode::parse(thread_db* tdbb, CompilerScratch* csb, c
 
 	node->recursive = blrOp == blr_recurse;
 
+	if (blrOp == blr_union_shared)
+	{
+		node->sharedId = csb->csb_blr_reader.getWord();
+
+		if (!node->sharedId)
+			PAR_syntax_error(csb, "blr_union_shared id");
+	}
+
 	node->stream = PAR_context(csb, NULL);
 
 	// assign separate context for mapped record if union is recursive
@@ -2278,7 +2286,20 @@ RecordSourceNode* UnionSourceNode::dsqlFieldRemapper(FieldRemapper& visitor)
 
 void UnionSourceNode::genBlr(DsqlCompilerScratch* dsqlScratch)
 {
-	dsqlScratch->appendUChar((recursive ? blr_recurse : blr_union));
+	// A CTE referenced more than once is evaluated by the first reference opened
+	// and read back by the others.
+	if (dsqlCte && (dsqlCte->dsqlFlags & DFLAG_CTE_MATERIALIZE) && dsqlCte->dsqlReferences > 1)
+	{
+		fb_assert(!recursive);
+
+		if (!dsqlCte->dsqlSharedId)
+			dsqlCte->dsqlSharedId = ++dsqlScratch->sharedUnionNumber;
+
+		dsqlScratch->appendUChar(blr_union_shared);
+		dsqlScratch->appendUShort(dsqlCte->dsqlSharedId);
+	}
+	else
+		dsqlScratch->appendUChar((recursive ? blr_recurse : blr_union));
 
 	// Obtain the context for UNION from the first dsql_map* node.
 	ValueExprNode* mapItem = dsqlParentRse->dsqlSelectList->items[0];
@@ -2465,8 +2486,9 @@ RecordSource* UnionSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool /*i
 		// AB: Try to distribute booleans from the top rse for an UNION to
 		// the WHERE clause of every single rse.
 		// hvlad: don't do it for recursive unions else they will work wrong !
+		// Neither for shared unions, as their result is reused by other references.
 		BoolExprNodeStack deliverStack;
-		if (!recursive)
+		if (!recursive && !sharedId)
 			genDeliverUnmapped(csb, parentStack, deliverStack, map, stream);
 
 		rsbs.add(opt->compile(rse, &deliverStack));
@@ -2489,8 +2511,19 @@ RecordSource* UnionSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool /*i
 			rsbs[0], rsbs[1], maps[0], maps[1], keyStreams, baseImpure);
 	}
 
-	return FB_NEW_POOL(*tdbb->getDefaultPool()) Union(csb, stream, clauses.getCount(), rsbs.begin(),
-		maps.begin(), keyStreams);
+	RecordSource* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) Union(csb, stream,
+		clauses.getCount(), rsbs.begin(), maps.begin(), keyStreams);
+
+	if (sharedId)
+	{
+		if (const auto sharedImpure = MaterializedStream::getSharedImpure(csb, sharedId, stream))
+		{
+			return FB_NEW_POOL(*tdbb->getDefaultPool()) MaterializedStream(csb, stream, rsb,
+				sharedImpure.value());
+		}
+	}
+
+	return rsb;
 }
 
 // Identify all of the streams for which a dbkey may need to be carried through a sort.
@@ -631,6 +631,7 @@ public:
 public:
 	RecSourceListNode* dsqlClauses;
 	RseNode* dsqlParentRse;
+	SelectExprNode* dsqlCte = nullptr;	// materialized CTE wrapped by this union
 
 private:
 	Firebird::Array<NestConst<RseNode> > clauses;	// RseNode's for union
@@ -640,6 +641,7 @@ private:
 public:
 	bool dsqlAll;		// UNION ALL
 	bool recursive;		// union node is a recursive union
+	USHORT sharedId = 0;	// non-zero if evaluated once for all references with the same id
 };
 
 class WindowSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_WINDOW>
@@ -995,6 +997,9 @@ public:
 	NestConst<WithClause> withClause;
 	Firebird::string alias;
 	Firebird::ObjectsArray<MetaName>* columns;
+	Firebird::TriState materialized;	// CTE's [NOT] MATERIALIZED hint
+	unsigned dsqlReferences = 0;		// number of references to a materialized CTE
+	USHORT dsqlSharedId = 0;			// id of a materialized CTE in the generated BLR
 };
 
 class TableValueFunctionSourceNode
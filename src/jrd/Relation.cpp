@@ -1087,6 +1087,8 @@ void RelationPages::free(RelationPages*& nextFree)
 
 	dpMap.clear();
 	dpMapMark = 0;
+
+	spaceMap.clear();
 }
 
 
@@ -334,7 +334,8 @@ public:
 		  rel_last_free_pri_dp(0), rel_last_free_blb_dp(0),
 		  rel_pg_space_id(DB_PAGE_SPACE), rel_next_free(NULL),
 		  dpMap(pool),
-		  dpMapMark(0)
+		  dpMapMark(0),
+		  spaceMap(pool)
 	{}
 
 	inline SLONG addRef() noexcept
@@ -415,6 +416,52 @@ public:
 		dpMapMark -= minMark;
 	}
 
+	// Free space map keeps a coarse free space class of every data page
+	// seen so far, two pages per byte. Zero class means "unknown".
+
+	static constexpr UCHAR SPACE_CLASSES = 16;
+
+	UCHAR getSpaceClass(ULONG dpSequence)
+	{
+		Firebird::MutexLockGuard g(spaceMutex, FB_FUNCTION);
+		return spaceClass(dpSequence);
+	}
+
+	// Copy classes of the given range of pages at once, e.g. of all pages
+	// listed on a pointer page, to not take the mutex for every one of them
+	void getSpaceClasses(ULONG dpSequence, ULONG count, UCHAR* classes)
+	{
+		Firebird::MutexLockGuard g(spaceMutex, FB_FUNCTION);
+
+		for (ULONG i = 0; i < count; i++)
+			classes[i] = spaceClass(dpSequence + i);
+	}
+
+	void setSpaceClass(ULONG dpSequence, UCHAR spaceClass)
+	{
+		fb_assert(spaceClass < SPACE_CLASSES);
+
+		Firebird::MutexLockGuard g(spaceMutex, FB_FUNCTION);
+
+		const ULONG pos = dpSequence / 2;
+		if (pos >= spaceMap.getCount())
+		{
+			if (!spaceClass)
+				return;
+
+			spaceMap.grow(pos + 1);
+		}
+
+		UCHAR& item = spaceMap[pos];
+		item = (dpSequence & 1) ? (item & 0x0F) | (spaceClass << 4) : (item & 0xF0) | spaceClass;
+	}
+
+	void clearSpaceMap()
+	{
+		Firebird::MutexLockGuard g(spaceMutex, FB_FUNCTION);
+		spaceMap.clear();
+	}
+
 private:
 	RelationPages*		rel_next_free;
 	std::atomic<SLONG>	useCount = 0;
@@ -437,6 +484,18 @@ private:
 	ULONG				dpMapMark;
 	Firebird::Mutex		dpMutex;
 
+	Firebird::Array<UCHAR>	spaceMap;
+	Firebird::Mutex		spaceMutex;
+
+	UCHAR spaceClass(ULONG dpSequence) const
+	{
+		const ULONG pos = dpSequence / 2;
+		if (pos >= spaceMap.getCount())
+			return 0;
+
+		return (dpSequence & 1) ? (spaceMap[pos] >> 4) : (spaceMap[pos] & 0x0F);
+	}
+
 friend class RelationPermanent;
 };
 
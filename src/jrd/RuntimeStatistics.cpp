@@ -27,6 +27,7 @@
 #include "../jrd/RuntimeStatistics.h"
 #include "../jrd/ntrace.h"
 #include "../jrd/met.h"
+#include "../common/utils_proto.h"
 
 using namespace Firebird;
 
@@ -69,6 +70,17 @@ void RuntimeStatistics::adjustPageStats(RuntimeStatistics& baseStats, const Runt
 		values[i] += delta;
 		baseStats.values[i] += delta;
 	}
+
+	// Wait times are propagated along with page counters,
+	// they're also measured mostly inside the page cache
+
+	for (size_t i = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS; i < GLOBAL_ITEMS; ++i)
+	{
+		const SINT64 delta = newStats.values[i] - baseStats.values[i];
+
+		values[i] += delta;
+		baseStats.values[i] += delta;
+	}
 }
 
 template <class Counts>
@@ -143,4 +155,34 @@ RuntimeStatistics::Accumulator::~Accumulator()
 		m_tdbb->bumpStats(m_type, m_id, m_counter);
 }
 
+RuntimeStatistics::Timer::Timer(thread_db* tdbb, const WaitStatType type)
+	: m_tdbb(tdbb), m_waitType(type), m_recordType(RecordStatType::TOTAL_ITEMS), m_id(0),
+	  m_start(fb_utils::query_performance_counter())
+{}
+
+RuntimeStatistics::Timer::Timer(thread_db* tdbb, const RecordStatType type, SLONG relationId)
+	: m_tdbb(tdbb), m_waitType(WaitStatType::TOTAL_ITEMS), m_recordType(type), m_id(relationId),
+	  m_start(fb_utils::query_performance_counter())
+{}
+
+RuntimeStatistics::Timer::~Timer()
+{
+	const SINT64 elapsed = toMicroseconds(fb_utils::query_performance_counter() - m_start);
+
+	if (elapsed <= 0)
+		return;
+
+	if (m_recordType != RecordStatType::TOTAL_ITEMS)
+		m_tdbb->bumpStats(m_recordType, m_id, elapsed);
+	else
+		m_tdbb->bumpStats(m_waitType, elapsed);
+}
+
+SINT64 RuntimeStatistics::toMicroseconds(SINT64 ticks)
+{
+	// Split the conversion to avoid overflow on long waits
+	const SINT64 frequency = fb_utils::query_performance_frequency();
+	return ticks / frequency * 1000000 + ticks % frequency * 1000000 / frequency;
+}
+
 } // namespace
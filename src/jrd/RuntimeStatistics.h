@@ -70,6 +70,21 @@ enum class RecordStatType
 	FRAGMENT_READS,
 	RPT_READS,
 	IMGC,
+	WAIT_TIME,		// time spent waiting for record lock holders
+	GC_TIME,		// time spent on garbage collection
+	INSERT_WAITS,	// data page latch conflicts while looking for space
+	TOTAL_ITEMS
+};
+
+// Time counters, measured in microseconds
+
+enum class WaitStatType
+{
+	LATCH_WAITS = 0,	// page buffer latch waits
+	LOCK_WAITS,			// lock manager waits
+	PAGE_READS,			// page reads from disk
+	PAGE_WRITES,		// page writes to disk
+	SORT_IO,			// sort runs I/O
 	TOTAL_ITEMS
 };
 
@@ -77,11 +92,13 @@ class RuntimeStatistics : protected Firebird::AutoStorage
 {
 	static constexpr size_t PAGE_TOTAL_ITEMS = static_cast<size_t>(PageStatType::TOTAL_ITEMS);
 	static constexpr size_t RECORD_TOTAL_ITEMS = static_cast<size_t>(RecordStatType::TOTAL_ITEMS);
+	static constexpr size_t WAIT_TOTAL_ITEMS = static_cast<size_t>(WaitStatType::TOTAL_ITEMS);
 
 public:
 	// Number of globally counted items.
 	//
-	// dimitr:	Currently, they include page-level and record-level counters.
+	// dimitr:	Currently, they include page-level and record-level counters
+	//			(plus wait time counters that are never grouped).
 	// 			However, this is not strictly required to maintain global record-level counters,
 	//			as they may be aggregated from the tableCounters array on demand. This would slow down
 	//			the retrieval of counters but save some CPU cycles inside tdbb->bumpStats().
@@ -90,7 +107,7 @@ public:
 	//			So far I leave everything as is but it can be reconsidered in the future.
 	//			sumValue() method is already in place for that purpose.
 	//
-	static constexpr size_t GLOBAL_ITEMS = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS;
+	static constexpr size_t GLOBAL_ITEMS = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + WAIT_TOTAL_ITEMS;
 
 private:
 	template <typename T> class CountsVector
@@ -396,6 +413,19 @@ public:
 		}
 	}
 
+	const SINT64& operator[](const WaitStatType type) const
+	{
+		const auto index = static_cast<size_t>(type);
+		return values[PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + index];
+	}
+
+	void bumpValue(const WaitStatType type, SINT64 delta)
+	{
+		++allChgNumber;
+		const auto index = static_cast<size_t>(type);
+		values[PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + index] += delta;
+	}
+
 	// Calculate difference between counts stored in this object and current
 	// counts of given request. Counts stored in object are destroyed.
 	void setToDiff(const RuntimeStatistics& newStats);
@@ -459,6 +489,28 @@ public:
 		SINT64 m_counter = 0;
 	};
 
+	// Adds the time spent inside its scope to the given time counter
+	class Timer
+	{
+	public:
+		Timer(thread_db* tdbb, const WaitStatType type);
+		Timer(thread_db* tdbb, const RecordStatType type, SLONG relationId);
+		~Timer();
+
+		Timer(const Timer&) = delete;
+		Timer& operator=(const Timer&) = delete;
+
+	private:
+		thread_db* const m_tdbb;
+		const WaitStatType m_waitType;
+		const RecordStatType m_recordType;
+		const SLONG m_id;
+		const SINT64 m_start;
+	};
+
+	// Converts performance counter ticks into microseconds
+	static SINT64 toMicroseconds(SINT64 ticks);
+
 	const PageCounters& getPageCounters() const
 	{
 		return pageCounters;
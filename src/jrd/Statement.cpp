@@ -75,6 +75,7 @@ Statement::Statement(thread_db* tdbb, MemoryPool* p, CompilerScratch* csb)
 	  fors(*p),
 	  localTables(*p),
 	  outerLocalTables(*p),
+	  sharedUnions(*p),
 	  invariants(*p),
 	  blr(*p),
 	  mapFieldInfo(*p),
@@ -127,6 +128,9 @@ Statement::Statement(thread_db* tdbb, MemoryPool* p, CompilerScratch* csb)
 			}
 		}
 
+		for (const auto& sharedUnion : csb->csb_shared_unions)
+			sharedUnions.add(sharedUnion.second.impure);
+
 		// make a vector of all invariant-type nodes, so that we will
 		// be able to easily reinitialize them when we restart the request
 		invariants.join(csb->csb_invariants);
@@ -808,13 +812,16 @@ void Statement::release(thread_db* tdbb)
 	}
 }
 
-// Returns a formatted textual plan for all RseNode's in the specified request
-string Statement::getPlan(thread_db* tdbb, bool detailed) const
+// Returns a formatted textual plan for all RseNode's in the specified request.
+// If the request is passed, the detailed plan also reports its actual row counts.
+string Statement::getPlan(thread_db* tdbb, bool detailed, const Request* request) const
 {
+	fb_assert(!request || request->getStatement() == this);
+
 	string plan;
 
 	for (const auto select : fors)
-		select->printPlan(tdbb, plan, detailed);
+		select->printPlan(tdbb, plan, detailed, request);
 
 	return plan;
 }
@@ -1058,6 +1065,29 @@ bool Request::isRoot() const
 	return this == statement->rootRequest();
 }
 
+// Quota of memory cached by temporary spaces (sorts, record buffers) of the request.
+// Routines and triggers called by the request share the quota of the top-level caller.
+TempCacheQuota* Request::getTempCacheQuota()
+{
+	Request* request = this;
+
+	while (request->req_caller)
+		request = request->req_caller;
+
+	if (!request->req_temp_cache_quota)
+	{
+		const auto attachment = request->req_attachment;
+		if (!attachment)
+			return nullptr;
+
+		request->req_temp_cache_quota = FB_NEW TempCacheQuota(
+			attachment->att_database->dbb_config->getStatementTempCacheLimit(),
+			attachment->getTempCacheQuota());
+	}
+
+	return request->req_temp_cache_quota;
+}
+
 Request* Request::getLocalTableRequest(bool outerDecl)
 {
 	Request* request = this;
@@ -1121,6 +1151,7 @@ Request::Request(Firebird::AutoMemoryPool& pool, Database* dbb, /*const*/ Statem
 	  req_blobs(*req_pool),
 	  req_stats(*req_pool),
 	  req_base_stats(*req_pool),
+	  req_executions(0),
 	  req_ext_stmt(NULL),
 	  req_cursors(*req_pool),
 	  req_ext_resultset(NULL),
@@ -44,6 +44,7 @@ public:
 	static const unsigned FLAG_INTERNAL		= 0x02;
 	static const unsigned FLAG_IGNORE_PERM	= 0x04;
 	//static const unsigned FLAG_VERSION4	= 0x08;
+	static const unsigned FLAG_SHARED		= 0x10;	// used by many attachments via the shared DSQL cache
 	static const unsigned FLAG_POWERFUL		= FLAG_SYS_TRIGGER | FLAG_INTERNAL | FLAG_IGNORE_PERM;
 
 	//static const unsigned MAP_LENGTH;		// CVC: Moved to dsql/Nodes.h as STREAM_MAP_LENGTH
@@ -105,7 +106,7 @@ public:
 	Request* verifyRequestSynchronization(USHORT level);
 	void release(thread_db* tdbb);
 
-	Firebird::string getPlan(thread_db* tdbb, bool detailed) const;
+	Firebird::string getPlan(thread_db* tdbb, bool detailed, const Request* request = nullptr) const;
 	void getPlan(thread_db* tdbb, PlanEntry& planEntry) const;
 
 	const Resources* getResources()
@@ -148,6 +149,7 @@ public:
 	Firebird::Array<const Select*> fors;	// select expressions
 	Firebird::Array<const DeclareLocalTableNode*> localTables;	// local tables
 	Firebird::Array<bool> outerLocalTables;	// local tables declared in an outer PSQL scope
+	Firebird::Array<ULONG> sharedUnions;	// impure offsets of shared union results
 	Firebird::Array<ULONG*> invariants;	// pointer to nodes invariant offsets
 	Firebird::RefStrPtr sqlText;		// SQL text (encoded in the metadata charset)
 	Firebird::Array<UCHAR> blr;			// BLR for non-SQL query
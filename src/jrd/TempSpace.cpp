@@ -79,6 +79,91 @@ namespace
 		Database* const m_dbb;
 		FB_SIZE_T m_size;
 	};
+
+	class TempCacheQuotaGuard
+	{
+	public:
+		explicit TempCacheQuotaGuard(TempCacheQuota* quota) noexcept :
+			m_quota(quota),
+			m_size(0)
+		{}
+
+		~TempCacheQuotaGuard()
+		{
+			if (m_size)
+				m_quota->deallocate(m_size);
+		}
+
+		bool reserve(FB_SIZE_T size) noexcept
+		{
+			if (!m_quota)
+				return true;
+
+			if (m_quota->allocate(size))
+			{
+				m_size = size;
+				return true;
+			}
+			return false;
+		}
+
+		void commit() noexcept
+		{
+			m_size = 0;
+		}
+
+	private:
+		TempCacheQuota* const m_quota;
+		FB_SIZE_T m_size;
+	};
+}
+
+//
+// Temporary cache quota class
+//
+
+bool TempCacheQuota::allocate(FB_UINT64 size) noexcept
+{
+	if (m_limit)
+	{
+		if (m_usage + size > m_limit)
+			return false;
+
+		const auto old = m_usage.fetch_add(size);
+		if (old + size > m_limit)
+		{
+			m_usage.fetch_sub(size);
+			return false;
+		}
+	}
+	else
+		m_usage.fetch_add(size);
+
+	if (m_parent && !m_parent->allocate(size))
+	{
+		m_usage.fetch_sub(size);
+		return false;
+	}
+
+	return true;
+}
+
+void TempCacheQuota::deallocate(FB_UINT64 size) noexcept
+{
+	fb_assert(m_usage >= size);
+
+	m_usage.fetch_sub(size);
+
+	if (m_parent)
+		m_parent->deallocate(size);
+}
+
+void TempCacheQuota::addSpill() noexcept
+{
+	++m_spills;
+
+	if (m_parent)
+		m_parent->addSpill();
 }
 
 //
@@ -200,8 +285,8 @@ TempSpace::Segment* TempSpace::FreeSegmentBySize::getSegment(FB_SIZE_T size)
 
 TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
 		: pool(p), filePrefix(p, prefix),
-		  logicalSize(0), physicalSize(0), localCacheUsage(0),
-		  head(NULL), tail(NULL), tempFiles(p),
+		  logicalSize(0), physicalSize(0), localCacheUsage(0), localCacheLimit(MAX_UINT64),
+		  spilled(false), head(NULL), tail(NULL), tempFiles(p),
 		  initialBuffer(p), initiallyDynamic(dynamic),
 		  freeSegments(p), freeSegmentsBySize(p)
 {
@@ -241,6 +326,9 @@ TempSpace::~TempSpace()
 	{
 		Database* const dbb = GET_DBB();
 		dbb->decTempCacheUsage(localCacheUsage);
+
+		if (cacheQuota)
+			cacheQuota->deallocate(localCacheUsage);
 	}
 
 	for (bool found = freeSegments.getFirst(); found; found = freeSegments.getNext())
@@ -398,8 +486,9 @@ void TempSpace::extend(FB_SIZE_T size)
 
 		{	// scope
 			TempCacheLimitGuard guard(GET_DBB());
+			TempCacheQuotaGuard quotaGuard(cacheQuota);
 
-			if (guard.reserve(size))
+			if (localCacheUsage + size <= localCacheLimit && quotaGuard.reserve(size) && guard.reserve(size))
 			{
 				try
 				{
@@ -407,6 +496,7 @@ void TempSpace::extend(FB_SIZE_T size)
 					block = FB_NEW_POOL(pool) MemoryBlock(FB_NEW_POOL(pool) UCHAR[size], tail, size);
 					localCacheUsage += size;
 					guard.commit();
+					quotaGuard.commit();
 				}
 				catch (const BadAlloc&)
 				{
@@ -421,6 +511,12 @@ void TempSpace::extend(FB_SIZE_T size)
 			// Possible error thrown when not enough physical memory
 			TempFile* const file = setupFile(size);
 			fb_assert(file);
+
+			if (cacheQuota && !spilled)
+			{
+				spilled = true;
+				cacheQuota->addSpill();
+			}
 			if (tail && tail->sameFile(file))
 			{
 				fb_assert(!initialSize);
@@ -665,6 +761,27 @@ UCHAR* TempSpace::inMemory(offset_t begin, size_t size) const
 	return block ? block->inMemory(begin, size) : NULL;
 }
 
+//
+// TempSpace::prefetch
+//
+// Ask the file blocks of the given range to be read ahead
+//
+
+void TempSpace::prefetch(offset_t offset, FB_SIZE_T length) const noexcept
+{
+	if (offset >= logicalSize)
+		return;
+
+	length = (FB_SIZE_T) MIN(length, logicalSize - offset);
+
+	for (const Block* block = findBlock(offset); block && length; block = block->next, offset = 0)
+	{
+		const FB_SIZE_T n = (FB_SIZE_T) MIN(length, block->size - offset);
+		block->prefetch(offset, n);
+		length -= n;
+	}
+}
+
 //
 // TempSpace::findMemory
 //
@@ -30,6 +30,46 @@
 #include "../common/config/dir_list.h"
 #include "../common/classes/init.h"
 #include "../common/classes/tree.h"
+#include "../common/classes/RefCounted.h"
+#include <atomic>
+
+// Memory budget shared by the temporary spaces of a statement or an attachment.
+// Quotas may be chained, the memory is granted only if it fits into every quota
+// up the chain, otherwise the temporary space spills its data to disk.
+
+class TempCacheQuota : public Firebird::RefCounted
+{
+public:
+	explicit TempCacheQuota(FB_UINT64 limit, TempCacheQuota* parent = nullptr) noexcept
+		: m_parent(parent), m_limit(limit), m_usage(0), m_spills(0)
+	{}
+
+	bool allocate(FB_UINT64 size) noexcept;
+	void deallocate(FB_UINT64 size) noexcept;
+	void addSpill() noexcept;
+
+	// Start counting spills of the next execution, parent quotas keep their counters
+	void resetSpills() noexcept
+	{
+		m_spills = 0;
+	}
+
+	FB_UINT64 getUsage() const noexcept
+	{
+		return m_usage;
+	}
+
+	FB_UINT64 getSpills() const noexcept
+	{
+		return m_spills;
+	}
+
+private:
+	const Firebird::RefPtr<TempCacheQuota> m_parent;
+	const FB_UINT64 m_limit;				// zero means unlimited
+	std::atomic<FB_UINT64> m_usage;		// memory granted to the temporary spaces
+	std::atomic<FB_UINT64> m_spills;	// number of temporary spaces spilled to disk
+};
 
 class TempSpace : public Firebird::File
 {
@@ -52,8 +92,30 @@ public:
 	offset_t allocateSpace(FB_SIZE_T size);
 	void releaseSpace(offset_t offset, FB_SIZE_T size);
 
+	// Limit memory cached by this space, the rest goes to temporary files
+	void setCacheLimit(FB_UINT64 limit) noexcept
+	{
+		localCacheLimit = limit;
+	}
+
+	// Charge memory cached by this space to the given quota
+	void setCacheQuota(TempCacheQuota* quota) noexcept
+	{
+		fb_assert(!localCacheUsage);
+		cacheQuota = quota;
+	}
+
 	UCHAR* inMemory(offset_t offset, size_t size) const;
 
+	// Whether the space has already grown into temporary files
+	bool isSpilled() const noexcept
+	{
+		return tempFiles.hasData();
+	}
+
+	// Start reading the given range from temporary files in background
+	void prefetch(offset_t offset, FB_SIZE_T length) const noexcept;
+
 	struct SegmentInMemory
 	{
 		UCHAR* memory;
@@ -90,6 +152,9 @@ private:
 		virtual UCHAR* inMemory(offset_t offset, size_t size) const noexcept = 0;
 		virtual bool sameFile(const Firebird::TempFile* file) const noexcept = 0;
 
+		virtual void prefetch(offset_t /*offset*/, FB_SIZE_T /*length*/) const noexcept
+		{}
+
 		Block *prev;
 		Block *next;
 		offset_t size;
@@ -168,6 +233,11 @@ private:
 			return (aFile == this->file);
 		}
 
+		void prefetch(offset_t offset, FB_SIZE_T length) const noexcept override
+		{
+			file->prefetch(seek + offset, length);
+		}
+
 	private:
 		Firebird::TempFile* file;
 		offset_t seek;
@@ -221,6 +291,9 @@ private:
 	offset_t logicalSize;
 	offset_t physicalSize;
 	offset_t localCacheUsage;
+	FB_UINT64 localCacheLimit;
+	Firebird::RefPtr<TempCacheQuota> cacheQuota;
+	bool spilled;
 	Block* head;
 	Block* tail;
 	Firebird::Array<Firebird::TempFile*> tempFiles;
@@ -269,5 +269,6 @@ static inline constexpr struct
 	{NULL, NULL},	// flags - part of header
 	{NULL, NULL},	// blr_within_group_order - part of blr_agg_list[_distinct] and blr_agg_function
 	{"invoke_agg_function", custom_agg_function},
+	{"union_shared", union_shared},
 	{0, 0}
 };
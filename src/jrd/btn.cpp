@@ -47,22 +47,7 @@ USHORT IndexNode::computePrefix(const UCHAR* prevString, USHORT prevLength,
  *  to two strings.
  *
  **************************************/
-	USHORT l = MIN(prevLength, length);
-	if (!l) {
-		return 0;
-	}
-
-	const UCHAR* p = prevString;
-
-	while (*p == *string)
-	{
-		++p;
-		++string;
-		if (!--l) {
-			break;
-		}
-	}
-	return (p - prevString);
+	return matchLength(prevString, string, MIN(prevLength, length));
 }
 
 
@@ -33,6 +33,11 @@
 #include "../jrd/ods.h"
 #include "../common/classes/array.h"
 
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BTN_USE_SSE2
+#endif
+
 namespace Jrd {
 
 // Flags (3-bits) used for index node
@@ -63,6 +68,40 @@ struct IndexNode
 	static USHORT computePrefix(const UCHAR* prevString, USHORT prevLength,
 								const UCHAR* string, USHORT length);
 
+	// Return the number of leading bytes two strings have in common,
+	// looking at no more than length bytes. Used by the in-page search
+	// to skip over the part of a node that matches the search key.
+	static USHORT matchLength(const UCHAR* string1, const UCHAR* string2, FB_SIZE_T length)
+	{
+		FB_SIZE_T n = 0;
+
+#ifdef BTN_USE_SSE2
+		for (; n + sizeof(__m128i) <= length; n += sizeof(__m128i))
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string1 + n));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string2 + n));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
+				break;
+		}
+#endif
+
+		for (; n + sizeof(FB_UINT64) <= length; n += sizeof(FB_UINT64))
+		{
+			FB_UINT64 a, b;
+			memcpy(&a, string1 + n, sizeof(a));
+			memcpy(&b, string2 + n, sizeof(b));
+
+			if (a != b)
+				break;
+		}
+
+		while (n < length && string1[n] == string2[n])
+			++n;
+
+		return (USHORT) n;
+	}
+
 	static SLONG findPageInDuplicates(const Ods::btree_page* page, UCHAR* pointer,
 									  SLONG previousNumber, RecordNumber findRecordNumber);
 
@@ -98,6 +98,10 @@ namespace
 	// of the main page.
 	inline constexpr ULONG NO_SPLIT = 0;
 
+	// Upper bound of the bytes IndexNode::readNode() may read before
+	// the node data, used to stay inside a page read without latching
+	constexpr ULONG MAX_NODE_HEADER = 16;
+
 	// Thresholds for determing of a page should be garbage collected
 	// Garbage collect if page size is below GARBAGE_COLLECTION_THRESHOLD
 #define GARBAGE_COLLECTION_BELOW_THRESHOLD	(dbb->dbb_page_size / 4)
@@ -237,14 +241,18 @@ static UCHAR* find_node_start_point(btree_page*, temporary_key*, UCHAR*, USHORT*
 									bool, int, bool = false, RecordNumber = NO_VALUE);
 
 static UCHAR* find_area_start_point(btree_page*, const temporary_key*, UCHAR*, USHORT*,
-									bool, int, RecordNumber = NO_VALUE);
+									bool, int, RecordNumber = NO_VALUE, ULONG = 0);
 
 static ULONG find_page(btree_page*, const temporary_key*, const index_desc*, RecordNumber = NO_VALUE,
-					   int = 0);
+					   int = 0, ULONG = 0);
+static btree_page* find_page_optimistic(thread_db*, const IndexRetrieval*, WIN*, index_desc*,
+										temporary_key*);
 
 static contents garbage_collect(thread_db*, WIN*, ULONG);
 static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
+static const temporary_key* get_descent_key(const IndexRetrieval*, const index_desc*,
+											 const temporary_key*, temporary_key*);
 
 static ULONG insert_node(thread_db*, WIN*, index_insertion*, temporary_key*,
 						 RecordNumber*, ULONG*, ULONG*);
@@ -259,6 +267,7 @@ static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
 				 const IndexRetrieval*, USHORT, temporary_key*,
 				 bool&, const temporary_key&, USHORT);
+static void skip_matching_bytes(const UCHAR*&, const UCHAR*, const UCHAR*&, const UCHAR*);
 static void update_selectivity(index_root_page*, MetaId, const SelectivityList&);
 static void checkForLowerKeySkip(bool&, const bool, const IndexNode&, const temporary_key&,
 								 const index_desc&, const IndexRetrieval*);
@@ -1718,6 +1727,25 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 }
 
 
+ULONG BTR_find_child(btree_page* bucket, const temporary_key* key, const index_desc* idx,
+					 ULONG checkSize)
+{
+/**************************************
+ *
+ *	B T R _ f i n d _ c h i l d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the number of the page the key descends to
+ *	from a non-leaf page. With checkSize not zero the
+ *	page may be inconsistent, END_LEVEL is returned then.
+ *
+ **************************************/
+	return find_page(bucket, key, idx, NO_VALUE, 0, checkSize);
+}
+
+
 UCHAR* BTR_find_leaf(btree_page* bucket, temporary_key* key, UCHAR* value,
 					 USHORT* return_value, bool descending, int retrieval)
 {
@@ -1760,6 +1788,12 @@ btree_page* BTR_find_page(thread_db* tdbb,
 	RelationPages* relPages = retrieval->getPermRelation()->getPages(tdbb);
 	fb_assert(window->win_page.getPageSpaceID() == relPages->rel_pg_space_id);
 
+	// Try to get to the leaf without latching the upper levels first
+
+	btree_page* page = find_page_optimistic(tdbb, retrieval, window, idx, lower);
+	if (page)
+		return page;
+
 	window->win_page = relPages->rel_index_root;
 	const index_root_page* rpage = BTR_fetch_root(FB_FUNCTION, tdbb, window);
 
@@ -1769,34 +1803,22 @@ btree_page* BTR_find_page(thread_db* tdbb,
 		IBERROR(260);	// msg 260 index unexpectedly deleted
 	}
 
-	btree_page* page = (btree_page*) CCH_HANDOFF(tdbb, window, idx->idx_root, LCK_read, pag_index);
+	page = (btree_page*) CCH_HANDOFF(tdbb, window, idx->idx_root, LCK_read, pag_index);
 
 	// If there is a starting descriptor, search down index to starting position.
 	// This may involve sibling buckets if splits are in progress.  If there
 	// isn't a starting descriptor, walk down the left side of the index (right
 	// side if we are going backwards).
-	// Ignore NULLs if flag is set and this is a 1 segment index,
-	// ASC index and no lower bound value is given.
-	const bool ignoreNulls = ((idx->idx_count == 1) && !(idx->idx_flags & idx_descending) &&
-		(retrieval->irb_generic & irb_ignore_null_value_key) && !(retrieval->irb_lower_count));
-
-	const bool firstData = (retrieval->irb_lower_count || ignoreNulls);
+	temporary_key firstNotNullKey;
+	const temporary_key* const key = get_descent_key(retrieval, idx, lower, &firstNotNullKey);
 
-	if (firstData)
+	if (key)
 	{
-		// Make a temporary key with length 1 and zero byte, this will return
-		// the first data value after the NULLs for an ASC index.
-		temporary_key firstNotNullKey;
-		firstNotNullKey.key_flags = 0;
-		firstNotNullKey.key_data[0] = 0;
-		firstNotNullKey.key_length = 1;
-
 		while (page->btr_level > 0)
 		{
 			while (true)
 			{
-				const temporary_key* tkey = ignoreNulls ? &firstNotNullKey : lower;
-				const ULONG number = find_page(page, tkey, idx,
+				const ULONG number = find_page(page, key, idx,
 					NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)));
 				if (number != END_BUCKET)
 				{
@@ -5307,6 +5329,8 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key, UCHA
 			const UCHAR* const nodeEnd = q + node.length;
 			if (descending)
 			{
+				skip_matching_bytes(p, key_end, q, nodeEnd);
+
 				while (true)
 				{
 					if (q == nodeEnd)
@@ -5334,6 +5358,8 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key, UCHA
 			else if (node.length > 0 || firstPass)
 			{
 				firstPass = false;
+				skip_matching_bytes(p, key_end, q, nodeEnd);
+
 				while (true)
 				{
 					if (p == key_end)
@@ -5381,7 +5407,8 @@ done:
 
 
 static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key, UCHAR* value, USHORT* return_prefix,
-									bool descending, int retrieval, RecordNumber find_record_number)
+									bool descending, int retrieval, RecordNumber find_record_number,
+									ULONG checkSize)
 {
 /**************************************
  *
@@ -5395,6 +5422,10 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
  *  defined with jump nodes. A jump node
  *  contains the prefix information for
  *  a node at a specific offset.
+ *	If checkSize is not zero, the page is read without
+ *	latch and may change under us. Jump nodes and nodes
+ *	they refer to are checked to stay within checkSize
+ *	bytes then, and NULL is returned if they don't.
  *
  **************************************/
 	const bool useFindRecordNumber = (find_record_number != NO_VALUE);
@@ -5402,13 +5433,21 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 	const UCHAR* keyPointer = key->key_data;
 	const UCHAR* const keyEnd = keyPointer + key->key_length;
 
+	fb_assert(!checkSize || !useFindRecordNumber);
+
 	// Retrieve jump information.
 	UCHAR* pointer = bucket->btr_nodes;
 	UCHAR n = bucket->btr_jump_count;
+	const USHORT jumpSize = bucket->btr_jump_size;
+	const UCHAR* const jumpEnd = pointer + jumpSize;
+	const UCHAR* const checkEnd = (UCHAR*) bucket + checkSize;
+
+	if (checkSize && BTR_SIZE + jumpSize + MAX_NODE_HEADER > checkSize)
+		return NULL;
 
 	// Set begin of page as default.
 	IndexJumpNode prevJumpNode;
-	prevJumpNode.offset = BTR_SIZE + bucket->btr_jump_size;
+	prevJumpNode.offset = BTR_SIZE + jumpSize;
 	prevJumpNode.prefix = 0;
 	prevJumpNode.length = 0;
 
@@ -5424,9 +5463,21 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 		IndexJumpNode jumpNode;
 		pointer = jumpNode.readJumpNode(pointer);
 
+		if (checkSize && (pointer > jumpEnd || jumpNode.offset + MAX_NODE_HEADER > checkSize ||
+				jumpNode.prefix + jumpNode.length > MAX_KEY))
+		{
+			return NULL;
+		}
+
 		IndexNode node;
 		node.readNode((UCHAR*) bucket + jumpNode.offset, leafPage);
 
+		if (checkSize && (node.prefix + node.length > MAX_KEY ||
+				(node.length && node.data + node.length > checkEnd)))
+		{
+			return NULL;
+		}
+
 		// jumpKey will hold complete data off referenced node
 		memcpy(jumpKey.key_data + jumpNode.prefix, jumpNode.data, jumpNode.length);
 		memcpy(jumpKey.key_data + node.prefix, node.data, node.length);
@@ -5439,6 +5490,8 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 
 		if ((jumpNode.prefix <= testPrefix) && descending)
 		{
+			skip_matching_bytes(keyPointer, keyEnd, q, nodeEnd);
+
 			while (true)
 			{
 				if (q == nodeEnd)
@@ -5518,6 +5571,8 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 		}
 		else if (jumpNode.prefix <= testPrefix)
 		{
+			skip_matching_bytes(keyPointer, keyEnd, q, nodeEnd);
+
 			while (true)
 			{
 				if (keyPointer == keyEnd)
@@ -5604,7 +5659,7 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 
 static ULONG find_page(btree_page* bucket, const temporary_key* key,
 					   const index_desc* idx, RecordNumber find_record_number,
-					   int retrieval)
+					   int retrieval, ULONG checkSize)
 {
 /**************************************
  *
@@ -5618,6 +5673,10 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
  *	Note that this routine can be called only for non-leaf
  *	pages, because it assumes the first node on page is
  *	a degenerate, zero-length node.
+ *	If checkSize is not zero, the page is read without latch
+ *	and may change under us. Nodes are not read beyond
+ *	checkSize bytes then, and END_LEVEL is returned instead
+ *	of a bugcheck if the page looks inconsistent.
  *
  **************************************/
 
@@ -5632,35 +5691,57 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 	if (validateDuplicates)
 		find_record_number = NO_VALUE;
 
-	const UCHAR* const endPointer = (UCHAR*) bucket + bucket->btr_length;
+	fb_assert(!checkSize || find_record_number == NO_VALUE);
+
+	const USHORT length = bucket->btr_length;
+	const UCHAR* const endPointer = (UCHAR*) bucket +
+		(checkSize ? MIN(length, checkSize - MAX_NODE_HEADER) : length);
+	UCHAR* const firstNode = bucket->btr_nodes + bucket->btr_jump_size;
 
 	USHORT prefix = 0;	// last computed prefix against processed node
 
 	// pointer where to start reading next node
 	UCHAR* pointer = find_area_start_point(bucket, key, nullptr, &prefix,
-										   descending, retrieval, find_record_number);
+										   descending, retrieval, find_record_number, checkSize);
+
+	if (!pointer || (checkSize && (pointer > endPointer || firstNode > endPointer)))
+		return END_LEVEL;
 
 	IndexNode node;
 	pointer = node.readNode(pointer, leafPage);
 	// Check if pointer is still valid
 	if (pointer > endPointer)
+	{
+		if (checkSize)
+			return END_LEVEL;
+
 		BUGCHECK(204);	// msg 204 index inconsistent
+	}
 
 	if (node.isEndBucket || node.isEndLevel)
 	{
-		pointer = bucket->btr_nodes + bucket->btr_jump_size;
-		pointer = node.readNode(pointer, leafPage);
+		pointer = node.readNode(firstNode, leafPage);
 
 		// Check if pointer is still valid
 		if (pointer > endPointer)
+		{
+			if (checkSize)
+				return END_LEVEL;
+
 			BUGCHECK(204);	// msg 204 index inconsistent
+		}
 	}
 
 	if (node.isEndLevel)
+	{
+		if (checkSize)
+			return END_LEVEL;
+
 		BUGCHECK(206);	// msg 206 exceeded index level
+	}
 
 	ULONG previousNumber = node.pageNumber;
-	if (node.nodePointer == bucket->btr_nodes + bucket->btr_jump_size)
+	if (node.nodePointer == firstNode)
 	{
 		prefix = 0;
 		// Handle degenerating node, always generated at first
@@ -5673,7 +5754,12 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 
 			// Check if pointer is still valid
 			if (pointer > endPointer)
+			{
+				if (checkSize)
+					return END_LEVEL;
+
 				BUGCHECK(204);	// msg 204 index inconsistent
+			}
 		}
 	}
 
@@ -5701,6 +5787,8 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 			if (descending)
 			{
 				// Descending indexes
+				skip_matching_bytes(p, keyEnd, q, nodeEnd);
+
 				while (true)
 				{
 					// Check for exact match and if we need to do
@@ -5730,6 +5818,8 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 			{
 				firstPass = false;
 				// Ascending index
+				skip_matching_bytes(p, keyEnd, q, nodeEnd);
+
 				while (true)
 				{
 					if (p == keyEnd)
@@ -5764,7 +5854,12 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 
 		// Check if pointer is still valid
 		if (pointer > endPointer)
+		{
+			if (checkSize)
+				return END_LEVEL;
+
 			BUGCHECK(204);	// msg 204 index inconsistent
+		}
 	}
 
 	// NOTREACHED
@@ -5772,6 +5867,134 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 }
 
 
+static btree_page* find_page_optimistic(thread_db* tdbb, const IndexRetrieval* retrieval, WIN* window,
+										index_desc* idx, temporary_key* lower)
+{
+/**************************************
+ *
+ *	f i n d _ p a g e _ o p t i m i s t i c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Descend to the leaf page as BTR_find_page does, but read
+ *	the index root page and the non-leaf pages without latching
+ *	them. Pages are searched in place in the page cache, only
+ *	the index root slot and the child page number are taken
+ *	from them, and the page is validated afterwards, so the
+ *	pointer we follow was current when it was read. Only the
+ *	leaf page is fetched and latched the usual way.
+ *	Return NULL if a page was not in cache or changed under us,
+ *	the caller should descend the regular way then.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	Cached::Relation* const relation = retrieval->getPermRelation();
+	RelationPages* const relPages = relation->getPages(tdbb);
+	const USHORT pageSpaceId = relPages->rel_pg_space_id;
+	const index_desc* const desc = &retrieval->irb_desc;
+
+	// Take the index root slot only, its key descriptions are known from the retrieval
+
+	OptimisticRead parent;
+	const index_root_page* const root = (const index_root_page*)
+		CCH_read_optimistic(tdbb, PageNumber(pageSpaceId, relPages->rel_index_root), pag_root, parent);
+
+	if (!root || retrieval->irb_index >= root->irt_count ||
+		offsetof(index_root_page, irt_rpt) + (retrieval->irb_index + 1) * sizeof(index_root_page::irt_repeat) >
+			dbb->dbb_page_size)
+	{
+		return NULL;
+	}
+
+	const index_root_page::irt_repeat slot = root->irt_rpt[retrieval->irb_index];
+
+	if (!CCH_validate_optimistic(parent) || slot.getState() != irt_normal || !slot.getRoot() ||
+		slot.irt_keys != desc->idx_count || slot.irt_flags != desc->idx_flags)
+	{
+		return NULL;
+	}
+
+	memcpy(idx, desc, sizeof(index_desc));
+	idx->idx_root = slot.getRoot();
+	idx->idx_state = irt_normal;
+
+	temporary_key firstNotNullKey;
+	const temporary_key* const key = get_descent_key(retrieval, idx, lower, &firstNotNullKey);
+
+	const UCHAR btrId = (UCHAR) (idx->idx_id % 256);
+	ULONG number = idx->idx_root;
+
+	while (true)
+	{
+		OptimisticRead current;
+		btree_page* const page = (btree_page*)
+			CCH_read_optimistic(tdbb, PageNumber(pageSpaceId, number), pag_index, current);
+
+		if (!page || !CCH_validate_optimistic(parent))
+			return NULL;
+
+		const USHORT relationId = page->btr_relation;
+		const UCHAR id = page->btr_id;
+		const UCHAR level = page->btr_level;
+
+		if (relationId != relation->getId() || id != btrId)
+			return NULL;
+
+		// The root itself is a leaf, latch it validating the index root page
+		if (level == 0)
+			break;
+
+		bool sibling = false;
+
+		if (key)
+		{
+			number = find_page(page, key, idx, NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)),
+				dbb->dbb_page_size);
+
+			if (number == END_BUCKET)
+			{
+				number = page->btr_sibling;
+				sibling = true;
+			}
+		}
+		else
+		{
+			IndexNode node;
+			const UCHAR* const endPointer = (UCHAR*) page + MIN(page->btr_length, dbb->dbb_page_size);
+			UCHAR* const pointer = page->btr_nodes + page->btr_jump_size;
+
+			if (pointer + MAX_NODE_HEADER > endPointer || node.readNode(pointer, false) > endPointer)
+				return NULL;
+
+			number = node.pageNumber;
+		}
+
+		// Whatever was read from the page is trusted only if it is still the same
+
+		if (!CCH_validate_optimistic(current) || number == END_LEVEL)
+			return NULL;
+
+		parent = current;
+
+		if (level == 1 && !sibling)
+			break;
+	}
+
+	window->win_page = PageNumber(pageSpaceId, number);
+	btree_page* const leaf = (btree_page*) CCH_FETCH(tdbb, window, LCK_read, pag_undefined);
+
+	if (!CCH_validate_optimistic(parent) || leaf->btr_header.pag_type != pag_index ||
+		leaf->btr_level != 0 || leaf->btr_relation != relation->getId() || leaf->btr_id != btrId)
+	{
+		CCH_RELEASE(tdbb, window);
+		return NULL;
+	}
+
+	return leaf;
+}
+
+
 static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_number)
 {
 /**************************************
@@ -6427,6 +6650,41 @@ static void generate_jump_nodes(thread_db* tdbb, btree_page* page,
 }
 
 
+static const temporary_key* get_descent_key(const IndexRetrieval* retrieval, const index_desc* idx,
+											 const temporary_key* lower, temporary_key* firstNotNullKey)
+{
+/**************************************
+ *
+ *	g e t _ d e s c e n t _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the key to search down the index to the starting
+ *	position of a retrieval, or NULL if the left side of the
+ *	index should be walked down instead.
+ *
+ **************************************/
+
+	// Ignore NULLs if flag is set and this is a 1 segment index,
+	// ASC index and no lower bound value is given.
+	const bool ignoreNulls = ((idx->idx_count == 1) && !(idx->idx_flags & idx_descending) &&
+		(retrieval->irb_generic & irb_ignore_null_value_key) && !(retrieval->irb_lower_count));
+
+	if (ignoreNulls)
+	{
+		// Make a temporary key with length 1 and zero byte, this will return
+		// the first data value after the NULLs for an ASC index.
+		firstNotNullKey->key_flags = 0;
+		firstNotNullKey->key_data[0] = 0;
+		firstNotNullKey->key_length = 1;
+		return firstNotNullKey;
+	}
+
+	return retrieval->irb_lower_count ? lower : NULL;
+}
+
+
 static ULONG insert_node(thread_db* tdbb,
 						 WIN* window,
 						 index_insertion* insertion,
@@ -7617,6 +7875,33 @@ static bool scan(thread_db* tdbb, UCHAR* pointer, RecordBitmap** bitmap, RecordB
 }
 
 
+static void skip_matching_bytes(const UCHAR*& key, const UCHAR* keyEnd,
+								const UCHAR*& data, const UCHAR* dataEnd)
+{
+/**************************************
+ *
+ *	s k i p _ m a t c h i n g _ b y t e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Advance both the key and the node data pointers
+ *	past the bytes they have in common, so the callers
+ *	only have to look at the first differing byte.
+ *	Short spans, typical for prefix compressed nodes,
+ *	are left to the callers' byte by byte loop.
+ *
+ **************************************/
+	const FB_SIZE_T length = MIN(keyEnd - key, dataEnd - data);
+
+	if (length >= sizeof(FB_UINT64))
+	{
+		const USHORT matched = IndexNode::matchLength(key, data, length);
+		key += matched;
+		data += matched;
+	}
+}
+
 void update_selectivity(index_root_page* root, MetaId id, const SelectivityList& selectivity)
 {
 /**************************************
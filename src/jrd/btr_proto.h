@@ -40,6 +40,7 @@ bool	BTR_description(Jrd::thread_db*, Jrd::Cached::Relation*, const Ods::index_r
 						MetaId, USHORT flags = 0);
 DSC*	BTR_eval_expression(Jrd::thread_db*, Jrd::index_desc*, Jrd::Record*);
 void	BTR_evaluate(Jrd::thread_db*, const Jrd::IndexRetrieval*, Jrd::RecordBitmap**, Jrd::RecordBitmap*);
+ULONG	BTR_find_child(Ods::btree_page*, const Jrd::temporary_key*, const Jrd::index_desc*, ULONG);
 UCHAR*	BTR_find_leaf(Ods::btree_page*, Jrd::temporary_key*, UCHAR*, USHORT*, bool, int);
 Ods::btree_page*	BTR_find_page(Jrd::thread_db*, const Jrd::IndexRetrieval*, Jrd::win*, Jrd::index_desc*,
 	Jrd::temporary_key*, Jrd::temporary_key*);
@@ -930,6 +930,7 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 
 	pag* page = bdb->bdb_buffer;
 	bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+	std::atomic_thread_fence(std::memory_order_release);
 
 	const ULONG pageSpaceId = bdb->bdb_page.getPageSpaceID();
 	tdbb->bumpStats(PageStatType::READS, pageSpaceId);
@@ -973,6 +974,8 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 			Database *dbb = tdbb->getDatabase();
 			int retryCount = 0;
 
+			RuntimeStatistics::Timer timer(tdbb, WaitStatType::PAGE_READS);
+
 			while (!PIO_read(tdbb, file, bdb, page, status))
 	 		{
 				if (isTempPage || !read_shadow)
@@ -1737,6 +1740,10 @@ void CCH_mark(thread_db* tdbb, WIN* window, bool mark_system, bool must_write)
 
 	bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
 
+	// Page contents must not change before optimistic readers
+	// (see CCH_read_optimistic) can see the new incarnation
+	std::atomic_thread_fence(std::memory_order_release);
+
 	// mark the dirty bit vector for this specific transaction,
 	// if it exists; otherwise mark that the system transaction
 	// has updated this page
@@ -2028,6 +2035,75 @@ bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
 }
 
 
+const pag* CCH_read_optimistic(thread_db* tdbb, PageNumber page, SCHAR page_type, OptimisticRead& token)
+{
+/**************************************
+ *
+ *	C C H _ r e a d _ o p t i m i s t i c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the cached image of a page without latching it.
+ *	Return NULL if the page is not in cache, is being changed
+ *	or read - the caller should fetch the page the regular
+ *	way then.
+ *
+ *	The page may be changed at any moment while the caller
+ *	reads it, so it must not trust anything it read before
+ *	the token is validated (CCH_validate_optimistic), and must
+ *	not follow offsets read from the page beyond its size.
+ *
+ *	The page buffer is versioned by bdb_incarnation which
+ *	is bumped before any change of its contents (page read,
+ *	CCH_mark), so this works in exclusive cache mode only,
+ *	where no other process may change the page.
+ *
+ *	The buffer is not moved in the LRU chain as it's not
+ *	latched and may be reused for other page meanwhile.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	if (!(bcb->bcb_flags & BCB_exclusive))
+		return NULL;
+
+	BufferDesc* bdb;
+	{
+#ifndef HASH_USE_CDS_LIST
+		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+		bdb = bcb->bcb_hashTable->find(page);
+	}
+
+	if (!bdb)
+		return NULL;
+
+	// Version must be read before the latch state, see CCH_validate_optimistic()
+
+	token.bdb = bdb;
+	token.page = page;
+	token.incarnation = bdb->bdb_incarnation.load(std::memory_order_acquire);
+
+	if (bdb->bdb_syncPage.getState() == SYNC_EXCLUSIVE || bdb->bdb_page != page ||
+		(bdb->bdb_flags & (BDB_read_pending | BDB_io_error | BDB_not_valid | BDB_free_pending)))
+	{
+		return NULL;
+	}
+
+	const pag* const buffer = bdb->bdb_buffer;
+
+	if (buffer->pag_type != page_type && page_type != pag_undefined)
+		return NULL;
+
+	tdbb->bumpStats(PageStatType::FETCHES, page.getPageSpaceID());
+
+	return buffer;
+}
+
+
 void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 {
 /**************************************
@@ -2432,6 +2508,29 @@ bool CCH_validate(WIN* window)
 }
 
 
+bool CCH_validate_optimistic(const OptimisticRead& token)
+{
+/**************************************
+ *
+ *	C C H _ v a l i d a t e _ o p t i m i s t i c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check that the page returned by CCH_read_optimistic was
+ *	not changed (nor is being changed) since then.
+ *
+ **************************************/
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	const BufferDesc* const bdb = token.bdb;
+
+	return bdb->bdb_incarnation.load(std::memory_order_relaxed) == token.incarnation &&
+		bdb->bdb_syncPage.getState() != SYNC_EXCLUSIVE &&
+		bdb->bdb_page == token.page;
+}
+
+
 bool CCH_write_all_shadows(thread_db* tdbb, Shadow* shadow, BufferDesc* bdb, Ods::pag* page,
 	FbStatusVector* status, const bool inAst)
 {
@@ -4997,6 +5096,8 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 					{
 						Database* dbb = tdbb->getDatabase();
 
+						RuntimeStatistics::Timer timer(tdbb, WaitStatType::PAGE_WRITES);
+
 						while (!PIO_write(tdbb, file, bdb, page, status))
 						{
 							if (isTempPage || !CCH_rollover_to_shadow(tdbb, dbb, file, inAst))
@@ -5189,10 +5290,18 @@ void BufferControl::destroy(BufferControl* bcb)
 
 bool BufferDesc::addRef(thread_db* tdbb, SyncType syncType, int wait)
 {
-	if (wait == 1)
-		bdb_syncPage.lock(NULL, syncType, FB_FUNCTION);
-	else if (!bdb_syncPage.lock(NULL, syncType, FB_FUNCTION, -wait * 1000))
-		return false;
+	// Try the fast path first (zero timeout means no wait)
+
+	if (!bdb_syncPage.lock(NULL, syncType, FB_FUNCTION, 0))
+	{
+		// The latch is busy, account the time we're going to wait for it
+		RuntimeStatistics::Timer timer(tdbb, WaitStatType::LATCH_WAITS);
+
+		if (wait == 1)
+			bdb_syncPage.lock(NULL, syncType, FB_FUNCTION);
+		else if (!bdb_syncPage.lock(NULL, syncType, FB_FUNCTION, -wait * 1000))
+			return false;
+	}
 
 	++bdb_use_count;
 
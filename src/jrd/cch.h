@@ -134,7 +134,7 @@ public:
 	ULONG		bcb_inuse;			// Number of buffers in use
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
-	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
+	std::atomic<ULONG>	bcb_page_incarnation;	// Cache page incarnation counter
 
 	Firebird::SyncObject	bcb_syncObject;
 	Firebird::SyncObject	bcb_syncDirtyBdbs;
@@ -247,7 +247,7 @@ public:
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
 	Ods::pag*	bdb_buffer;				// Actual buffer
 	PageNumber	bdb_page;				// Database page number in buffer
-	ULONG		bdb_incarnation;
+	std::atomic<ULONG>	bdb_incarnation;	// changed before every modification of buffer contents
 	ULONG		bdb_transactions;		// vector of dirty flags to reduce commit overhead
 	TraNumber	bdb_mark_transaction;	// hi-water mark transaction to defer header page I/O
 	que			bdb_lower;				// lower precedence que
@@ -269,6 +269,16 @@ public:
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
 };
 
+// OptimisticRead -- token of a page read from the cache without latching,
+// see CCH_read_optimistic() and CCH_validate_optimistic()
+
+struct OptimisticRead
+{
+	BufferDesc*	bdb;
+	PageNumber	page;
+	ULONG		incarnation;
+};
+
 // bdb_flags
 
 // to set/clear BDB_dirty use set_dirty_flag()/clear_dirty_flag()
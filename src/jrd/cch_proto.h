@@ -32,6 +32,10 @@ namespace Firebird {
 	class Sync;
 }
 
+namespace Jrd {
+	struct OptimisticRead;
+}
+
 enum LockState {
 	lsLatchTimeout = -2,	// was -2		*** now unused ***
 	lsLockTimeout,			// was -1
@@ -67,12 +71,14 @@ void		CCH_tra_precedence(Jrd::thread_db*, Jrd::win*, TraNumber traNum);
 void		CCH_prefetch(Jrd::thread_db*, SLONG*, SSHORT);
 bool		CCH_prefetch_pages(Jrd::thread_db*);
 #endif
+const Ods::pag*	CCH_read_optimistic(Jrd::thread_db*, Jrd::PageNumber, SCHAR, Jrd::OptimisticRead&);
 void		CCH_release(Jrd::thread_db*, Jrd::win*, const bool);
 void		CCH_release_exclusive(Jrd::thread_db*);
 bool		CCH_rollover_to_shadow(Jrd::thread_db* tdbb, Jrd::Database* dbb, Jrd::jrd_file*, const bool);
 void		CCH_shutdown(Jrd::thread_db*);
 void		CCH_unwind(Jrd::thread_db*, const bool);
 bool		CCH_validate(Jrd::win*);
+bool		CCH_validate_optimistic(const Jrd::OptimisticRead&);
 void		CCH_flush_ast(Jrd::thread_db*);
 bool		CCH_write_all_shadows(Jrd::thread_db*, Jrd::Shadow*, Jrd::BufferDesc*, Ods::pag*,
 					 Jrd::FbStatusVector*, const bool);
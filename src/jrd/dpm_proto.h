@@ -56,6 +56,7 @@ namespace Ods
 }
 
 Ods::pag* DPM_allocate(Jrd::thread_db*, Jrd::win*);
+bool	DPM_all_visible(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_backout(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_backout_mark(Jrd::thread_db*, Jrd::record_param*, const Jrd::jrd_tra*);
 double	DPM_cardinality(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::Format*);
@@ -68,7 +69,8 @@ USHORT	DPM_reserve_pages(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::win*);
 bool	DPM_fetch(Jrd::thread_db*, Jrd::record_param*, USHORT);
 bool	DPM_fetch_back(Jrd::thread_db*, Jrd::record_param*, USHORT, SSHORT);
 void	DPM_fetch_fragment(Jrd::thread_db*, Jrd::record_param*, USHORT);
-SINT64	DPM_gen_id(Jrd::thread_db*, SLONG, bool, SINT64);
+SINT64	DPM_gen_id(Jrd::thread_db*, SLONG, bool, SINT64, SLONG cache = 0);
+SINT64	DPM_gen_id_cached(Jrd::thread_db*, SLONG, SLONG, SLONG);
 bool	DPM_get(Jrd::thread_db*, Jrd::record_param*, SSHORT);
 ULONG	DPM_get_blob(Jrd::thread_db*, Jrd::blb*, Jrd::jrd_rel*, RecordNumber, bool, ULONG);
 void	DPM_mark_relation(Jrd::thread_db*, Jrd::Cached::Relation*);
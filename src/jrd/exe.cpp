@@ -896,6 +896,8 @@ void EXE_release(thread_db* tdbb, Request* request)
 		request->req_timer = nullptr;
 	}
 
+	request->req_temp_cache_quota = nullptr;
+
 	if (request->isUsed())
 		request->setUnused();
 }
@@ -1024,11 +1026,18 @@ static void activate_request(thread_db* tdbb, Request* request, jrd_tra* transac
 
 	request->req_records_affected.clear();
 
+	// runtime counters of record sources are reset lazily
+	request->req_executions++;
+
 	for (auto& rpb : request->req_rpb)
 		rpb.rpb_runtime_flags = 0;
 
 	request->req_profiler_ticks = 0;
 
+	// spills are reported per execution, memory still cached stays accounted
+	if (request->req_temp_cache_quota)
+		request->req_temp_cache_quota->resetSpills();
+
 	// Store request start time for timestamp work
 	request->validateTimeStamp();
 
@@ -1278,6 +1287,9 @@ void EXE_unwind(thread_db* tdbb, Request* request)
 		localTable->reset(tdbb, request);
 	}
 
+	for (const auto sharedImpure : statement->sharedUnions)
+		MaterializedStream::release(request, sharedImpure);
+
 	request->req_sorts.unlinkAll();
 
 	if (request->req_transaction)
@@ -477,6 +477,7 @@ public:
 		csb_dependencies(p),
 		csb_fors(p),
 		csb_localTables(p),
+		csb_shared_unions(p),
 		csb_invariants(p),
 		csb_current_nodes(p),
 		csb_current_for_nodes(p),
@@ -580,6 +581,14 @@ public:
 	Firebird::Array<Dependency>	csb_dependencies;	// objects that this statement depends upon
 	Firebird::Array<const Select*> csb_fors;	// select expressions
 	Firebird::Array<const DeclareLocalTableNode*> csb_localTables;	// local tables
+
+	struct SharedUnion
+	{
+		ULONG impure;					// offset of the shared result
+		const Format* format;			// format of the records kept there
+	};
+
+	Firebird::NonPooledMap<USHORT, SharedUnion> csb_shared_unions;	// shared unions by their id
 	Firebird::Array<ULONG*> csb_invariants;		// stack of pointer to nodes invariant offsets
 	Firebird::Array<ExprNode*> csb_current_nodes;	// RseNode's and other invariant
 												// candidates within whose scope we are
@@ -655,6 +664,7 @@ public:
 		const Format* csb_format;		// Default Format for stream
 		Format* csb_internal_format;	// Statement internal format
 		UInt32Bitmap* csb_fields;		// Fields referenced
+		ULONG csb_field_refs;			// Number of field (and record version) references
 		double csb_cardinality;			// Cardinality of relation
 		PlanNode* csb_plan;				// user-specified plan for this relation
 		StreamType* csb_map;			// Stream map for views
@@ -680,6 +690,7 @@ inline CompilerScratch::csb_repeat::csb_repeat() noexcept
 	  csb_format(0),
 	  csb_internal_format(0),
 	  csb_fields(0),
+	  csb_field_refs(0),
 	  csb_cardinality(0.0),	// TMN: Non-natural cardinality?!
 	  csb_plan(0),
 	  csb_map(0),
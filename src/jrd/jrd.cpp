@@ -7852,7 +7852,15 @@ void release_attachment(thread_db* tdbb, Jrd::Attachment* attachment, XThreadEns
 	{
 		auto* req = attachment->att_requests.back();
 		req->setUnused();
-		CMP_release(tdbb, req);
+
+		// Statement is used by other attachments, release just our request
+		if (req->getStatement()->flags & Statement::FLAG_SHARED)
+		{
+			attachment->att_requests.pop();
+			EXE_release(tdbb, req);
+		}
+		else
+			CMP_release(tdbb, req);
 	}
 
 	attachment->releaseLocks(tdbb);
@@ -8158,6 +8166,9 @@ bool JRD_shutdown_database(Database* dbb, const unsigned flags)
 
 	VIO_fini(tdbb);
 
+	// Release the DSQL statements shared by attachments
+	dbb->dbb_shared_statement_cache->purge(tdbb);
+
 	// Release the system requests
 	dbb->releaseSystemRequests(tdbb);
 
@@ -113,6 +113,12 @@ void LockManagerEngineCallbacks::checkoutRun(std::function<void()> func) const
 	func();
 }
 
+void LockManagerEngineCallbacks::waitCompleted(SINT64 ticks) const
+{
+	if (const auto elapsed = RuntimeStatistics::toMicroseconds(ticks))
+		tdbb->bumpStats(WaitStatType::LOCK_WAITS, elapsed);
+}
+
 
 // globals and macros
 
@@ -99,6 +99,7 @@ public:
 	ISC_STATUS getCancelState() const override;
 	ULONG adjustWait(ULONG wait) const override;
 	void checkoutRun(std::function<void()> func) const override;
+	void waitCompleted(SINT64 ticks) const override;
 
 private:
 	thread_db* const tdbb;
@@ -512,4 +512,16 @@ NAME("MON$FIELD_SUB_TYPE", nam_mon_f_sub_type)
 NAME("MON$CHAR_LENGTH", nam_mon_char_length)
 NAME("MON$COLLATION_ID", nam_mon_collate_id)
 
+NAME("MON$PAGE_READ_TIME", nam_mon_page_read_time)
+NAME("MON$PAGE_WRITE_TIME", nam_mon_page_write_time)
+NAME("MON$LATCH_WAIT_TIME", nam_mon_latch_wait_time)
+NAME("MON$LOCK_WAIT_TIME", nam_mon_lock_wait_time)
+NAME("MON$SORT_IO_TIME", nam_mon_sort_io_time)
+NAME("MON$RECORD_WAIT_TIME", nam_mon_rec_wait_time)
+NAME("MON$RECORD_GC_TIME", nam_mon_rec_gc_time)
+NAME("MON$RECORD_INSERT_WAITS", nam_mon_rec_insert_waits)
+NAME("MON$TEMP_CACHE_USED", nam_mon_temp_cache_used)
+NAME("MON$TEMP_CACHE_SPILLS", nam_mon_temp_cache_spills)
+
 NAME("RDB$AGGREGATE_FLAG", nam_aggregate_flag)
+NAME("RDB$GENERATOR_CACHE", nam_gen_cache)
@@ -386,6 +386,8 @@ inline constexpr UCHAR dpg_large		= 0x04;		// Large object is on page
 inline constexpr UCHAR dpg_swept		= 0x08;		// Sweep has nothing to do on this page
 inline constexpr UCHAR dpg_secondary	= 0x10;		// Primary record versions not stored on this page
 													// Set in dpm.epp's extend_relation() but never tested.
+inline constexpr UCHAR dpg_all_visible	= 0x20;		// All record versions are visible to every transaction,
+													// meaningful only together with dpg_swept
 
 
 // Index root page
@@ -863,6 +865,7 @@ inline constexpr UCHAR ppg_dp_swept			= 0x04;		// Sweep has nothing to do on dat
 inline constexpr UCHAR ppg_dp_secondary		= 0x08;		// Primary record versions not stored on data page
 inline constexpr UCHAR ppg_dp_empty			= 0x10;		// Data page is empty
 inline constexpr UCHAR ppg_dp_reserved		= 0x20;		// Slot is reserved for bulk insert
+inline constexpr UCHAR ppg_dp_all_visible	= 0x40;		// All record versions on data page are visible to everyone
 
 inline constexpr UCHAR PPG_DP_ALL_BITS	= (1 << PPG_DP_BITS_NUM) - 1;
 
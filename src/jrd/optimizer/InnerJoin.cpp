@@ -227,15 +227,24 @@ void InnerJoin::estimateCost(unsigned position,
 		//  - probing the hash table and copying the matched rows
 
 		const auto hashCardinality = stream->baseSelectivity * streamCardinality;
-		const auto hashCost = stream->baseCost +
+		const auto buildCost = stream->baseCost +
 			// hashing cost
-			hashCardinality * (COST_FACTOR_MEMCOPY + COST_FACTOR_HASHING) +
+			hashCardinality * (COST_FACTOR_MEMCOPY + COST_FACTOR_HASHING);
+		const auto probeCost =
 			// probing + copying cost
-			cardinality * (COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY);
+			COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY;
+		const auto hashCost = buildCost + cardinality * probeCost;
 
-		if (hashCost <= loopCost && hashCardinality <= HashJoin::maxCapacity())
+		// The nested loop join is preferred but it could be worth switching to hash join
+		// at runtime if the prior streams produce many more rows than estimated.
+		// The switch pays off after so many rows that the nested loop join has spent
+		// as much as building the hash table costs.
+		const bool fallback = (hashCost > loopCost && candidate->cost > probeCost);
+
+		if ((hashCost <= loopCost || fallback) && hashCardinality <= HashJoin::maxCapacity())
 		{
-			auto& equiMatches = joinedStreams[position].equiMatches;
+			auto& equiMatches = fallback ?
+				joinedStreams[position].fallbackMatches : joinedStreams[position].equiMatches;
 			fb_assert(!equiMatches.hasData());
 
 			// Scan the matches for possible equi-join conditions
@@ -265,8 +274,15 @@ void InnerJoin::estimateCost(unsigned position,
 				}
 			}
 
+			if (fallback)
+			{
+				const auto breakEven = buildCost / (candidate->cost - probeCost);
+
+				joinedStreams[position].switchCardinality =
+					MAX(breakEven, cardinality * ADAPTIVE_JOIN_FACTOR);
+			}
 			// Adjust the actual cost value, if hash joining is both possible and preferrable
-			if (equiMatches.hasData())
+			else if (equiMatches.hasData())
 				cost = hashCost;
 		}
 	}
@@ -587,6 +603,99 @@ River* InnerJoin::formRiver()
 			// Clear priorly processed rsb's, as they're already incorporated into a hash join
 			rsbs.clear();
 		}
+		else if (rsbs.hasData() && // this is not the first stream
+			stream.fallbackMatches.hasData() &&
+			!optimizer->favorFirstRows())
+		{
+			fb_assert(streams.hasData());
+
+			// Both retrievals below must apply the local booleans of the stream,
+			// so restore the conjuncts state between them
+			HalfStaticArray<unsigned, OPT_STATIC_ITEMS> orgFlags, hashFlags;
+
+			for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter)
+				orgFlags.add(iter.getFlags());
+
+			RecordSource* hashRsb;
+
+			{	// scope
+				// Deactivate priorly joined streams
+				StreamStateHolder stateHolder(csb, streams);
+				stateHolder.deactivate();
+
+				// Create an independent retrieval to be hashed
+				hashRsb = optimizer->generateRetrieval(stream.number, nullptr, false, false);
+			}
+
+			unsigned pos = 0;
+			for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, ++pos)
+			{
+				hashFlags.add(iter.getFlags());
+				iter.setFlags(orgFlags[pos]);
+			}
+
+			// Create a dependent retrieval for the nested loop join
+			rsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false);
+
+			// Booleans checked by the dependent retrieval (the join conditions included)
+			// must be rechecked for the hash-joined records
+			BoolExprNode* fallbackBoolean = nullptr;
+
+			pos = 0;
+			for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, ++pos)
+			{
+				const auto flags = iter.getFlags();
+
+				if ((flags & Optimizer::CONJUNCT_USED) && !(hashFlags[pos] & Optimizer::CONJUNCT_USED))
+				{
+					fallbackBoolean = fallbackBoolean ? FB_NEW_POOL(getPool())
+						BinaryBoolNode(getPool(), blr_and, fallbackBoolean, iter) : *iter;
+				}
+
+				iter.setFlags(flags | hashFlags[pos]);
+			}
+
+			// Create a nested loop join from the priorly processed streams
+			const auto priorRsb = (rsbs.getCount() == 1) ? rsbs[0] :
+				FB_NEW_POOL(getPool()) NestedLoopJoin(csb, JoinType::INNER, rsbs.getCount(), rsbs.begin());
+
+			// Prepare the hash join to switch to, it shares the leading stream with the nested loop join
+			RecordSource* hashJoinRsbs[] = {priorRsb, hashRsb};
+
+			NestValueArray* keys[] = {
+				FB_NEW_POOL(getPool()) NestValueArray(getPool()),
+				FB_NEW_POOL(getPool()) NestValueArray(getPool())
+			};
+
+			for (const auto match : stream.fallbackMatches)
+			{
+				NestConst<ValueExprNode> node1;
+				NestConst<ValueExprNode> node2;
+
+				if (!optimizer->getEquiJoinKeys(match, &node1, &node2))
+					fb_assert(false);
+
+				if (!node2->containsStream(stream.number))
+				{
+					fb_assert(node1->containsStream(stream.number));
+
+					// Swap the sides
+					std::swap(node1, node2);
+				}
+
+				keys[0]->add(node1);
+				keys[1]->add(node2);
+			}
+
+			const auto hashJoin = FB_NEW_POOL(getPool())
+				HashJoin(tdbb, csb, JoinType::INNER, 2, hashJoinRsbs, keys, stream.selectivity);
+
+			rsb = FB_NEW_POOL(getPool())
+				NestedLoopJoin(csb, priorRsb, rsb, hashJoin, fallbackBoolean, stream.switchCardinality);
+
+			// Clear priorly processed rsb's, as they're already incorporated into the join
+			rsbs.clear();
+		}
 		else
 		{
 			rsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false);
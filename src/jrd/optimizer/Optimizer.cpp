@@ -578,6 +578,111 @@ namespace
 		}
 	}
 
+	// Check whether the inversion consists of full key equality lookups only,
+	// using the key types which represent values exactly
+
+	bool checkIndexOnlyInversion(const InversionNode* inversion)
+	{
+		switch (inversion->type)
+		{
+			case InversionNode::TYPE_AND:
+				return checkIndexOnlyInversion(inversion->node1) &&
+					checkIndexOnlyInversion(inversion->node2);
+
+			case InversionNode::TYPE_INDEX:
+			{
+				const auto retrieval = inversion->retrieval;
+				const auto& idx = retrieval->irb_desc;
+
+				if ((idx.idx_flags & (idx_expression | idx_condition)) ||
+					!(retrieval->irb_generic & irb_equality) ||
+					(retrieval->irb_generic & (irb_partial | irb_starting)) ||
+					retrieval->irb_list ||
+					retrieval->irb_lower_count != idx.idx_count ||
+					retrieval->irb_upper_count != idx.idx_count)
+				{
+					return false;
+				}
+
+				for (USHORT i = 0; i < idx.idx_count; i++)
+				{
+					switch (idx.idx_rpt[i].idx_itype)
+					{
+						case idx_numeric:
+						case idx_numeric2:
+						case idx_sql_date:
+						case idx_sql_time:
+						case idx_timestamp:
+						case idx_boolean:
+							break;
+
+						default:
+							return false;
+					}
+				}
+
+				return true;
+			}
+
+			default:
+				return false;
+		}
+	}
+
+	// Check whether the boolean is an equality between the stream field and a value
+	// of the same data type, thus index lookup finds exactly the same records as the
+	// boolean itself would accept. Return the field ID or -1 otherwise.
+
+	int getIndexOnlyField(thread_db* tdbb, CompilerScratch* csb,
+						  StreamType stream, BoolExprNode* boolean)
+	{
+		const auto cmpNode = nodeAs<ComparativeBoolNode>(boolean);
+
+		if (!cmpNode || cmpNode->blrOp != blr_eql)
+			return -1;
+
+		auto fieldNode = nodeAs<FieldNode>(cmpNode->arg1);
+		ValueExprNode* value = cmpNode->arg2;
+
+		if (!fieldNode || fieldNode->fieldStream != stream)
+		{
+			fieldNode = nodeAs<FieldNode>(cmpNode->arg2);
+			value = cmpNode->arg1;
+		}
+
+		if (!fieldNode || fieldNode->fieldStream != stream || value->containsStream(stream))
+			return -1;
+
+		dsc fieldDesc, valueDesc;
+		fieldNode->getDesc(tdbb, csb, &fieldDesc);
+		value->getDesc(tdbb, csb, &valueDesc);
+
+		switch (fieldDesc.dsc_dtype)
+		{
+			case dtype_short:
+			case dtype_long:
+			case dtype_int64:
+				if ((valueDesc.dsc_dtype == dtype_short ||
+					 valueDesc.dsc_dtype == dtype_long ||
+					 valueDesc.dsc_dtype == dtype_int64) &&
+					valueDesc.dsc_scale == fieldDesc.dsc_scale)
+				{
+					return fieldNode->fieldId;
+				}
+				break;
+
+			case dtype_sql_date:
+			case dtype_sql_time:
+			case dtype_timestamp:
+			case dtype_boolean:
+				if (valueDesc.dsc_dtype == fieldDesc.dsc_dtype)
+					return fieldNode->fieldId;
+				break;
+		}
+
+		return -1;
+	}
+
 } // namespace
 
 
@@ -1139,6 +1244,8 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 	checkIndices();
 
+	SortedStream* sortRsb = nullptr;
+
 	if (project || sort)
 	{
 		// Eliminate any duplicate dbkey streams
@@ -1155,7 +1262,7 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 		// Handle sort clause if present
 		if (sort)
-			rsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+			rsb = sortRsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
 	}
 
 	// Add invariant booleans, if any. They should be evaluated before
@@ -1173,7 +1280,21 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		rsb = FB_NEW_POOL(getPool()) SkipRowsStream(csb, rsb, rse->rse_skip);
 
 	if (rse->rse_first)
+	{
+		// Let the sort keep only the rows to be returned. Limits are evaluated
+		// once again when the sort is opened, so they must not change meanwhile.
+
+		const auto isStable = [](const ValueExprNode* node)
+		{
+			return !node || nodeIs<LiteralNode>(node) || nodeIs<ParameterNode>(node) ||
+				nodeIs<VariableNode>(node);
+		};
+
+		if (sortRsb && isStable(rse->rse_first) && isStable(rse->rse_skip))
+			sortRsb->setLimit(rse->rse_first, rse->rse_skip);
+
 		rsb = FB_NEW_POOL(getPool()) FirstRowsStream(csb, rsb, rse->rse_first);
+	}
 
 	if (rse->isSingular())
 		rsb = FB_NEW_POOL(getPool()) SingularStream(csb, rsb);
@@ -3163,7 +3284,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 	// booleans.  When one is found, roll it into a final boolean and mark
 	// it used. If a computable boolean didn't match against an index then
 	// mark the stream to denote unmatched booleans.
-	BooleanList filters;
+	BooleanList filters, streamBooleans;
 	BoolExprNode* boolean = nullptr;
 
 	for (auto iter = getConjuncts(outerFlag, innerFlag); iter.hasData(); ++iter)
@@ -3182,6 +3303,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 			{
 				compose(getPool(), &boolean, iter);
 				iter |= CONJUNCT_USED;
+				streamBooleans.add(*iter);
 
 				if (!(iter & CONJUNCT_MATCHED))
 				{
@@ -3211,6 +3333,14 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 
 			rsb = FB_NEW_POOL(getPool()) ConditionalStream(csb, rsb1, rsb2, condition);
 		}
+		else if (inversion && boolean && !outerFlag && !innerFlag &&
+			checkIndexOnly(stream, inversion, streamBooleans))
+		{
+			// The booleans are evaluated by the scan itself and only
+			// for records which visibility had to be checked
+			return FB_NEW_POOL(getPool()) BitmapTableScan(csb, alias, stream, relation,
+				inversion, scanSelectivity * filterSelectivity, boolean);
+		}
 		else if (inversion)
 		{
 			rsb = FB_NEW_POOL(getPool()) BitmapTableScan(csb, alias, stream, relation,
@@ -3229,6 +3359,57 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 }
 
 
+//
+// Check whether the stream retrieved using the given inversion could skip fetching
+// the records from the data pages marked as all-visible. It's possible if there
+// are no references to the stream fields except the booleans matched to the index.
+// Only full key equality lookups on exact key types qualify, as just for them
+// the index match itself proves the boolean. Ranges, STARTING WITH, IN lists,
+// expression and partial indices still fetch every record.
+//
+
+bool Optimizer::checkIndexOnly(StreamType stream,
+							   const InversionNode* inversion,
+							   const BooleanList& booleans)
+{
+	const auto tail = &csb->csb_rpt[stream];
+	const auto relation = tail->csb_relation;
+
+	if (!relation || relation()->isTemporary() || rse->hasWriteLock() ||
+		(tail->csb_flags & (csb_update | csb_unstable | csb_skip_locked)))
+	{
+		return false;
+	}
+
+	if (!checkIndexOnlyInversion(inversion))
+		return false;
+
+	// Every conjunct referring the stream must be evaluated by this retrieval
+
+	for (auto iter = getConjuncts(); iter.hasData(); ++iter)
+	{
+		if (iter->containsStream(stream) && !booleans.exist(*iter))
+			return false;
+	}
+
+	SortedArray<int> fields;
+
+	for (const auto boolean : booleans)
+	{
+		const int fieldId = getIndexOnlyField(tdbb, csb, stream, boolean);
+
+		if (fieldId < 0 || fields.exist(fieldId))
+			return false;
+
+		fields.add(fieldId);
+	}
+
+	// Every field reference must belong to the matched booleans
+
+	return (tail->csb_field_refs == booleans.getCount());
+}
+
+
 //
 // Compose a filter including all computable booleans
 //
@@ -69,6 +69,11 @@ inline constexpr double MINIMUM_CARDINALITY = 1.0;
 inline constexpr double THRESHOLD_CARDINALITY = 5.0;
 inline constexpr double DEFAULT_CARDINALITY = 1000.0;
 
+// Nested loop join switches to hash join at runtime if the outer stream
+// has produced this times more rows than estimated (and more than the
+// break-even number of rows between the two join methods)
+inline constexpr double ADAPTIVE_JOIN_FACTOR = 10.0;
+
 // Default depth of an index tree (including one leaf page),
 // also representing the minimal cost of the index scan.
 // We assume that the root page would be always cached,
@@ -334,6 +339,11 @@ public:
 			return iter->flags;
 		}
 
+		void setFlags(unsigned flags) noexcept
+		{
+			iter->flags = flags;
+		}
+
 		void rewind() noexcept
 		{
 			iter = begin;
@@ -385,9 +395,10 @@ public:
 		return ConjunctIterator(begin, end);
 	}
 
-	static Firebird::string getPlan(thread_db* tdbb, const Statement* statement, bool detailed)
+	static Firebird::string getPlan(thread_db* tdbb, const Statement* statement, bool detailed,
+		const Request* request = nullptr)
 	{
-		return statement ? statement->getPlan(tdbb, detailed) : "";
+		return statement ? statement->getPlan(tdbb, detailed, request) : "";
 	}
 
 	static double getSelectivity(const BoolExprNode* node)
@@ -607,6 +618,7 @@ private:
 					RiverList& rivers,
 					SortNode** sortClause,
 					const PlanNode* planClause);
+	bool checkIndexOnly(StreamType stream, const InversionNode* inversion, const BooleanList& booleans);
 	bool generateEquiJoin(RiverList& rivers, JoinType joinType);
 	void generateInnerJoin(const StreamList& streams,
 						   RiverList& rivers,
@@ -938,11 +950,17 @@ class InnerJoin final : private Firebird::PermanentStorage
 			number = num;
 			selectivity = 0.0;
 			equiMatches.clear();
+			fallbackMatches.clear();
+			switchCardinality = 0.0;
 		}
 
 		StreamType number;			// stream in position of join order
 		double selectivity = 0.0;	// position selectivity
 		Firebird::Vector<BoolExprNode*, MAX_EQUI_MATCHES> equiMatches;
+		// Equi-join conditions to hash join the stream with if the nested loop join
+		// has read more than switchCardinality rows from the prior streams
+		Firebird::Vector<BoolExprNode*, MAX_EQUI_MATCHES> fallbackMatches;
+		double switchCardinality = 0.0;
 	};
 
 	typedef Firebird::HalfStaticArray<JoinedStreamInfo, OPT_STATIC_ITEMS> JoinedStreamList;
@@ -1298,6 +1298,7 @@ RecordSourceNode* PAR_parseRecordSource(thread_db* tdbb, CompilerScratch* csb)
 			return LocalTableSourceNode::parse(tdbb, csb, blrOp, true);
 
 		case blr_union:
+		case blr_union_shared:
 		case blr_recurse:
 			return UnionSourceNode::parse(tdbb, csb, blrOp);
 
@@ -1640,6 +1641,7 @@ DmlNode* PAR_parse_node(thread_db* tdbb, CompilerScratch* csb)
 		case blr_relation3:
 		case blr_local_table_id:
 		case blr_union:
+		case blr_union_shared:
 		case blr_recurse:
 		case blr_window:
 		case blr_aggregate:
@@ -22,6 +22,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/req.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
@@ -37,9 +38,11 @@ using namespace Jrd;
 
 BitmapTableScan::BitmapTableScan(CompilerScratch* csb, const string& alias,
 								 StreamType stream, Rsc::Rel relation,
-								 InversionNode* inversion, double selectivity)
+								 InversionNode* inversion, double selectivity,
+								 BoolExprNode* recheck)
 	: RecordStream(csb, stream),
-	  m_alias(csb->csb_pool, alias), m_relation(relation), m_inversion(inversion)
+	  m_alias(csb->csb_pool, alias), m_relation(relation), m_inversion(inversion),
+	  m_recheck(recheck)
 {
 	fb_assert(m_inversion);
 
@@ -54,6 +57,8 @@ void BitmapTableScan::internalOpen(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 	impure->irsb_bitmap = EVL_bitmap(tdbb, m_inversion, NULL);
+	impure->irsb_visible_sequence = MAX_ULONG;
+	impure->irsb_all_visible = false;
 
 	record_param* const rpb = &request->req_rpb[m_stream];
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation(), false);
@@ -85,6 +90,7 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 {
 	JRD_reschedule(tdbb);
 
+	Database* const dbb = tdbb->getDatabase();
 	Request* const request = tdbb->getRequest();
 	record_param* const rpb = &request->req_rpb[m_stream];
 	Impure* const impure = request->getImpure<Impure>(m_impure);
@@ -110,6 +116,45 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 		{
 			rpb->rpb_number.setValue(bitmap->current());
 
+			if (m_recheck)
+			{
+				// Index-only retrieval. Records residing at the all-visible data pages
+				// are known to exist and to match the index key, so the data page itself
+				// is not fetched. Nobody is going to access the record data, just keep
+				// the record buffer valid (and NULL) for the upper level streams.
+
+				// Records come in ascending order, so the pointer page is looked at
+				// once per data page rather than for every record
+
+				const ULONG dpSequence = rpb->rpb_number.getValue() / dbb->dbb_max_records;
+
+				if (dpSequence != impure->irsb_visible_sequence)
+				{
+					impure->irsb_visible_sequence = dpSequence;
+					impure->irsb_all_visible = DPM_all_visible(tdbb, rpb);
+				}
+
+				if (impure->irsb_all_visible)
+				{
+					if (!rpb->rpb_record)
+						VIO_record(tdbb, rpb, rpb->rpb_relation->currentFormat(tdbb), request->req_pool);
+
+					rpb->rpb_record->fakeNulls();
+					rpb->rpb_number.setValid(true);
+					return true;
+				}
+
+				if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
+				{
+					rpb->rpb_number.setValid(true);
+
+					if (m_recheck->execute(tdbb, request).asBool())
+						return true;
+				}
+
+				continue;
+			}
+
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				rpb->rpb_number.setValid(true);
@@ -136,12 +181,21 @@ void BitmapTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned leve
 		plan += ")";
 }
 
+bool BitmapTableScan::isDependent(const StreamList& streams) const
+{
+	return m_recheck && m_recheck->containsAnyStream(streams);
+}
+
 void BitmapTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
 {
 	planEntry.className = "BitmapTableScan";
 
 	planEntry.lines.add().text = "Table " +
 		printName(tdbb, m_relation()->getName().toQuotedString(), m_alias) + " Access By ID";
+
+	if (m_recheck)
+		planEntry.lines.back().text += " (index only)";
+
 	printOptInfo(planEntry.lines);
 
 	printInversion(tdbb, m_inversion, planEntry.lines, true, 1, false);
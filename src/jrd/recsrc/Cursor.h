@@ -70,12 +70,17 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
-		void printPlan(thread_db* tdbb, Firebird::string& plan, bool detailed) const
+		void printPlan(thread_db* tdbb, Firebird::string& plan, bool detailed,
+			const Request* request = nullptr) const
 		{
 			if (detailed)
 			{
 				PlanEntry planEntry;
 				getPlan(tdbb, planEntry, 0, true);
+
+				if (request)
+					planEntry.setActualCounts(request);
+
 				planEntry.asString(plan);
 			}
 			else
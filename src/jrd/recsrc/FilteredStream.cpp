@@ -363,6 +363,12 @@ Firebird::TriState FilteredStream::evaluateBoolean(thread_db* tdbb) const
 
 		if (booleanState.asBool())
 		{
+			// Skip records the parent hash join is known to discard anyway.
+			// It's checked for accepted records only, the join reuses the
+			// key hash computed for that.
+			if (m_joinFilter && !m_joinFilter->checkFilter(tdbb, request))
+				continue;
+
 			result = true;
 			break;
 		}
@@ -48,6 +48,9 @@ FullOuterJoin::FullOuterJoin(CompilerScratch* csb,
 	m_impure = csb->allocImpure<Impure>();
 	m_cardinality = arg1->getCardinality() + arg2->getCardinality();
 
+	arg1->enableCounters(csb);
+	arg2->enableCounters(csb);
+
 	m_args.add(arg1);
 	m_args.add(arg2);
 }
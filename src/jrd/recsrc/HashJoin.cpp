@@ -43,7 +43,7 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
+// Minimal hash table size, larger tables are used for large inner streams
 static constexpr ULONG HASH_SIZE = 1009;
 static constexpr ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
 
@@ -56,6 +56,21 @@ unsigned HashJoin::maxCapacity() noexcept
 }
 
 
+// Hash table size for the given number of records of the largest inner stream
+static ULONG getTableSize(ULONG count)
+{
+	static constexpr ULONG TABLE_SIZES[] = {HASH_SIZE, 4093, 16381, 65521, 262139, 1048573};
+
+	for (const auto size : TABLE_SIZES)
+	{
+		if (count <= size * BUCKET_PREALLOCATE_SIZE)
+			return size;
+	}
+
+	return TABLE_SIZES[FB_NELEM(TABLE_SIZES) - 1];
+}
+
+
 class HashJoin::HashTable final : public PermanentStorage
 {
 	class CollisionList
@@ -104,6 +119,12 @@ class HashJoin::HashTable final : public PermanentStorage
 			m_collisions.add(Entry(hash, position));
 		}
 
+		void fill(BloomFilter& filter) const noexcept
+		{
+			for (const auto& collision : m_collisions)
+				filter.add(collision.hash);
+		}
+
 		bool locate(ULONG hash)
 		{
 			if (m_collisions.find(hash, m_iterator))
@@ -205,6 +226,17 @@ public:
 		return collisions->iterate(hash, position);
 	}
 
+	void fill(ULONG stream, BloomFilter& filter) const noexcept
+	{
+		fb_assert(stream < m_streamCount);
+
+		for (ULONG i = 0; i < m_tableSize; i++)
+		{
+			if (const auto collisions = m_collisions[stream * m_tableSize + i])
+				collisions->fill(filter);
+		}
+	}
+
 	void sort()
 	{
 		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
@@ -283,6 +315,7 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 	m_leader.totalKeyLength = 0;
 
 	m_cardinality = m_leader.source->getCardinality();
+	m_leader.source->enableCounters(csb);
 	m_args.add(m_leader.source);
 
 	for (FB_SIZE_T j = 0; j < leaderKeyCount; j++)
@@ -317,6 +350,9 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		if (m_joinType == JoinType::INNER || m_joinType == JoinType::OUTER)
 			m_cardinality *= subRsb->getCardinality();
 
+		// The buffer is read again for every match, so count the records it's filled with
+		subRsb->enableCounters(csb);
+
 		SubStream sub;
 		sub.buffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, subRsb);
 		sub.keys = keys[i];
@@ -359,6 +395,12 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 	}
 
 	m_cardinality *= selectivity;
+
+	// Leading records without a match are discarded by inner and semi joins,
+	// so they can be filtered out as early as inside the leading stream
+
+	if (m_joinType == JoinType::INNER || m_joinType == JoinType::SEMI)
+		m_pushFilter = m_leader.source->setJoinFilter(this);
 }
 
 void HashJoin::internalOpen(thread_db* tdbb) const
@@ -371,12 +413,42 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete impure->irsb_hash_table;
 	impure->irsb_hash_table = nullptr;
 
+	delete impure->irsb_bloom_filter;
+	impure->irsb_bloom_filter = nullptr;
+
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
+	impure->irsb_leader_hashed = false;
+
 	m_leader.source->open(tdbb);
 }
 
+// Start probing from the leading record already fetched by the nested loop join
+// this join is a fallback of. The leading stream is neither reopened nor repositioned.
+void HashJoin::resume(thread_db* tdbb) const
+{
+	fb_assert(m_fallback && m_joinType == JoinType::INNER);
+
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	countOpen(request);
+
+	impure->irsb_flags = irsb_open | irsb_mustread | irsb_resumed;
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = nullptr;
+
+	delete impure->irsb_bloom_filter;
+	impure->irsb_bloom_filter = nullptr;
+
+	delete[] impure->irsb_leader_buffer;
+	impure->irsb_leader_buffer = nullptr;
+
+	impure->irsb_leader_hashed = false;
+}
+
 void HashJoin::close(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
@@ -393,6 +465,9 @@ void HashJoin::close(thread_db* tdbb) const
 		delete impure->irsb_hash_table;
 		impure->irsb_hash_table = nullptr;
 
+		delete impure->irsb_bloom_filter;
+		impure->irsb_bloom_filter = nullptr;
+
 		delete[] impure->irsb_leader_buffer;
 		impure->irsb_leader_buffer = nullptr;
 	}
@@ -416,9 +491,15 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 		{
 			// Fetch the record from the leading stream
 
-			if (!m_leader.source->getRecord(tdbb))
+			if (impure->irsb_flags & irsb_resumed)
+				impure->irsb_flags &= ~irsb_resumed;
+			else if (!m_leader.source->getRecord(tdbb))
 				return false;
 
+			// The leading stream could have already hashed the keys while filtering
+			const bool hashed = impure->irsb_leader_hashed;
+			impure->irsb_leader_hashed = false;
+
 			if (m_boolean && m_boolean->execute(tdbb, request) != TriState(true))
 			{
 				// The boolean pertaining to the left sub-stream is false
@@ -434,15 +515,17 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 				auto& pool = *tdbb->getDefaultPool();
 				const auto argCount = m_subs.getCount();
 
-				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
 				impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
 
 				UCharBuffer buffer(pool);
+				HalfStaticArray<ULONG, OPT_STATIC_ITEMS> counts(pool, argCount);
+				Array<ULONG> hashes(pool);
+				ULONG maxCount = 0;
 
 				for (FB_SIZE_T i = 0; i < argCount; i++)
 				{
 					// Read and cache the inner streams. While doing that,
-					// hash the join condition values and populate hash tables.
+					// hash the join condition values.
 
 					m_subs[i].buffer->open(tdbb);
 
@@ -451,18 +534,41 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 
 					while (m_subs[i].buffer->getRecord(tdbb))
 					{
-						const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
+						hashes.add(computeHash(tdbb, request, m_subs[i], keyBuffer));
+						counter++;
 					}
+
+					counts.add(counter);
+					maxCount = MAX(maxCount, counter);
+				}
+
+				// The actual cardinality of the inner streams is known at this point,
+				// so size the hash table by it rather than by the estimation that
+				// could be wrong by orders of magnitude
+
+				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount, getTableSize(maxCount));
+
+				const ULONG* hash = hashes.begin();
+
+				for (FB_SIZE_T i = 0; i < argCount; i++)
+				{
+					for (ULONG position = 0; position < counts[i]; position++)
+						impure->irsb_hash_table->put(i, *hash++, position);
 				}
 
 				impure->irsb_hash_table->sort();
+
+				if (m_pushFilter)
+					buildFilter(tdbb, impure, counts.begin());
 			}
 
 			// Compute and hash the comparison keys
 
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			if (!hashed)
+			{
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			}
 
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
@@ -555,6 +661,20 @@ void HashJoin::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned l
 
 	printOptInfo(planEntry.lines);
 
+	// The leading stream is reported by the nested loop join this join is a fallback of
+	if (m_fallback)
+	{
+		if (recurse)
+		{
+			++level;
+
+			for (const auto& sub : m_subs)
+				sub.buffer->getPlan(tdbb, planEntry.children.add(), level, recurse);
+		}
+
+		return;
+	}
+
 	Join::internalGetPlan(tdbb, planEntry, level, recurse);
 }
 
@@ -637,6 +757,42 @@ ULONG HashJoin::computeHash(thread_db* tdbb,
 	return InternalHash::hash(sub.totalKeyLength, keyBuffer);
 }
 
+void HashJoin::buildFilter(thread_db* tdbb, Impure* impure, const ULONG* counts) const
+{
+	// A leading record must have a match in every inner stream,
+	// so it's enough to check it against the smallest one
+
+	FB_SIZE_T stream = 0;
+
+	for (FB_SIZE_T i = 1; i < m_subs.getCount(); i++)
+	{
+		if (counts[i] < counts[stream])
+			stream = i;
+	}
+
+	auto& pool = *tdbb->getDefaultPool();
+	impure->irsb_bloom_filter = FB_NEW_POOL(pool) BloomFilter(pool, counts[stream]);
+	impure->irsb_hash_table->fill(stream, *impure->irsb_bloom_filter);
+}
+
+bool HashJoin::checkFilter(thread_db* tdbb, Request* request) const
+{
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	// The filter becomes available after the first leading record
+	// has caused the hash table to be built
+
+	if (!impure->irsb_bloom_filter)
+		return true;
+
+	// Keep the hash of the accepted record to not compute it once again
+
+	impure->irsb_leader_hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+	impure->irsb_leader_hashed = impure->irsb_bloom_filter->check(impure->irsb_leader_hash);
+
+	return impure->irsb_leader_hashed;
+}
+
 bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const
 {
 	HashTable* const hashTable = impure->irsb_hash_table;
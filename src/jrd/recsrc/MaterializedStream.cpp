@@ -0,0 +1,217 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/cmp_proto.h"
+
+#include "RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+namespace
+{
+	bool sameLayout(const Format* format1, const Format* format2)
+	{
+		if (format1->fmt_length != format2->fmt_length || format1->fmt_count != format2->fmt_count)
+			return false;
+
+		for (USHORT i = 0; i < format1->fmt_count; i++)
+		{
+			if (!(format1->fmt_desc[i] == format2->fmt_desc[i]))
+				return false;
+		}
+
+		return true;
+	}
+}
+
+// ----------------------------------
+// Data access: shared (CTE) union
+// ----------------------------------
+
+MaterializedStream::MaterializedStream(CompilerScratch* csb, StreamType stream, RecordSource* next,
+		ULONG sharedImpure)
+	: RecordStream(csb, stream),
+	  m_next(next),
+	  m_sharedImpure(sharedImpure)
+{
+	fb_assert(m_next);
+
+	m_impure = csb->allocImpure<Impure>();
+	m_cardinality = next->getCardinality();
+}
+
+// Get the impure offset of the result shared by references with the given id.
+// All references must produce records of the same layout to share the result.
+std::optional<ULONG> MaterializedStream::getSharedImpure(CompilerScratch* csb, USHORT sharedId,
+	StreamType stream)
+{
+	const Format* const format = csb->csb_rpt[stream].csb_format;
+
+	if (const auto sharedUnion = csb->csb_shared_unions.get(sharedId))
+	{
+		if (!sameLayout(sharedUnion->format, format))
+			return std::nullopt;
+
+		return sharedUnion->impure;
+	}
+
+	CompilerScratch::SharedUnion sharedUnion;
+	sharedUnion.impure = csb->allocImpure<SharedImpure>();
+	sharedUnion.format = format;
+	csb->csb_shared_unions.put(sharedId, sharedUnion);
+
+	return sharedUnion.impure;
+}
+
+// Free the shared result when the request is unwound.
+void MaterializedStream::release(Request* request, ULONG sharedImpure)
+{
+	SharedImpure* const shared = request->getImpure<SharedImpure>(sharedImpure);
+
+	delete shared->buffer;
+	shared->buffer = NULL;
+	shared->filled = false;
+}
+
+void MaterializedStream::internalOpen(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+	SharedImpure* const shared = request->getImpure<SharedImpure>(m_sharedImpure);
+
+	// The result is collected once per request execution, one collected
+	// by a previous execution is stale
+
+	if (shared->filled && shared->execution != request->req_executions)
+		shared->filled = false;
+
+	impure->irsb_flags = irsb_open;
+	impure->irsb_position = 0;
+
+	if (shared->filled)
+		return;
+
+	if (shared->buffer)
+		shared->buffer->reset();
+	else
+	{
+		MemoryPool& pool = *request->req_pool;
+		shared->buffer = FB_NEW_POOL(pool) RecordBuffer(pool, m_format);
+	}
+
+	record_param* const rpb = &request->req_rpb[m_stream];
+
+	m_next->open(tdbb);
+
+	while (m_next->getRecord(tdbb))
+		shared->buffer->store(rpb->rpb_record);
+
+	m_next->close(tdbb);
+
+	shared->filled = true;
+	shared->execution = request->req_executions;
+}
+
+void MaterializedStream::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+
+	invalidateRecords(request);
+
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_flags & irsb_open)
+		impure->irsb_flags &= ~irsb_open;
+}
+
+bool MaterializedStream::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+	SharedImpure* const shared = request->getImpure<SharedImpure>(m_sharedImpure);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	if (!rpb->rpb_record)
+		rpb->rpb_record = FB_NEW_POOL(*tdbb->getDefaultPool()) Record(*tdbb->getDefaultPool(), m_format);
+
+	if (!shared->buffer->fetch(impure->irsb_position, rpb->rpb_record))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	impure->irsb_position++;
+	rpb->rpb_number.setValid(true);
+	return true;
+}
+
+bool MaterializedStream::refetchRecord(thread_db* /*tdbb*/) const
+{
+	return true;
+}
+
+WriteLockResult MaterializedStream::lockRecord(thread_db* /*tdbb*/) const
+{
+	status_exception::raise(Arg::Gds(isc_record_lock_not_supp));
+}
+
+void MaterializedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	m_next->getLegacyPlan(tdbb, plan, level);
+}
+
+void MaterializedStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "MaterializedStream";
+
+	string extras;
+	extras.printf(" (record length: %" ULONGFORMAT")", m_format->fmt_length);
+
+	planEntry.lines.add().text = "Shared Record Buffer" + extras;
+	printOptInfo(planEntry.lines);
+
+	if (recurse)
+		m_next->getPlan(tdbb, planEntry.children.add(), ++level, recurse);
+}
+
+void MaterializedStream::markRecursive()
+{
+	RecordStream::markRecursive();
+	m_next->markRecursive();
+}
+
+void MaterializedStream::invalidateRecords(Request* request) const
+{
+	RecordStream::invalidateRecords(request);
+	m_next->invalidateRecords(request);
+}
+
+bool MaterializedStream::isDependent(const StreamList& streams) const
+{
+	return m_next->isDependent(streams);
+}
@@ -47,6 +47,7 @@ MergeJoin::MergeJoin(CompilerScratch* csb, FB_SIZE_T count,
 
 	for (FB_SIZE_T i = 0; i < count; i++)
 	{
+		args[i]->enableCounters(csb);
 		m_args.add(args[i]);
 		m_cardinality *= args[i]->getCardinality() *
 			pow(REDUCE_SELECTIVITY_FACTOR_EQUALITY, keys[i]->getCount());
@@ -272,6 +273,7 @@ bool MergeJoin::internalGetRecord(thread_db* tdbb) const
 			{
 				MemoryPool& pool = *getDefaultMemoryPool();
 				mfb->mfb_space = FB_NEW_POOL(pool) TempSpace(pool, SCRATCH, false);
+				mfb->mfb_space->setCacheQuota(request->getTempCacheQuota());
 			}
 
 			Sort::writeBlock(mfb->mfb_space, mfb->mfb_block_size * mfb->mfb_current_block,
@@ -414,6 +416,7 @@ SLONG MergeJoin::getRecordByIndex(thread_db* tdbb, FB_SIZE_T index) const
 		{
 			MemoryPool& pool = *getDefaultMemoryPool();
 			mfb->mfb_space = FB_NEW_POOL(pool) TempSpace(pool, SCRATCH, false);
+			mfb->mfb_space->setCacheQuota(request->getTempCacheQuota());
 		}
 
 		Sort::writeBlock(mfb->mfb_space, mfb->mfb_block_size * mfb->mfb_current_block,
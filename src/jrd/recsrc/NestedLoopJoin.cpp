@@ -46,6 +46,7 @@ NestedLoopJoin::NestedLoopJoin(CompilerScratch* csb, JoinType joinType,
 
 	for (FB_SIZE_T i = 0; i < count; i++)
 	{
+		args[i]->enableCounters(csb);
 		m_args.add(args[i]);
 
 		if (i == 0 || joinType == JoinType::INNER)
@@ -67,16 +68,44 @@ NestedLoopJoin::NestedLoopJoin(CompilerScratch* csb,
 
 	m_cardinality = outer->getCardinality() * inner->getCardinality();
 
+	outer->enableCounters(csb);
+	inner->enableCounters(csb);
+
 	m_args.add(outer);
 	m_args.add(inner);
 }
 
+NestedLoopJoin::NestedLoopJoin(CompilerScratch* csb,
+							   RecordSource* outer, RecordSource* inner,
+							   HashJoin* fallback, BoolExprNode* fallbackBoolean,
+							   double switchCardinality)
+	: Join(csb, 2, JoinType::INNER),
+	  m_fallback(fallback),
+	  m_fallbackBoolean(fallbackBoolean),
+	  m_switchRecords(switchCardinality < (double) MAX_UINT64 ? (FB_UINT64) switchCardinality : MAX_UINT64)
+{
+	fb_assert(outer && inner && m_fallback);
+
+	m_impure = csb->allocImpure<Impure>();
+
+	m_cardinality = outer->getCardinality() * inner->getCardinality();
+
+	outer->enableCounters(csb);
+	inner->enableCounters(csb);
+
+	m_args.add(outer);
+	m_args.add(inner);
+
+	m_fallback->setFallback();
+}
+
 void NestedLoopJoin::internalOpen(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	impure->irsb_flags = irsb_open | irsb_first | irsb_mustread;
+	impure->irsb_outer_records = 0;
 }
 
 void NestedLoopJoin::close(thread_db* tdbb) const
@@ -92,9 +121,20 @@ void NestedLoopJoin::close(thread_db* tdbb) const
 		impure->irsb_flags &= ~irsb_open;
 
 		Join::close(tdbb);
+
+		if (m_fallback)
+			m_fallback->close(tdbb);
 	}
 }
 
+void NestedLoopJoin::markRecursive()
+{
+	Join::markRecursive();
+
+	if (m_fallback)
+		m_fallback->markRecursive();
+}
+
 bool NestedLoopJoin::internalGetRecord(thread_db* tdbb) const
 {
 	JRD_reschedule(tdbb);
@@ -105,6 +145,9 @@ bool NestedLoopJoin::internalGetRecord(thread_db* tdbb) const
 	if (!(impure->irsb_flags & irsb_open))
 		return false;
 
+	if (m_fallback)
+		return fetchAdaptive(tdbb, impure);
+
 	if (m_joinType == JoinType::INNER)
 	{
 		if (impure->irsb_flags & irsb_first)
@@ -255,9 +298,20 @@ void NestedLoopJoin::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsi
 	planEntry.className = "NestedLoopJoin";
 
 	planEntry.lines.add().text = "Nested Loop Join " + printType();
+
+	if (m_fallback)
+	{
+		string extras;
+		extras.printf(" (switching to hash join after %" UQUADFORMAT" outer records)", m_switchRecords);
+		planEntry.lines.back().text += extras;
+	}
+
 	printOptInfo(planEntry.lines);
 
 	Join::internalGetPlan(tdbb, planEntry, level, recurse);
+
+	if (m_fallback && recurse)
+		m_fallback->getPlan(tdbb, planEntry.children.add(), level + 1, recurse);
 }
 
 bool NestedLoopJoin::fetchRecord(thread_db* tdbb, FB_SIZE_T n) const
@@ -286,3 +340,59 @@ bool NestedLoopJoin::fetchRecord(thread_db* tdbb, FB_SIZE_T n) const
 			return true;
 	}
 }
+
+// Binary inner join that is switched to the hash join once the outer stream
+// turns out to return many more records than estimated. The hash join continues
+// from the current outer record, so no record is returned twice.
+bool NestedLoopJoin::fetchAdaptive(thread_db* tdbb, Impure* impure) const
+{
+	fb_assert(m_joinType == JoinType::INNER && m_args.getCount() == 2);
+
+	Request* const request = tdbb->getRequest();
+
+	const auto outer = m_args[0];
+	const auto inner = m_args[1];
+
+	if (impure->irsb_flags & irsb_first)
+	{
+		outer->open(tdbb);
+		impure->irsb_flags &= ~irsb_first;
+	}
+
+	while (true)
+	{
+		if (impure->irsb_flags & irsb_switched)
+		{
+			while (m_fallback->getRecord(tdbb))
+			{
+				if (!m_fallbackBoolean || m_fallbackBoolean->execute(tdbb, request) == TriState(true))
+					return true;
+			}
+
+			return false;
+		}
+
+		if (impure->irsb_flags & irsb_mustread)
+		{
+			if (!outer->getRecord(tdbb))
+				return false;
+
+			if (++impure->irsb_outer_records > m_switchRecords)
+			{
+				// The inner stream is closed at this point
+				m_fallback->resume(tdbb);
+				impure->irsb_flags |= irsb_switched;
+				continue;
+			}
+
+			inner->open(tdbb);
+			impure->irsb_flags &= ~irsb_mustread;
+		}
+
+		if (inner->getRecord(tdbb))
+			return true;
+
+		inner->close(tdbb);
+		impure->irsb_flags |= irsb_mustread;
+	}
+}
@@ -83,6 +83,18 @@ void PlanEntry::getDescriptionAsString(string& str, bool initialIndentation) con
 
 		str += line.text;
 
+		if (firstLine && actualRecords.has_value() && accessPath)
+		{
+			// Actual rows are averaged per open (loop), as the estimation is
+			const FB_UINT64 loops = actualOpens.value_or(0);
+			const FB_UINT64 rows = loops ? (actualRecords.value() + loops / 2) / loops : 0;
+
+			string actuals;
+			actuals.printf(" [estimated rows: %.0f, actual rows: %" UQUADFORMAT ", loops: %" UQUADFORMAT "]",
+				accessPath->getCardinality(), rows, loops);
+			str += actuals;
+		}
+
 		firstLine = false;
 	}
 }
@@ -102,6 +114,21 @@ void PlanEntry::asFlatList(Array<NonPooledPair<const PlanEntry*, const PlanEntry
 	}
 }
 
+// Attach the runtime counters collected by the given request to the plan tree
+void PlanEntry::setActualCounts(const Request* request)
+{
+	FB_UINT64 opens, records;
+
+	if (accessPath && accessPath->getActualCounts(request, opens, records))
+	{
+		actualOpens = opens;
+		actualRecords = records;
+	}
+
+	for (auto& child : children)
+		child.setActualCounts(request);
+}
+
 void PlanEntry::asString(string& str) const
 {
 	Array<NonPooledPair<const PlanEntry*, const PlanEntry*>> list;
@@ -125,6 +152,8 @@ void RecordSource::open(thread_db* tdbb) const
 	ProfilerManager::RecordSourceStopWatcher profilerRecordSourceStopWatcher(tdbb, this,
 		ProfilerManager::RecordSourceStopWatcher::Event::OPEN);
 
+	countOpen(tdbb->getRequest());
+
 	internalOpen(tdbb);
 }
 
@@ -133,7 +162,56 @@ bool RecordSource::getRecord(thread_db* tdbb) const
 	ProfilerManager::RecordSourceStopWatcher profilerRecordSourceStopWatcher(tdbb, this,
 		ProfilerManager::RecordSourceStopWatcher::Event::GET_RECORD);
 
-	return internalGetRecord(tdbb);
+	if (!internalGetRecord(tdbb))
+		return false;
+
+	if (m_counted)
+		tdbb->getRequest()->getImpure<Counters>(m_counters)->records++;
+
+	return true;
+}
+
+bool RecordSource::getActualCounts(const Request* request, FB_UINT64& opens, FB_UINT64& records) const
+{
+	if (!m_counted)
+		return false;
+
+	const Counters* const counters = request->getImpure<Counters>(m_counters);
+
+	// Nothing was opened yet during the current execution
+	if (counters->execution != request->req_executions)
+		return false;
+
+	opens = counters->opens;
+	records = counters->records;
+	return true;
+}
+
+void RecordSource::enableCounters(CompilerScratch* csb)
+{
+	if (!m_counted)
+	{
+		m_counters = csb->allocImpure<Counters>();
+		m_counted = true;
+	}
+}
+
+void RecordSource::countOpen(Request* request) const
+{
+	if (!m_counted)
+		return;
+
+	Counters* const counters = request->getImpure<Counters>(m_counters);
+
+	// Counters left from the previous execution are discarded
+	if (counters->execution != request->req_executions)
+	{
+		counters->execution = request->req_executions;
+		counters->opens = 0;
+		counters->records = 0;
+	}
+
+	counters->opens++;
 }
 
 string RecordSource::printName(thread_db* tdbb, const string& name, const string& alias)
@@ -25,6 +25,7 @@
 
 #include <optional>
 #include "../common/classes/array.h"
+#include "../common/classes/BloomFilter.h"
 #include "../common/classes/objects_array.h"
 #include "../common/classes/NestConst.h"
 #include "../jrd/RecordSourceNodes.h"
@@ -51,6 +52,7 @@ namespace Jrd
 	struct win;
 	class BaseBufferedStream;
 	class BufferedStream;
+	class HashJoin;
 	class PlanEntry;
 
 	enum class JoinType { INNER, OUTER, SEMI, ANTI };
@@ -82,6 +84,13 @@ namespace Jrd
 
 		virtual void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const = 0;
 
+		// Number of opens and fetched records during the current execution of the request
+		virtual bool getActualCounts(const Request* /*request*/,
+			FB_UINT64& /*opens*/, FB_UINT64& /*records*/) const
+		{
+			return false;
+		}
+
 	protected:
 		virtual void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry,
 			unsigned level, bool recurse) const = 0;
@@ -119,6 +128,7 @@ namespace Jrd
 		void getDescriptionAsString(Firebird::string& str, bool initialIndentation = false) const;
 		void asFlatList(Firebird::Array<Firebird::NonPooledPair<const PlanEntry*, const PlanEntry*>>& list) const;
 		void asString(Firebird::string& str) const;
+		void setActualCounts(const Request* request);
 
 	public:
 		Firebird::string className{getPool()};
@@ -131,6 +141,8 @@ namespace Jrd
 		ULONG recordLength = 0;
 		ULONG keyLength = 0;
 		unsigned level = 0;
+		std::optional<FB_UINT64> actualOpens;
+		std::optional<FB_UINT64> actualRecords;
 	};
 
 	// Abstract base class for record sources.
@@ -154,6 +166,13 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		// Let the hash join consuming this stream discard records without a match
+		// as early as possible, returns false if the stream cannot do that
+		virtual bool setJoinFilter(const HashJoin* /*join*/)
+		{
+			return false;
+		}
+
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
 		{
 			return true;
@@ -163,6 +182,12 @@ namespace Jrd
 
 		bool getRecord(thread_db* tdbb) const;
 
+		bool getActualCounts(const Request* request, FB_UINT64& opens, FB_UINT64& records) const override;
+
+		// Count opens and fetched records of this join input, to report them
+		// against its estimated cardinality. Other record sources don't count.
+		void enableCounters(CompilerScratch* csb);
+
 	protected:
 		// Generic impure block
 		struct Impure
@@ -170,11 +195,21 @@ namespace Jrd
 			ULONG irsb_flags;
 		};
 
+		// Runtime counters, compared against the estimated cardinality in explained plans
+		struct Counters
+		{
+			FB_UINT64 execution;	// value of req_executions the counters belong to
+			FB_UINT64 opens;
+			FB_UINT64 records;
+		};
+
 		static const ULONG irsb_open = 1;
 		static const ULONG irsb_first = 2;
 		static const ULONG irsb_joined = 4;
 		static const ULONG irsb_mustread = 8;
 		static const ULONG irsb_singular_processed = 16;
+		static const ULONG irsb_switched = 32;
+		static const ULONG irsb_resumed = 64;
 
 		RecordSource(CompilerScratch* csb);
 
@@ -192,10 +227,14 @@ namespace Jrd
 		static void saveRecord(thread_db* tdbb, record_param* rpb);
 		static void restoreRecord(thread_db* tdbb, record_param* rpb);
 
+		void countOpen(Request* request) const;
+
 		virtual void internalOpen(thread_db* tdbb) const = 0;
 		virtual bool internalGetRecord(thread_db* tdbb) const = 0;
 
 		ULONG m_impure = 0;
+		ULONG m_counters = 0;
+		bool m_counted = false;		// m_counters is allocated
 		bool m_recursive = false;
 	};
 
@@ -262,17 +301,22 @@ namespace Jrd
 		struct Impure : public RecordSource::Impure
 		{
 			RecordBitmap** irsb_bitmap;
+			ULONG irsb_visible_sequence;	// data page sequence the visibility was checked for
+			bool irsb_all_visible;			// is that data page all-visible
 		};
 
 	public:
 		BitmapTableScan(CompilerScratch* csb, const Firebird::string& alias,
 						StreamType stream, Rsc::Rel relation,
-						InversionNode* inversion, double selectivity);
+						InversionNode* inversion, double selectivity,
+						BoolExprNode* recheck = nullptr);
 
 		void close(thread_db* tdbb) const override;
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool isDependent(const StreamList& streams) const override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -282,6 +326,8 @@ namespace Jrd
 		const Firebird::string m_alias;
 		const Rsc::Rel m_relation;
 		NestConst<InversionNode> const m_inversion;
+		// Index-only mode: condition to be checked if the data page had to be fetched
+		NestConst<BoolExprNode> const m_recheck;
 	};
 
 	class IndexTableScan final : public RecordStream
@@ -610,6 +656,13 @@ namespace Jrd
 			m_ansiNot = ansiNot;
 		}
 
+		bool setJoinFilter(const HashJoin* join) override
+		{
+			fb_assert(!m_joinFilter);
+			m_joinFilter = join;
+			return true;
+		}
+
 	protected:
 		FilteredStream(CompilerScratch* csb, RecordSource* next, BoolExprNode* boolean);
 
@@ -625,6 +678,7 @@ namespace Jrd
 		NestConst<RecordSource> m_next;
 		NestConst<BoolExprNode> const m_boolean;
 		NestConst<BoolExprNode> m_anyBoolean;
+		const HashJoin* m_joinFilter = nullptr;
 		bool m_ansiAny = false;
 		bool m_ansiAll = false;
 		bool m_ansiNot = false;
@@ -737,6 +791,16 @@ namespace Jrd
 
 		bool compareKeys(const UCHAR* p, const UCHAR* q) const;
 
+		// Only first + skip rows are going to be read from the sort
+		void setLimit(ValueExprNode* first, ValueExprNode* skip)
+		{
+			m_first = first;
+			m_skip = skip;
+		}
+
+		// Number of rows to keep for the given FIRST and SKIP values, zero if unlimited
+		static FB_UINT64 getLimit(SINT64 first, SINT64 skip);
+
 		UCHAR* getData(thread_db* tdbb) const;
 		void mapData(thread_db* tdbb, Request* request, UCHAR* data) const;
 
@@ -760,9 +824,12 @@ namespace Jrd
 
 	private:
 		Sort* init(thread_db* tdbb) const;
+		FB_UINT64 getLimit(thread_db* tdbb) const;
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
+		NestConst<ValueExprNode> m_first;
+		NestConst<ValueExprNode> m_skip;
 	};
 
 	// Make moves in a window without going out of partition boundaries.
@@ -1305,15 +1372,24 @@ namespace Jrd
 
 	class NestedLoopJoin : public Join<RecordSource>
 	{
+		struct Impure : public RecordSource::Impure
+		{
+			FB_UINT64 irsb_outer_records;
+		};
+
 	public:
 		NestedLoopJoin(CompilerScratch* csb, JoinType joinType,
 					   FB_SIZE_T count, RecordSource* const* args);
 		NestedLoopJoin(CompilerScratch* csb, RecordSource* outer, RecordSource* inner,
 					   BoolExprNode* boolean);
+		NestedLoopJoin(CompilerScratch* csb, RecordSource* outer, RecordSource* inner,
+					   HashJoin* fallback, BoolExprNode* fallbackBoolean, double switchCardinality);
 
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		void markRecursive() override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1321,6 +1397,13 @@ namespace Jrd
 
 	private:
 		bool fetchRecord(thread_db*, FB_SIZE_T) const;
+		bool fetchAdaptive(thread_db* tdbb, Impure* impure) const;
+
+		// Hash join to continue with if the outer stream returns more than
+		// m_switchRecords records, it shares the outer stream with this join
+		HashJoin* const m_fallback = nullptr;
+		NestConst<BoolExprNode> const m_fallbackBoolean;
+		const FB_UINT64 m_switchRecords = 0;
 	};
 
 	class FullOuterJoin : public Join<RecordSource>
@@ -1361,8 +1444,10 @@ namespace Jrd
 		struct Impure : public RecordSource::Impure
 		{
 			HashTable* irsb_hash_table;
+			Firebird::BloomFilter* irsb_bloom_filter;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			bool irsb_leader_hashed;	// hash of the leading record is computed by checkFilter()
 		};
 
 	public:
@@ -1379,6 +1464,19 @@ namespace Jrd
 
 		static unsigned maxCapacity() noexcept;
 
+		// Check the current leading record against the pushed down filter.
+		// To be called after the leading stream has accepted the record,
+		// as the computed hash is reused by the join then.
+		bool checkFilter(thread_db* tdbb, Request* request) const;
+
+		// The join is a fallback of the nested loop join sharing its leading stream
+		void setFallback()
+		{
+			m_fallback = true;
+		}
+
+		void resume(thread_db* tdbb) const;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1391,9 +1489,12 @@ namespace Jrd
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
+		void buildFilter(thread_db* tdbb, Impure* impure, const ULONG* counts) const;
 
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_subs;
+		bool m_pushFilter = false;
+		bool m_fallback = false;
 	};
 
 	class MergeJoin : public Join<SortedStream>
@@ -1513,6 +1614,52 @@ namespace Jrd
 		StreamList m_streams;
 	};
 
+	// Union evaluated once per cursor open, with the result shared by all
+	// references having the same id (materialized CTEs)
+
+	class MaterializedStream final : public RecordStream
+	{
+		struct SharedImpure
+		{
+			RecordBuffer* buffer;
+			FB_UINT64 execution;		// value of req_executions when filled
+			bool filled;
+		};
+
+		struct Impure : public RecordSource::Impure
+		{
+			FB_UINT64 irsb_position;
+		};
+
+	public:
+		MaterializedStream(CompilerScratch* csb, StreamType stream, RecordSource* next, ULONG sharedImpure);
+
+		static std::optional<ULONG> getSharedImpure(CompilerScratch* csb, USHORT sharedId,
+			StreamType stream);
+		static void release(Request* request, ULONG sharedImpure);
+
+		void close(thread_db* tdbb) const override;
+
+		bool refetchRecord(thread_db* tdbb) const override;
+		WriteLockResult lockRecord(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
+
+		void markRecursive() override;
+		void invalidateRecords(Request* request) const override;
+
+		bool isDependent(const StreamList& streams) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		NestConst<RecordSource> m_next;
+		const ULONG m_sharedImpure;
+	};
+
 	class RecursiveStream final : public RecordStream
 	{
 		static const FB_SIZE_T MAX_RECURSE_LEVEL = 1024;
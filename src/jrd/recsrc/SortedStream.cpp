@@ -185,6 +185,38 @@ void SortedStream::nullRecords(thread_db* tdbb) const
 	m_next->nullRecords(tdbb);
 }
 
+FB_UINT64 SortedStream::getLimit(thread_db* tdbb) const
+{
+	if (!m_first)
+		return 0;
+
+	// Invalid values are reported by FirstRowsStream and SkipRowsStream,
+	// just don't limit the sort then
+
+	Request* const request = tdbb->getRequest();
+
+	const dsc* desc = EVL_expr(tdbb, request, m_first);
+	const SINT64 first = desc ? MOV_get_int64(tdbb, desc, 0) : 0;
+
+	SINT64 skip = 0;
+
+	if (m_skip)
+	{
+		desc = EVL_expr(tdbb, request, m_skip);
+		skip = desc ? MOV_get_int64(tdbb, desc, 0) : 0;
+	}
+
+	return getLimit(first, skip);
+}
+
+FB_UINT64 SortedStream::getLimit(SINT64 first, SINT64 skip)
+{
+	if (first <= 0 || skip < 0 || first > MAX_SINT64 - skip)
+		return 0;
+
+	return first + skip;
+}
+
 Sort* SortedStream::init(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
@@ -198,7 +230,8 @@ Sort* SortedStream::init(thread_db* tdbb) const
 		Sort(tdbb->getDatabase(), &request->req_sorts,
 			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
 			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
+			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0,
+			 getLimit(tdbb)));
 
 	// Pump the input stream dry while pushing records into sort. For
 	// each record, map all fields into the sort record. The reverse
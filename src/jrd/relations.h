@@ -351,6 +351,7 @@ RELATION(nam_gens, rel_gens, ODS_8_0, rel_persistent)
 	FIELD(f_gen_init_val, nam_init_val, fld_gen_val, 1, ODS_12_0)
 	FIELD(f_gen_increment, nam_gen_increment, fld_gen_increment, 1, ODS_12_0)
 	FIELD(f_gen_schema, nam_sch_name, fld_sch_name, 1, ODS_14_0)
+	FIELD(f_gen_cache, nam_gen_cache, fld_gen_cache, 1, ODS_14_0)
 END_RELATION
 
 // Relation 21 (RDB$FIELD_DIMENSIONS)
@@ -608,6 +609,8 @@ RELATION(nam_mon_statements, rel_mon_statements, ODS_11_1, rel_virtual)
 	FIELD(f_mon_stmt_timeout, nam_stmt_timeout, fld_stmt_timeout, 0, ODS_13_0)
 	FIELD(f_mon_stmt_timer, nam_stmt_timer, fld_stmt_timer, 0, ODS_13_0)
 	FIELD(f_mon_stmt_cmp_stmt_id, nam_mon_cmp_stmt_id, fld_stmt_id, 0, ODS_13_1)
+	FIELD(f_mon_stmt_temp_cache_used, nam_mon_temp_cache_used, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_stmt_temp_cache_spills, nam_mon_temp_cache_spills, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 37 (MON$CALL_STACK)
@@ -634,6 +637,11 @@ RELATION(nam_mon_io_stats, rel_mon_io_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_io_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_fetches, nam_mon_page_fetches, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_marks, nam_mon_page_marks, fld_counter, 0, ODS_11_1)
+	FIELD(f_mon_io_page_read_time, nam_mon_page_read_time, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_page_write_time, nam_mon_page_write_time, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_latch_wait_time, nam_mon_latch_wait_time, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_lock_wait_time, nam_mon_lock_wait_time, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_sort_io_time, nam_mon_sort_io_time, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 39 (MON$RECORD_STATS)
@@ -655,6 +663,9 @@ RELATION(nam_mon_rec_stats, rel_mon_rec_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_rec_frg_reads, nam_mon_fragment_reads, fld_counter, 0, ODS_12_0)
 	FIELD(f_mon_rec_rpt_reads, nam_mon_rec_rpt_reads, fld_counter, 0, ODS_12_0)
 	FIELD(f_mon_rec_imgc, nam_mon_rec_imgc, fld_counter, 0, ODS_13_0)
+	FIELD(f_mon_rec_wait_time, nam_mon_rec_wait_time, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_rec_gc_time, nam_mon_rec_gc_time, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_rec_insert_waits, nam_mon_rec_insert_waits, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 40 (MON$CONTEXT_VARIABLES)
@@ -386,6 +386,8 @@ public:
 
 	bool isRoot() const;
 
+	TempCacheQuota* getTempCacheQuota();
+
 	bool isRequestIdUnassigned() const noexcept
 	{
 		return req_id == 0;
@@ -434,6 +436,8 @@ public:
 	RuntimeStatistics	req_base_stats;
 	AffectedRows req_records_affected;	// records affected by the last statement
 	FB_UINT64 req_profiler_ticks;		// profiler ticks
+	FB_UINT64 req_executions;			// count of request activations, invalidates runtime counters
+										// and shared union results
 
 	const StmtNode*	req_next;			// next node for execution
 	EDS::Statement*	req_ext_stmt;		// head of list of active dynamic statements
@@ -445,6 +449,7 @@ public:
 	Savepoint*	req_proc_sav_point;		// procedure savepoint list
 	unsigned int req_timeout;					// query timeout in milliseconds, set by the DsqlRequest::setupTimer
 	Firebird::RefPtr<TimeoutTimer> req_timer;	// timeout timer, shared with DsqlRequest
+	Firebird::RefPtr<TempCacheQuota> req_temp_cache_quota;	// memory cached by temp spaces of the call chain
 
 	Firebird::AutoPtr<Jrd::RuntimeStatistics> req_fetch_baseline; // State of request performance counters when we reported it last time
 	SINT64 req_fetch_elapsed;	// Number of clock ticks spent while fetching rows for this request since we reported it last time
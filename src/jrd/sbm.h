@@ -30,11 +30,12 @@
 #define JRD_SBM_H
 
 #include "../common/classes/sparse_bitmap.h"
+#include "../common/classes/roaring_bitmap.h"
 
 namespace Jrd {
 
-// Bitmap of record numbers
-typedef Firebird::SparseBitmap<FB_UINT64> RecordBitmap;
+// Bitmap of record numbers, may grow large for index retrievals
+typedef Firebird::RoaringBitmap<FB_UINT64> RecordBitmap;
 
 // Bitmap of page numbers
 typedef Firebird::SparseBitmap<ULONG> PageBitmap;
@@ -41,6 +41,8 @@
 #include "../jrd/val.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
+#include "../common/utils_proto.h"
+#include "../common/classes/zip.h"
 
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -79,6 +81,9 @@ using namespace Firebird;
 constexpr ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 constexpr ULONG MIN_RECORDS_TO_ALLOC = 8;
 
+// Compressed runs are written to scratch file in chunks of this size
+constexpr ULONG PACK_CHUNK_SIZE = 32 * 1024;
+
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
 // the size of sr_bckptr in # of 32 bit longwords
@@ -125,6 +130,10 @@ namespace
 {
 	static constexpr const char* SCRATCH = "fb_sort_";
 
+#ifdef HAVE_ZLIB_H
+	InitInstance<ZLib> zlib;
+#endif
+
 	class RunSort
 	{
 	public:
@@ -133,7 +142,7 @@ namespace
 
 		static FB_UINT64 generate(const RunSort& item) noexcept
 		{
-			return item.run->run_seek;
+			return item.run->run_packed ? item.run->run_packed->getSeek() : item.run->run_seek;
 		}
 
 		run_control* run;
@@ -160,9 +169,9 @@ Sort::Sort(Database* dbb,
 		   void* user_arg,
 		   FB_UINT64 max_records)
 	: m_dbb(dbb), m_owner(owner),
-	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
+	  m_last_record(NULL), m_next_pointer(NULL), m_records(0), m_spare_record(NULL),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
-	  m_flags(0), m_merge_pool(NULL),
+	  m_flags(0), m_merge_pool(NULL), m_io_time(0), m_pack(false),
 	  m_description(m_owner->getPool(), keys)
 {
 /**************************************
@@ -179,6 +188,11 @@ Sort::Sort(Database* dbb,
  *		  compared. This is used at creation of unique index since sort key
  *		  includes index key (which must be unique) and record numbers.
  *
+ * If max_records is given, only that many first records are going to be
+ * read back. If they fit into the sort buffer, the records are kept in
+ * a bounded heap and the rest are thrown away as they arrive, so nothing
+ * is ever written to the scratch file.
+ *
  **************************************/
 	fb_assert(m_owner);
 	fb_assert(unique_keys <= keys);
@@ -199,7 +213,17 @@ Sort::Sort(Database* dbb,
 
 		m_dup_callback = call_back;
 		m_dup_callback_arg = user_arg;
-		m_max_records = max_records;
+
+		// Top-N heap needs room for N records plus a spare one, and for
+		// their pointers plus low and high key guards
+
+		const FB_UINT64 top_size = max_records ?
+			(max_records + 2) * sizeof(sort_record*) + (max_records + 1) * record_size : 0;
+
+		m_max_records = (!call_back && top_size <= m_max_alloc_size * RUN_GROUP) ? max_records : 0;
+
+		if (m_max_records)
+			m_max_alloc_size = MAX(m_max_alloc_size, (ULONG) top_size);
 
 		for (FB_SIZE_T i = 0; i < keys; i++)
 		{
@@ -222,6 +246,9 @@ Sort::Sort(Database* dbb,
 
 		allocateBuffer(pool);
 
+		if (top_size > m_size_memory)
+			m_max_records = 0;
+
 		m_end_memory = m_memory + m_size_memory;
 		m_first_pointer = (sort_record**) m_memory;
 
@@ -230,6 +257,11 @@ Sort::Sort(Database* dbb,
 		try
 		{
 			m_space = FB_NEW_POOL(pool) TempSpace(pool, SCRATCH, false);
+
+			if (const auto request = JRD_get_thread_data()->getRequest())
+				m_space->setCacheQuota(request->getTempCacheQuota());
+
+			m_pack = dbb->dbb_config->getSortCompression() && PackedRun::isSupported();
 		}
 		catch (const Exception&)
 		{
@@ -279,6 +311,7 @@ Sort::~Sort()
 		m_runs = run->run_next;
 		if (run->run_buff_alloc)
 			delete[] run->run_buffer;
+		delete run->run_packed;
 		delete run;
 	}
 
@@ -289,6 +322,7 @@ Sort::~Sort()
 		m_free_runs = run->run_next;
 		if (run->run_buff_alloc)
 			delete[] run->run_buffer;
+		delete run->run_packed;
 		delete run;
 	}
 
@@ -316,6 +350,8 @@ void Sort::get(thread_db* tdbb, ULONG** record_address)
 		{
 			diddleKey((UCHAR*) record->sort_record_key, false, false);
 		}
+
+		accountScratch(tdbb);
 	}
 	catch (const BadAlloc&)
 	{
@@ -353,6 +389,23 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		if (record != (SR*) m_end_memory)
 		{
 			diddleKey((UCHAR*) (record->sr_sort_record.sort_record_key), true, false);
+
+			if (m_max_records)
+				settleTop();
+		}
+
+		// If the top-N heap is full, let the caller fill the spare record.
+		// It replaces the top of the heap later, if it deserves that.
+
+		if (m_max_records && m_records == m_max_records)
+		{
+			if (!m_spare_record)
+				m_spare_record = NEXT_RECORD(record);
+
+			m_last_record = m_spare_record;
+			m_spare_record->sr_bckptr = NULL;
+			*record_address = (ULONG*) m_spare_record->sr_sort_record.sort_record_key;
+			return;
 		}
 
 		// If there isn't room for the record, sort and write the run.
@@ -391,6 +444,8 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		*m_next_pointer++ = reinterpret_cast<sort_record*>(record->sr_sort_record.sort_record_key);
 		m_records++;
 		*record_address = (ULONG*) record->sr_sort_record.sort_record_key;
+
+		accountScratch(tdbb);
 	}
 	catch (const BadAlloc&)
 	{
@@ -424,6 +479,9 @@ void Sort::sort(thread_db* tdbb)
 		if (m_last_record != (SR*) m_end_memory)
 		{
 			diddleKey((UCHAR*) KEYOF(m_last_record), true, false);
+
+			if (m_max_records)
+				settleTop();
 		}
 
 		// If there aren't any runs, things fit nicely in memory. Just sort the mess
@@ -588,6 +646,8 @@ void Sort::sort(thread_db* tdbb)
 		sortRunsBySeek(run_count);
 
 		m_flags |= scb_sorted;
+
+		accountScratch(tdbb);
 	}
 	catch (const BadAlloc&)
 	{
@@ -602,6 +662,51 @@ void Sort::sort(thread_db* tdbb)
 }
 
 
+FB_UINT64 Sort::readScratch(FB_UINT64 seek, UCHAR* address, ULONG length)
+{
+/**************************************
+ *
+ * Read a block from scratch space, accumulating the time spent.
+ *
+ **************************************/
+	const SINT64 start = fb_utils::query_performance_counter();
+	seek = readBlock(m_space, seek, address, length);
+	m_io_time += fb_utils::query_performance_counter() - start;
+	return seek;
+}
+
+
+FB_UINT64 Sort::writeScratch(FB_UINT64 seek, const UCHAR* address, ULONG length)
+{
+/**************************************
+ *
+ * Write a block to scratch space, accumulating the time spent.
+ *
+ **************************************/
+	const SINT64 start = fb_utils::query_performance_counter();
+	seek = writeBlock(m_space, seek, address, length);
+	m_io_time += fb_utils::query_performance_counter() - start;
+	return seek;
+}
+
+
+void Sort::accountScratch(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Add the accumulated scratch I/O time to the runtime statistics.
+ * It's done here rather than in readScratch()/writeScratch() as
+ * the latter may be called with the engine checked out.
+ *
+ **************************************/
+	if (const auto elapsed = RuntimeStatistics::toMicroseconds(m_io_time))
+	{
+		tdbb->bumpStats(WaitStatType::SORT_IO, elapsed);
+		m_io_time = 0;
+	}
+}
+
+
 void Sort::allocateBuffer(MemoryPool& pool)
 {
 	if (m_max_alloc_size <= MAX_SORT_BUFFER_SIZE)
@@ -1225,7 +1330,17 @@ sort_record* Sort::getMerge(merge_control* merge)
 			l = (ULONG) (run->run_end_buffer - run->run_buffer);
 			n = run->run_records * m_longs * sizeof(ULONG);
 			l = MIN(l, n);
-			run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, l);
+
+			if (run->run_packed)
+				run->run_packed->read(run->run_buffer, l);
+			else
+			{
+				run->run_seek = readScratch(run->run_seek, run->run_buffer, l);
+
+				// Let the OS read the next portion of the run while this one is merged
+				if (n > l)
+					m_space->prefetch(run->run_seek, MIN(l, n - l));
+			}
 
 			record = reinterpret_cast<sort_record*>(run->run_buffer);
 			run->run_record =
@@ -1461,7 +1576,7 @@ ULONG Sort::allocate(ULONG n, ULONG chunkSize, bool useFreeSpace)
 	{
 		run->run_buffer = NULL;
 
-		UCHAR* const mem = m_space->inMemory(run->run_seek, run->run_size);
+		UCHAR* const mem = run->run_packed ? NULL : m_space->inMemory(run->run_seek, run->run_size);
 
 		if (mem)
 		{
@@ -1589,7 +1704,9 @@ void Sort::mergeRuns(USHORT n)
 				run->run_record = reinterpret_cast<sort_record*>(run->run_end_buffer);
 			}
 		}
-		temp_run.run_size += run->run_size;
+
+		// Compressed run takes less space than its records may need
+		temp_run.run_size += run->run_packed ? (FB_UINT64) run->run_records * rec_size : run->run_size;
 	}
 	temp_run.run_record = reinterpret_cast<sort_record*>(buffer);
 	temp_run.run_buffer = reinterpret_cast<UCHAR*>(temp_run.run_record);
@@ -1636,8 +1753,23 @@ void Sort::mergeRuns(USHORT n)
 	// Merge records into run
 	CHECK_FILE(NULL);
 
+	// Once the scratch space spilled to disk, compress the runs written there.
+	// Compressed run allocates its space as it grows.
+
+	const bool pack = m_pack && m_space->isSpilled();
+
 	sort_record* q = reinterpret_cast<sort_record*>(temp_run.run_buffer);
-	FB_UINT64 seek = temp_run.run_seek = m_space->allocateSpace(temp_run.run_size);
+	FB_UINT64 seek = 0;
+
+	if (pack)
+	{
+		temp_run.run_packed = FB_NEW_POOL(m_owner->getPool())
+			PackedRun(m_owner->getPool(), m_space, &m_io_time);
+		temp_run.run_size = 0;
+	}
+	else
+		seek = temp_run.run_seek = m_space->allocateSpace(temp_run.run_size);
+
 	temp_run.run_records = 0;
 
 	CHECK_FILE(&temp_run);
@@ -1648,7 +1780,12 @@ void Sort::mergeRuns(USHORT n)
 		if (q >= (sort_record*) temp_run.run_end_buffer)
 		{
 			size = (UCHAR*) q - temp_run.run_buffer;
-			seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+
+			if (pack)
+				temp_run.run_packed->write(temp_run.run_buffer, size);
+			else
+				seek = writeScratch(seek, temp_run.run_buffer, size);
+
 			q = reinterpret_cast<sort_record*>(temp_run.run_buffer);
 		}
 		ULONG longs_count = m_longs;
@@ -1660,16 +1797,29 @@ void Sort::mergeRuns(USHORT n)
 
 	// Write the tail of the new run and return any unused space
 
-	if ( (size = (UCHAR*) q - temp_run.run_buffer) )
-		seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+	size = (UCHAR*) q - temp_run.run_buffer;
 
-	// If the records did not fill the allocated run (such as when duplicates are
-	// rejected), then free the remainder and diminish the size of the run accordingly
+	if (pack)
+	{
+		if (size)
+			temp_run.run_packed->write(temp_run.run_buffer, size);
 
-	if (seek - temp_run.run_seek < temp_run.run_size)
+		temp_run.run_packed->flush();
+		temp_run.run_size = temp_run.run_packed->getSize();
+	}
+	else
 	{
-		m_space->releaseSpace(seek, temp_run.run_seek + temp_run.run_size - seek);
-		temp_run.run_size = seek - temp_run.run_seek;
+		if (size)
+			seek = writeScratch(seek, temp_run.run_buffer, size);
+
+		// If the records did not fill the allocated run (such as when duplicates are
+		// rejected), then free the remainder and diminish the size of the run accordingly
+
+		if (seek - temp_run.run_seek < temp_run.run_size)
+		{
+			m_space->releaseSpace(seek, temp_run.run_seek + temp_run.run_size - seek);
+			temp_run.run_size = seek - temp_run.run_seek;
+		}
 	}
 
 	// Make a final pass thru the runs releasing space, blocks, etc.
@@ -1679,11 +1829,10 @@ void Sort::mergeRuns(USHORT n)
 		// Remove run from list of in-use run blocks
 		run = m_runs;
 		m_runs = run->run_next;
-		seek = run->run_seek - run->run_size;
 
 		// Free the sort file space associated with the run
 
-		m_space->releaseSpace(seek, run->run_size);
+		releaseRun(run);
 
 		if (run->run_mem_size)
 		{
@@ -1975,6 +2124,21 @@ void Sort::orderAndSave(thread_db* tdbb)
 
 	const ULONG key_length = (m_longs - SIZEOF_SR_BCKPTR_IN_LONGS) * sizeof(ULONG);
 	run->run_size = run->run_records * key_length;
+
+	// Once the scratch space spilled to disk, compress the runs written there
+
+	if (m_pack && m_space->isSpilled())
+	{
+		order();
+
+		run->run_packed = FB_NEW_POOL(m_owner->getPool())
+			PackedRun(m_owner->getPool(), m_space, &m_io_time);
+		run->run_packed->write((UCHAR*) m_last_record, (ULONG) run->run_size);
+		run->run_packed->flush();
+		run->run_size = run->run_packed->getSize();
+		return;
+	}
+
 	run->run_seek = m_space->allocateSpace(run->run_size);
 
 	UCHAR* mem = m_space->inMemory(run->run_seek, run->run_size);
@@ -2000,7 +2164,7 @@ void Sort::orderAndSave(thread_db* tdbb)
 	else
 	{
 		order();
-		writeBlock(m_space, run->run_seek, (UCHAR*) m_last_record, run->run_size);
+		writeScratch(run->run_seek, (UCHAR*) m_last_record, run->run_size);
 	}
 }
 
@@ -2042,6 +2206,25 @@ void Sort::putRun(thread_db* tdbb)
 }
 
 
+void Sort::releaseRun(run_control* run)
+{
+/**************************************
+ *
+ * Free the sort file space associated with the run.
+ * The run has been read up to its end.
+ *
+ **************************************/
+	if (run->run_packed)
+	{
+		run->run_packed->release();
+		delete run->run_packed;
+		run->run_packed = NULL;
+	}
+	else
+		m_space->releaseSpace(run->run_seek - run->run_size, run->run_size);
+}
+
+
 void Sort::sortBuffer(thread_db* tdbb)
 {
 /**************************************
@@ -2135,6 +2318,93 @@ void Sort::sortBuffer(thread_db* tdbb)
 }
 
 
+bool Sort::keyBefore(const SORTP* p, const SORTP* q) const noexcept
+{
+/**************************************
+ *
+ * Return true if the first key sorts before the second one.
+ * Both keys should be already diddled.
+ *
+ **************************************/
+	for (ULONG n = m_key_length; n; n--, p++, q++)
+	{
+		if (*p != *q)
+			return *p < *q;
+	}
+
+	return false;
+}
+
+
+void Sort::settleTop() noexcept
+{
+/**************************************
+ *
+ * Put the last record passed in into the top-N heap. The heap lives in
+ * the pointer array (element 0 being the low key) and has the record
+ * that sorts last at its top. A new record either extends the heap or,
+ * when the heap is full, replaces the top if it sorts before it.
+ *
+ **************************************/
+	SORTP** const heap = (SORTP**) m_first_pointer;
+
+	if (m_last_record != m_spare_record)
+	{
+		// Sift the new record up
+
+		for (ULONG i = (ULONG) m_records; i > 1 && keyBefore(heap[i / 2], heap[i]); i /= 2)
+			swap(heap + i / 2, heap + i);
+
+		return;
+	}
+
+	SORTP* const key = (SORTP*) KEYOF(m_spare_record);
+
+	if (!keyBefore(key, heap[1]))
+		return;
+
+	// Replace the top with the new record and reuse the old top as a spare
+
+	m_spare_record = (SR*) (heap[1] - SIZEOF_SR_BCKPTR_IN_LONGS);
+	m_spare_record->sr_bckptr = NULL;
+
+	heap[1] = key;
+	((SORTP***) key)[BACK_OFFSET] = heap + 1;
+
+	siftDown(1);
+}
+
+
+void Sort::siftDown(ULONG i) noexcept
+{
+/**************************************
+ *
+ * Restore the top-N heap order below the given element.
+ *
+ **************************************/
+	SORTP** const heap = (SORTP**) m_first_pointer;
+	const ULONG count = (ULONG) m_records;
+
+	while (true)
+	{
+		ULONG last = i;
+		const ULONG left = i * 2, right = left + 1;
+
+		if (left <= count && keyBefore(heap[last], heap[left]))
+			last = left;
+
+		if (right <= count && keyBefore(heap[last], heap[right]))
+			last = right;
+
+		if (last == i)
+			break;
+
+		swap(heap + i, heap + last);
+		i = last;
+	}
+}
+
+
 void Sort::sortRunsBySeek(int n)
 {
 /**************************************
@@ -2164,6 +2434,257 @@ void Sort::sortRunsBySeek(int n)
 }
 
 
+/// class PackedRun
+
+PackedRun::PackedRun(MemoryPool& pool, TempSpace* space, SINT64* ioTime)
+	: m_pool(pool), m_space(space), m_ioTime(ioTime), m_chunks(pool),
+	  m_size(0), m_lastLength(0), m_nextChunk(0), m_buffer(pool),
+	  m_stream(nullptr), m_packing(false)
+{
+}
+
+PackedRun::~PackedRun()
+{
+	endStream();
+}
+
+bool PackedRun::isSupported()
+{
+#ifdef HAVE_ZLIB_H
+	return zlib();
+#else
+	return false;
+#endif
+}
+
+void PackedRun::write(const UCHAR* data, ULONG length)
+{
+/**************************************
+ *
+ * Compress the next portion of the run, writing out
+ * the chunks filled up.
+ *
+ **************************************/
+#ifdef HAVE_ZLIB_H
+	if (!m_stream)
+	{
+		fb_assert(m_chunks.isEmpty());
+
+		m_stream = FB_NEW_POOL(m_pool) z_stream;
+		memset(m_stream, 0, sizeof(z_stream));
+		m_stream->zalloc = ZLib::allocFunc;
+		m_stream->zfree = ZLib::freeFunc;
+		m_stream->opaque = Z_NULL;
+
+		// Runs are written while the sort waits, so prefer speed to ratio
+		const int ret = zlib().deflateInit(m_stream, Z_BEST_SPEED);
+		if (ret != Z_OK)
+		{
+			delete m_stream;
+			m_stream = nullptr;
+			(Arg::Gds(isc_deflate_init) << Arg::Num(ret)).raise();
+		}
+
+		m_packing = true;
+		m_stream->next_out = m_buffer.getBuffer(PACK_CHUNK_SIZE, false);
+		m_stream->avail_out = PACK_CHUNK_SIZE;
+	}
+
+	fb_assert(m_packing);
+
+	m_stream->next_in = const_cast<UCHAR*>(data);
+	m_stream->avail_in = length;
+	pack(Z_NO_FLUSH);
+#else
+	fb_assert(false);
+#endif
+}
+
+void PackedRun::flush()
+{
+/**************************************
+ *
+ * Finish the compressed stream and write out its tail.
+ * The run may be read back after that.
+ *
+ **************************************/
+#ifdef HAVE_ZLIB_H
+	if (!m_stream)
+		write(NULL, 0);
+
+	fb_assert(m_packing);
+
+	m_stream->next_in = Z_NULL;
+	m_stream->avail_in = 0;
+	pack(Z_FINISH);
+
+	endStream();
+	m_buffer.free();
+#else
+	fb_assert(false);
+#endif
+}
+
+void PackedRun::read(UCHAR* buffer, ULONG length)
+{
+/**************************************
+ *
+ * Decompress the next portion of the run,
+ * reading in the chunks as needed.
+ *
+ **************************************/
+#ifdef HAVE_ZLIB_H
+	if (!m_stream)
+	{
+		m_stream = FB_NEW_POOL(m_pool) z_stream;
+		memset(m_stream, 0, sizeof(z_stream));
+		m_stream->zalloc = ZLib::allocFunc;
+		m_stream->zfree = ZLib::freeFunc;
+		m_stream->opaque = Z_NULL;
+		m_stream->next_in = Z_NULL;
+		m_stream->avail_in = 0;
+
+		const int ret = zlib().inflateInit(m_stream);
+		if (ret != Z_OK)
+		{
+			delete m_stream;
+			m_stream = nullptr;
+			(Arg::Gds(isc_inflate_init) << Arg::Num(ret)).raise();
+		}
+
+		m_packing = false;
+		m_buffer.getBuffer(PACK_CHUNK_SIZE, false);
+	}
+
+	fb_assert(!m_packing);
+
+	m_stream->next_out = buffer;
+	m_stream->avail_out = length;
+
+	while (m_stream->avail_out)
+	{
+		if (!m_stream->avail_in)
+			readChunk();
+
+		const int ret = zlib().inflate(m_stream, Z_NO_FLUSH);
+
+		if (ret != Z_OK && !(ret == Z_STREAM_END && !m_stream->avail_out))
+			(Arg::Gds(isc_random) << "Compressed sort run is corrupted").raise();
+	}
+#else
+	fb_assert(false);
+#endif
+}
+
+void PackedRun::release() noexcept
+{
+/**************************************
+ *
+ * Return the chunks to the scratch space.
+ *
+ **************************************/
+	for (FB_SIZE_T i = 0; i < m_chunks.getCount(); i++)
+		m_space->releaseSpace(m_chunks[i], getChunkLength(i));
+
+	m_chunks.clear();
+	m_size = m_lastLength = 0;
+	m_nextChunk = 0;
+
+	endStream();
+	m_buffer.free();
+}
+
+ULONG PackedRun::getChunkLength(FB_SIZE_T chunk) const noexcept
+{
+	return (chunk == m_chunks.getCount() - 1) ? m_lastLength : PACK_CHUNK_SIZE;
+}
+
+void PackedRun::pack(int flush)
+{
+#ifdef HAVE_ZLIB_H
+	while (true)
+	{
+		const int ret = zlib().deflate(m_stream, flush);
+		fb_assert(ret != Z_STREAM_ERROR);
+
+		const bool end = (ret == Z_STREAM_END);
+
+		if (!m_stream->avail_out || end)
+			writeChunk();
+
+		// Without flush we're done when the input is consumed,
+		// deflate() keeps the pending output for the next call
+
+		if (end || (flush == Z_NO_FLUSH && !m_stream->avail_in))
+			break;
+	}
+#endif
+}
+
+void PackedRun::writeChunk()
+{
+#ifdef HAVE_ZLIB_H
+	const ULONG length = PACK_CHUNK_SIZE - m_stream->avail_out;
+
+	if (length)
+	{
+		// Add the chunk first to release its space if the write fails
+		m_chunks.add(m_space->allocateSpace(length));
+		m_size += length;
+		m_lastLength = length;
+
+		const SINT64 start = fb_utils::query_performance_counter();
+		Sort::writeBlock(m_space, m_chunks.back(), m_buffer.begin(), length);
+
+		if (m_ioTime)
+			*m_ioTime += fb_utils::query_performance_counter() - start;
+	}
+
+	m_stream->next_out = m_buffer.begin();
+	m_stream->avail_out = PACK_CHUNK_SIZE;
+#endif
+}
+
+void PackedRun::readChunk()
+{
+#ifdef HAVE_ZLIB_H
+	if (m_nextChunk >= m_chunks.getCount())
+		(Arg::Gds(isc_random) << "Compressed sort run is corrupted").raise();
+
+	const ULONG length = getChunkLength(m_nextChunk);
+
+	const SINT64 start = fb_utils::query_performance_counter();
+	Sort::readBlock(m_space, m_chunks[m_nextChunk++], m_buffer.begin(), length);
+
+	if (m_ioTime)
+		*m_ioTime += fb_utils::query_performance_counter() - start;
+
+	// Let the OS read the next chunk while this one is decompressed
+	if (m_nextChunk < m_chunks.getCount())
+		m_space->prefetch(m_chunks[m_nextChunk], getChunkLength(m_nextChunk));
+
+	m_stream->next_in = m_buffer.begin();
+	m_stream->avail_in = length;
+#endif
+}
+
+void PackedRun::endStream() noexcept
+{
+#ifdef HAVE_ZLIB_H
+	if (m_stream)
+	{
+		if (m_packing)
+			zlib().deflateEnd(m_stream);
+		else
+			zlib().inflateEnd(m_stream);
+
+		delete m_stream;
+		m_stream = nullptr;
+	}
+#endif
+}
+
+
 /// class SortOwner
 
 UCHAR* SortOwner::allocateBuffer()
@@ -2295,6 +2816,9 @@ void PartitionedSort::get(thread_db* tdbb, ULONG** record_address)
 
 	if (record)
 		m_parts[0].srt_sort->diddleKey((UCHAR*)record->sort_record_key, false, true);
+
+	for (auto& part : m_parts)
+		part.srt_sort->accountScratch(tdbb);
 }
 
 sort_record* PartitionedSort::getMerge()
@@ -29,6 +29,8 @@
 #include "../jrd/TempSpace.h"
 #include "../jrd/align.h"
 
+struct z_stream_s;
+
 namespace Jrd {
 
 // Forward declaration
@@ -36,6 +38,7 @@ class Attachment;
 class Sort;
 class SortOwner;
 struct merge_control;
+class PackedRun;
 
 // SORTP is used throughout sort.c as a pointer into arrays of
 // longwords(32 bits).
@@ -225,6 +228,56 @@ inline constexpr int RMH_TYPE_MRG	= 1;
 inline constexpr int RMH_TYPE_SORT	= 2;
 
 
+// Sort run compressed into a chain of scratch space chunks. A run is written
+// and then read back sequentially just once, so it's packed as a single zlib
+// stream and the space is allocated chunk by chunk as the stream comes out.
+
+class PackedRun
+{
+public:
+	PackedRun(MemoryPool& pool, TempSpace* space, SINT64* ioTime = nullptr);
+	~PackedRun();
+
+	// Whether the compression library is available
+	static bool isSupported();
+
+	void write(const UCHAR* data, ULONG length);
+	void flush();
+	void read(UCHAR* buffer, ULONG length);
+	void release() noexcept;
+
+	// Position of the first chunk, used to order the reads of runs
+	FB_UINT64 getSeek() const noexcept
+	{
+		return m_chunks.hasData() ? m_chunks[0] : 0;
+	}
+
+	// Scratch space taken by the chunks
+	FB_UINT64 getSize() const noexcept
+	{
+		return m_size;
+	}
+
+private:
+	ULONG getChunkLength(FB_SIZE_T chunk) const noexcept;
+	void pack(int flush);
+	void writeChunk();
+	void readChunk();
+	void endStream() noexcept;
+
+	MemoryPool& m_pool;
+	TempSpace* const m_space;
+	SINT64* const m_ioTime;						// Scratch I/O time, if accumulated
+	Firebird::Array<FB_UINT64> m_chunks;		// Positions of the chunks, all but the last are full
+	FB_UINT64 m_size;							// Total length of the chunks
+	ULONG m_lastLength;							// Length of the last chunk
+	FB_SIZE_T m_nextChunk;						// Next chunk to read
+	Firebird::Array<UCHAR> m_buffer;			// Chunk being written or read
+	z_stream_s* m_stream;						// Compression or decompression stream
+	bool m_packing;								// Stream compresses
+};
+
+
 // Run control block
 
 struct run_control
@@ -242,6 +295,7 @@ struct run_control
 	bool			run_buff_cache;		// run buffer is already in cache
 	FB_UINT64		run_mem_seek;		// position of run's buffer in in-memory part of sort file
 	ULONG			run_mem_size;		// size of run's buffer in in-memory part of sort file
+	PackedRun*		run_packed;			// compressed run in scratch file, if any
 };
 
 // Merge control block
@@ -309,6 +363,10 @@ private:
 	void allocateBuffer(MemoryPool&);
 	void releaseBuffer();
 
+	FB_UINT64 readScratch(FB_UINT64, UCHAR*, ULONG);
+	FB_UINT64 writeScratch(FB_UINT64, const UCHAR*, ULONG);
+	void accountScratch(Jrd::thread_db*);
+
 	void diddleKey(UCHAR*, bool, bool);
 	sort_record* getMerge(merge_control*);
 	sort_record* getRecord();
@@ -318,9 +376,14 @@ private:
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
 	void putRun(Jrd::thread_db*);
+	void releaseRun(run_control*);
 	void sortBuffer(Jrd::thread_db*);
 	void sortRunsBySeek(int);
 
+	bool keyBefore(const SORTP*, const SORTP*) const noexcept;
+	void settleTop() noexcept;
+	void siftDown(ULONG) noexcept;
+
 #ifdef DEV_BUILD
 	void checkFile(const run_control*);
 #endif
@@ -339,7 +402,8 @@ private:
 	ULONG m_key_length;							// Key length
 	ULONG m_unique_length;						// Unique key length, used when duplicates eliminated
 	FB_UINT64 m_records;						// Number of records
-	FB_UINT64 m_max_records;					// Maximum number of records to store, assigned but unused.
+	FB_UINT64 m_max_records;					// Maximum number of records to return, zero if unlimited
+	SR* m_spare_record;							// Spare record for a candidate when top-N heap is full
 	TempSpace* m_space;							// temporary space for scratch file
 	run_control* m_runs;						// ALLOC: Run on scratch file, if any
 	merge_control* m_merge;						// Top level merge block
@@ -351,6 +415,8 @@ private:
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
+	SINT64 m_io_time;							// Scratch I/O time not yet added to statistics
+	bool m_pack;								// Compress runs spilled to scratch file
 
 	Firebird::Array<sort_key_def> m_description;
 };
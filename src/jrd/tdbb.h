@@ -341,6 +341,18 @@ public:
 		// We don't bump counters for dbbStat here, they're merged from attStats on demand
 	}
 
+	void bumpStats(const WaitStatType type, SINT64 delta)
+	{
+		reqStat->bumpValue(type, delta);
+		traStat->bumpValue(type, delta);
+		attStat->bumpValue(type, delta);
+
+		if ((tdbb_flags & TDBB_async) && !attachment)
+			dbbStat->bumpValue(type, delta);
+
+		// else dbbStat is adjusted from attStat, see Attachment::mergeStats()
+	}
+
 
 	ISC_STATUS getCancelState(ISC_STATUS* secondary = NULL);
 	void checkCancelState();
@@ -0,0 +1,449 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/btr.h"
+#include "../jrd/btn.h"
+#include "../jrd/btr_proto.h"
+#include <stdio.h>
+
+#ifndef WIN_NT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace Ods;
+
+namespace
+{
+	constexpr FB_SIZE_T PAGE_SIZE = 16384;
+	constexpr USHORT JUMP_INTERVAL = 512;
+
+	// Return n-th key in page order
+	void makeKey(unsigned n, temporary_mini_key& key, bool descending = false)
+	{
+		// Long common prefix, as produced by compound keys and
+		// keys on long strings with a shared leading part.
+		key.key_length = (USHORT) sprintf(reinterpret_cast<char*>(key.key_data),
+			"CUSTOMER/ACCOUNT/LEDGER/%010u", (descending ? MAX_USHORT - n : n) * 2);
+		key.key_flags = 0;
+		key.key_nulls = 0;
+
+		if (descending)
+		{
+			for (USHORT i = 0; i < key.key_length; i++)
+				key.key_data[i] ^= 0xFF;
+		}
+	}
+
+	// Page number stored in the n-th node of a non-leaf page
+	ULONG childOf(unsigned n)
+	{
+		return 1000 + n;
+	}
+
+	// Index page with prefix compressed nodes and a jump table, laid out the
+	// same way as fast_load() and generate_jump_nodes() build it. The first
+	// node of a non-leaf page is the degenerate one with an empty key.
+	class IndexPage
+	{
+	public:
+		explicit IndexPage(unsigned count, bool descending = false, UCHAR level = 0)
+			: nodes(*getDefaultMemoryPool())
+		{
+			const bool leaf = (level == 0);
+
+			UCHAR area[PAGE_SIZE];
+			UCHAR* pointer = area;
+
+			Array<USHORT> offsets;
+			Array<IndexJumpNode> jumpNodes;
+			Array<unsigned> jumpTargets;
+			temporary_mini_key prevKey, jumpKey, key;
+			prevKey.key_length = 0;
+			jumpKey.key_length = 0;
+
+			FB_SIZE_T jumpersSize = 0;
+			FB_SIZE_T nextArea = JUMP_INTERVAL;
+
+			for (unsigned n = 0; n < count; n++)
+			{
+				if (leaf || n)
+					makeKey(n, key, descending);
+				else
+					key.key_length = 0;
+
+				IndexNode node;
+				node.prefix = IndexNode::computePrefix(prevKey.key_data, prevKey.key_length,
+					key.key_data, key.key_length);
+				node.setNode(node.prefix, key.key_length - node.prefix, RecordNumber(n + 1),
+					(leaf ? 0 : childOf(n)));
+				node.data = key.key_data + node.prefix;
+
+				const USHORT offset = (USHORT) (pointer - area);
+
+				if (offset > nextArea && jumpNodes.getCount() < MAX_UCHAR)
+				{
+					IndexJumpNode jumpNode;
+					jumpNode.offset = offset;
+					jumpNode.prefix = IndexNode::computePrefix(jumpKey.key_data, jumpKey.key_length,
+						key.key_data, node.prefix);
+					jumpNode.length = node.prefix - jumpNode.prefix;
+
+					memcpy(jumpKey.key_data + jumpNode.prefix, key.key_data + jumpNode.prefix, jumpNode.length);
+					jumpKey.key_length = jumpNode.prefix + jumpNode.length;
+
+					jumpNodes.add(jumpNode);
+					jumpTargets.add(n);
+					jumpersSize += jumpNode.getJumpNodeSize();
+					nextArea += JUMP_INTERVAL;
+				}
+
+				offsets.add(offset);
+				pointer = node.writeNode(pointer, leaf);
+				prevKey = key;
+
+				BOOST_REQUIRE(pointer - area < (ptrdiff_t) (PAGE_SIZE / 2));
+			}
+
+			IndexNode endNode;
+			endNode.setEndLevel();
+			offsets.add((USHORT) (pointer - area));
+			pointer = endNode.writeNode(pointer, leaf);
+
+			memset(buffer, 0, sizeof(buffer));
+			btree_page* const bucket = page();
+			bucket->btr_level = level;
+			bucket->btr_jump_interval = JUMP_INTERVAL;
+			bucket->btr_jump_size = (USHORT) jumpersSize;
+			bucket->btr_jump_count = (UCHAR) jumpNodes.getCount();
+
+			UCHAR* const start = bucket->btr_nodes + jumpersSize;
+			const USHORT base = (USHORT) (start - buffer);
+			UCHAR* jumpPointer = bucket->btr_nodes;
+
+			for (FB_SIZE_T i = 0; i < jumpNodes.getCount(); i++)
+			{
+				// Jump node data is the part of the referenced node's
+				// prefix not shared with the previous jump node
+				IndexJumpNode& jumpNode = jumpNodes[i];
+				makeKey(jumpTargets[i], key, descending);
+				jumpNode.data = key.key_data + jumpNode.prefix;
+				jumpNode.offset += base;
+				jumpPointer = jumpNode.writeJumpNode(jumpPointer);
+			}
+
+			BOOST_REQUIRE(jumpPointer == start);
+
+			memcpy(start, area, pointer - area);
+			bucket->btr_length = (USHORT) (base + (pointer - area));
+
+			for (const auto offset : offsets)
+				nodes.add(start + offset);
+		}
+
+		btree_page* page()
+		{
+			return reinterpret_cast<btree_page*>(buffer);
+		}
+
+		alignas(8) UCHAR buffer[PAGE_SIZE];
+		Array<UCHAR*> nodes;
+	};
+
+	// Copy of the page start placed right before an inaccessible memory page,
+	// so reading past the given size crashes instead of passing unnoticed
+	class GuardedPage
+	{
+	public:
+		GuardedPage(const btree_page* page, ULONG size)
+			: size(size)
+		{
+#ifdef WIN_NT
+			memory = FB_NEW_POOL(*getDefaultMemoryPool()) UCHAR[size];
+			area = memory;
+#else
+			const size_t systemPage = sysconf(_SC_PAGESIZE);
+			mapped = FB_ALIGN(size, systemPage) + systemPage;
+			memory = (UCHAR*) mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			BOOST_REQUIRE(memory != MAP_FAILED);
+
+			UCHAR* const guard = memory + mapped - systemPage;
+			BOOST_REQUIRE(mprotect(guard, systemPage, PROT_NONE) == 0);
+			area = guard - size;
+#endif
+			memcpy(area, page, size);
+		}
+
+		~GuardedPage()
+		{
+#ifdef WIN_NT
+			delete[] memory;
+#else
+			munmap(memory, mapped);
+#endif
+		}
+
+		btree_page* page()
+		{
+			return reinterpret_cast<btree_page*>(area);
+		}
+
+		const ULONG size;
+
+	private:
+		UCHAR* memory;
+		UCHAR* area;
+#ifndef WIN_NT
+		size_t mapped;
+#endif
+	};
+
+	// Key sorting right after the n-th key, the search for it stops at the n-th node
+	void makeNextKey(unsigned n, temporary_key& key)
+	{
+		makeKey(n, key);
+		key.key_data[key.key_length++] = 0;
+	}
+
+	index_desc makeIndex()
+	{
+		index_desc idx;
+		memset(&idx, 0, sizeof(idx));
+		idx.idx_count = 1;
+		return idx;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(BtrSuite)
+
+
+BOOST_AUTO_TEST_SUITE(BtrTests)
+
+BOOST_AUTO_TEST_CASE(MatchLengthTest)
+{
+	UCHAR string1[100], string2[100];
+
+	for (unsigned i = 0; i < sizeof(string1); i++)
+		string1[i] = string2[i] = (UCHAR) i;
+
+	BOOST_TEST(IndexNode::matchLength(string1, string2, 0) == 0);
+	BOOST_TEST(IndexNode::matchLength(string1, string2, sizeof(string1)) == sizeof(string1));
+
+	for (unsigned diff = 0; diff < sizeof(string1); diff++)
+	{
+		string2[diff] ^= 0x80;
+
+		for (unsigned length = 0; length <= sizeof(string1); length++)
+			BOOST_TEST(IndexNode::matchLength(string1, string2, length) == MIN(diff, length));
+
+		string2[diff] ^= 0x80;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FindLeafTest)
+{
+	constexpr unsigned COUNT = 400;
+	IndexPage leaf(COUNT);
+	btree_page* const bucket = leaf.page();
+
+	BOOST_TEST(bucket->btr_jump_count > 0);
+
+	temporary_key key;
+
+	for (unsigned n = 0; n < COUNT; n++)
+	{
+		USHORT prefix = 0;
+
+		// Exact match lands on the node itself
+		makeKey(n, key);
+		BOOST_TEST(BTR_find_leaf(bucket, &key, nullptr, &prefix, false, 0) == leaf.nodes[n]);
+
+		// A key that sorts between two nodes lands on the next one
+		key.key_data[key.key_length++] = 0;
+		BOOST_TEST(BTR_find_leaf(bucket, &key, nullptr, &prefix, false, 0) == leaf.nodes[n + 1]);
+
+		// A key that sorts just before the node lands on the node as well
+		key.key_data[--key.key_length - 1]--;
+		BOOST_TEST(BTR_find_leaf(bucket, &key, nullptr, &prefix, false, 0) == leaf.nodes[n]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FindLeafDescendingTest)
+{
+	constexpr unsigned COUNT = 400;
+	IndexPage leaf(COUNT, true);
+	btree_page* const bucket = leaf.page();
+
+	temporary_key key;
+
+	for (unsigned n = 0; n < COUNT; n++)
+	{
+		makeKey(n, key, true);
+		BOOST_TEST(BTR_find_leaf(bucket, &key, nullptr, nullptr, true, 0) == leaf.nodes[n]);
+
+		key.key_data[key.key_length - 1]--;
+		BOOST_TEST(BTR_find_leaf(bucket, &key, nullptr, nullptr, true, 0) == leaf.nodes[n]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FindChildTest)
+{
+	constexpr unsigned COUNT = 400;
+	IndexPage upper(COUNT, false, 1);
+	btree_page* const bucket = upper.page();
+	const index_desc idx = makeIndex();
+
+	BOOST_TEST(bucket->btr_jump_count > 0);
+
+	temporary_key key;
+
+	// Key less than any but the degenerate node
+	makeKey(1, key);
+	key.key_data[key.key_length - 1]--;
+	BOOST_TEST(BTR_find_child(bucket, &key, &idx, 0) == childOf(0));
+	BOOST_TEST(BTR_find_child(bucket, &key, &idx, PAGE_SIZE) == childOf(0));
+
+	for (unsigned n = 1; n < COUNT; n++)
+	{
+		makeNextKey(n, key);
+		BOOST_TEST(BTR_find_child(bucket, &key, &idx, 0) == childOf(n));
+
+		// Checked search of a consistent page gives the same result
+		BOOST_TEST(BTR_find_child(bucket, &key, &idx, PAGE_SIZE) == childOf(n));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FindChildTruncatedTest)
+{
+	constexpr unsigned COUNT = 400;
+	IndexPage upper(COUNT, false, 1);
+	const index_desc idx = makeIndex();
+	const ULONG length = upper.page()->btr_length;
+
+	temporary_key key;
+
+	// Page header claims more than can be read
+	const ULONG headerSize = FB_ALIGN((ULONG) BTR_SIZE, 8);
+
+	for (const ULONG size : {headerSize, headerSize + 16, length / 8 * 4, length / 8 * 8})
+	{
+		GuardedPage guarded(upper.page(), size);
+		unsigned found = 0;
+
+		for (unsigned n = 1; n < COUNT; n++)
+		{
+			makeNextKey(n, key);
+			const ULONG child = BTR_find_child(guarded.page(), &key, &idx, size);
+
+			BOOST_TEST_INFO("size " << size << ", key " << n);
+			BOOST_TEST((child == childOf(n) || child == END_LEVEL));
+
+			found += (child == childOf(n));
+		}
+
+		// Nodes past the readable part are never reached
+		makeNextKey(COUNT - 1, key);
+		BOOST_TEST(BTR_find_child(guarded.page(), &key, &idx, size) == END_LEVEL);
+
+		if (size > length / 2)
+			BOOST_TEST(found > 0u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FindChildCorruptedTest)
+{
+	constexpr unsigned COUNT = 400;
+	IndexPage upper(COUNT, false, 1);
+	const index_desc idx = makeIndex();
+
+	temporary_key key;
+
+	// Page length larger than the page, the search stays within the page
+	{
+		GuardedPage guarded(upper.page(), PAGE_SIZE);
+		guarded.page()->btr_length = MAX_USHORT;
+
+		for (unsigned n = 1; n < COUNT; n++)
+		{
+			makeNextKey(n, key);
+			BOOST_TEST(BTR_find_child(guarded.page(), &key, &idx, PAGE_SIZE) == childOf(n));
+		}
+	}
+
+	// Jump table beyond the page
+	{
+		GuardedPage guarded(upper.page(), PAGE_SIZE);
+		guarded.page()->btr_jump_size = PAGE_SIZE - 8;
+
+		for (unsigned n = 1; n < COUNT; n += 7)
+		{
+			makeNextKey(n, key);
+			BOOST_TEST(BTR_find_child(guarded.page(), &key, &idx, PAGE_SIZE) == END_LEVEL);
+		}
+	}
+
+	// Jump node pointing past the end of the page, the first one is read by every search
+	{
+		GuardedPage guarded(upper.page(), PAGE_SIZE);
+
+		IndexJumpNode jumpNode;
+		jumpNode.readJumpNode(guarded.page()->btr_nodes);
+		jumpNode.offset = PAGE_SIZE - 4;
+		jumpNode.writeJumpNode(guarded.page()->btr_nodes);
+
+		for (unsigned n = 1; n < COUNT; n += 7)
+		{
+			makeNextKey(n, key);
+			BOOST_TEST(BTR_find_child(guarded.page(), &key, &idx, PAGE_SIZE) == END_LEVEL);
+		}
+	}
+
+	// Last node with data running past the end of the page instead of the end of level marker
+	{
+		GuardedPage guarded(upper.page(), PAGE_SIZE);
+		const FB_SIZE_T endOffset = upper.nodes.back() - upper.buffer;
+
+		// Only the node header is put on the page
+		static UCHAR scratch[0x4000 + 16];
+		IndexNode node;
+		node.setNode(0, 0x3FFF, RecordNumber(1), childOf(COUNT));
+		node.data = scratch;
+		const FB_SIZE_T headerSize = node.writeNode(scratch, false) - scratch - node.length;
+		memcpy((UCHAR*) guarded.page() + endOffset, scratch, headerSize);
+
+		makeNextKey(COUNT - 1, key);
+		BOOST_TEST(BTR_find_child(guarded.page(), &key, &idx, PAGE_SIZE) == END_LEVEL);
+
+		makeNextKey(1, key);
+		BOOST_TEST(BTR_find_child(guarded.page(), &key, &idx, PAGE_SIZE) == childOf(1));
+	}
+
+	// Random damage may give any page number, but never a read outside the page
+	ULONG seed = 12345;
+
+	for (unsigned round = 0; round < 1000; round++)
+	{
+		GuardedPage guarded(upper.page(), PAGE_SIZE);
+		UCHAR* const area = (UCHAR*) guarded.page();
+
+		for (unsigned i = 0; i < 4; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			area[(seed >> 8) % upper.page()->btr_length] ^= (UCHAR) (seed >> 24) | 1;
+		}
+
+		for (unsigned n = 1; n < COUNT; n += 37)
+		{
+			makeNextKey(n, key);
+			BTR_find_child(guarded.page(), &key, &idx, PAGE_SIZE);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// BtrTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BtrSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,116 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../dsql/BoolNodes.h"
+#include "../dsql/pass1_proto.h"
+#include "../jrd/RecordSourceNodes.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(Pass1Suite)
+
+
+BOOST_AUTO_TEST_SUITE(CteReferencesTests)
+
+// HELPERS
+// --------
+
+// SELECT ... FROM <sources>
+RseNode* makeQuery(std::initializer_list<RecordSourceNode*> sources)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const auto rse = FB_NEW_POOL(pool) RseNode(pool);
+	rse->dsqlFrom = FB_NEW_POOL(pool) RecSourceListNode(pool, 0u);
+
+	for (const auto source : sources)
+		rse->dsqlFrom->add(source);
+
+	return rse;
+}
+
+RelationSourceNode* makeTable(const char* name, const char* schema = "")
+{
+	auto& pool = *getDefaultMemoryPool();
+	return FB_NEW_POOL(pool) RelationSourceNode(pool, QualifiedName(name, schema));
+}
+
+// WITH <name> AS (SELECT ... FROM T) <query>
+SelectExprNode* makeWith(const char* name, RecordSourceNode* query)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const auto cte = FB_NEW_POOL(pool) SelectExprNode(pool);
+	cte->alias = name;
+	cte->querySpec = makeQuery({makeTable("T")});
+
+	const auto select = FB_NEW_POOL(pool) SelectExprNode(pool);
+	select->withClause = FB_NEW_POOL(pool) WithClause(pool);
+	select->withClause->add(cte);
+	select->querySpec = query;
+
+	return select;
+}
+
+
+// TESTS
+// --------
+
+BOOST_AUTO_TEST_CASE(FromClauseTest)
+{
+	BOOST_TEST(PASS1_cte_references(makeWith("C", makeQuery({makeTable("C")})), "C") == 1u);
+	BOOST_TEST(PASS1_cte_references(makeWith("C", makeQuery({makeTable("C"), makeTable("C")})), "C") == 2u);
+	BOOST_TEST(PASS1_cte_references(makeWith("C", makeQuery({makeTable("C"), makeTable("D")})), "D") == 1u);
+	BOOST_TEST(PASS1_cte_references(makeWith("C", makeQuery({makeTable("T")})), "C") == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(QualifiedNameTest)
+{
+	// Schema qualified name refers to a table, not to the CTE
+	BOOST_TEST(PASS1_cte_references(
+		makeWith("C", makeQuery({makeTable("C"), makeTable("C", "PUBLIC")})), "C") == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(SubQueryTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	// SELECT ... FROM C WHERE EXISTS (SELECT ... FROM C)
+	const auto query = makeQuery({makeTable("C")});
+	query->dsqlWhere = FB_NEW_POOL(pool) RseBoolNode(pool, blr_any, makeQuery({makeTable("C")}));
+
+	BOOST_TEST(PASS1_cte_references(makeWith("C", query), "C") == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(UnionTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	// SELECT ... FROM C UNION ALL SELECT ... FROM C
+	const auto unionNode = FB_NEW_POOL(pool) UnionSourceNode(pool);
+	unionNode->dsqlClauses = FB_NEW_POOL(pool) RecSourceListNode(pool, 0u);
+	unionNode->dsqlClauses->add(makeQuery({makeTable("C")}));
+	unionNode->dsqlClauses->add(makeQuery({makeTable("C")}));
+
+	BOOST_TEST(PASS1_cte_references(makeWith("C", unionNode), "C") == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(NestedWithTest)
+{
+	// Both references are made to the nested CTE having the same name
+	const auto nested = makeWith("C", makeQuery({makeTable("C"), makeTable("C")}));
+
+	BOOST_TEST(PASS1_cte_references(makeWith("C", makeQuery({nested})), "C") == 0u);
+
+	// References from the nested query to an outer CTE are counted
+	const auto other = makeWith("D", makeQuery({makeTable("C"), makeTable("D")}));
+
+	BOOST_TEST(PASS1_cte_references(makeWith("C", makeQuery({makeTable("C"), other})), "C") == 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// CteReferencesTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// Pass1Suite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,100 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/Database.h"
+#include <vector>
+
+using namespace Firebird;
+using namespace Jrd;
+
+namespace
+{
+	typedef Database::CachedGenerator Block;
+
+	// Values handed out by a sequence with the generator page at last,
+	// reserving a new block whenever the current one is exhausted
+	std::vector<SINT64> takeValues(SINT64& last, SLONG step, SLONG cache, unsigned count)
+	{
+		std::vector<SINT64> values;
+		Block block;
+		block.left = 0;
+		block.step = step;
+
+		while (values.size() < count)
+		{
+			SINT64 value;
+
+			if (!block.next(step, value))
+			{
+				last += (SINT64) step * cache;
+				block = Block::reserve(last, step, cache);
+				value = block.value;
+			}
+
+			values.push_back(value);
+		}
+
+		return values;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(GenCacheSuite)
+
+
+BOOST_AUTO_TEST_SUITE(GenCacheTests)
+
+BOOST_AUTO_TEST_CASE(SequenceTest)
+{
+	// Cached sequence hands out the same values as the uncached one
+	for (const SLONG step : {1, 3, -2})
+	{
+		for (const SLONG cache : {2, 5, 20})
+		{
+			SINT64 last = 10;
+			const auto values = takeValues(last, step, cache, 47);
+
+			BOOST_TEST_INFO("step " << step << ", cache " << cache);
+			BOOST_TEST_REQUIRE(values.size() == 47u);
+
+			for (unsigned i = 0; i < values.size(); i++)
+				BOOST_TEST(values[i] == 10 + (SINT64) step * (i + 1));
+
+			// Generator page is ahead by the rest of the last block only
+			BOOST_TEST(last == values.back() + (SINT64) step * ((cache - 47 % cache) % cache));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BlockTest)
+{
+	auto block = Block::reserve(100, 10, 5);
+	BOOST_TEST(block.value == 60);
+	BOOST_TEST(block.left == 4);
+
+	SINT64 value = 0;
+
+	// Block reserved with another increment isn't used
+	BOOST_TEST(!block.next(5, value));
+	BOOST_TEST(value == 0);
+
+	for (SINT64 expected = 70; expected <= 100; expected += 10)
+	{
+		BOOST_TEST(block.next(10, value));
+		BOOST_TEST(value == expected);
+	}
+
+	BOOST_TEST(!block.next(10, value));
+	BOOST_TEST(block.left == 0);
+
+	// Single value block
+	block = Block::reserve(-7, -1, 1);
+	BOOST_TEST(block.value == -7);
+	BOOST_TEST(!block.next(-1, value));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// GenCacheTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// GenCacheSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
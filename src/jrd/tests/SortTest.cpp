@@ -0,0 +1,362 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/sort.h"
+#include "../jrd/recsrc/RecordSource.h"
+#include "../common/config/config.h"
+#include "../common/config/config_file.h"
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <vector>
+
+using namespace Firebird;
+using namespace Jrd;
+
+namespace
+{
+	struct Row
+	{
+		ULONG key;
+		ULONG id;		// position of the row in the input
+	};
+
+	// Keys with a lot of duplicates, in a reproducible order
+	std::vector<ULONG> makeKeys(unsigned count, unsigned distinct)
+	{
+		std::vector<ULONG> keys;
+		ULONG seed = 12345;
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			keys.push_back((seed >> 8) % distinct);
+		}
+
+		return keys;
+	}
+
+	std::vector<ULONG> expectedKeys(std::vector<ULONG> keys, bool descending)
+	{
+		if (descending)
+			std::sort(keys.begin(), keys.end(), std::greater<ULONG>());
+		else
+			std::sort(keys.begin(), keys.end());
+
+		return keys;
+	}
+
+	// Pass rows through the sort and read back all it returns
+	std::vector<Row> sortRows(const std::vector<ULONG>& keys, bool descending, FB_UINT64 maxRecords)
+	{
+		thread_db* const tdbb = JRD_get_thread_data();
+		SortOwner owner(*getDefaultMemoryPool(), tdbb->getDatabase());
+
+		sort_key_def key;
+		key.setSkdLength(SKD_ulong, sizeof(ULONG));
+		key.skd_flags = descending ? SKD_descending : SKD_ascending;
+		key.setSkdOffset();
+		key.skd_vary_offset = 0;
+
+		// The sort is owned and deleted by the owner
+		Sort* const sort = FB_NEW_POOL(owner.getPool())
+			Sort(tdbb->getDatabase(), &owner, sizeof(Row), 1, 1, &key, nullptr, nullptr, maxRecords);
+
+		for (ULONG i = 0; i < keys.size(); i++)
+		{
+			ULONG* data;
+			sort->put(tdbb, &data);
+
+			const Row row = {keys[i], i};
+			memcpy(data, &row, sizeof(row));
+		}
+
+		sort->sort(tdbb);
+
+		std::vector<Row> rows;
+
+		while (true)
+		{
+			ULONG* data;
+			sort->get(tdbb, &data);
+
+			if (!data)
+				break;
+
+			Row row;
+			memcpy(&row, data, sizeof(row));
+			rows.push_back(row);
+		}
+
+		return rows;
+	}
+
+	// Rows must be the given slice of the expected order, every input row at most once
+	void checkRows(const std::vector<Row>& rows, const std::vector<ULONG>& keys,
+		const std::vector<ULONG>& expected, size_t skip, size_t first)
+	{
+		const size_t end = std::min(skip + first, expected.size());
+		BOOST_TEST_REQUIRE(rows.size() >= end);
+
+		std::set<ULONG> ids;
+
+		for (size_t i = 0; i < end; i++)
+		{
+			BOOST_TEST_REQUIRE(rows[i].id < keys.size());
+			BOOST_TEST(rows[i].key == keys[rows[i].id]);
+			BOOST_TEST(ids.insert(rows[i].id).second);
+
+			if (i >= skip)
+				BOOST_TEST(rows[i].key == expected[i]);
+		}
+	}
+
+	class SortContext
+	{
+	public:
+		SortContext()
+		{
+			Database* const dbb = Database::create(nullptr, false);
+			dbb->dbb_config = FB_NEW Config(ConfigFile(ConfigFile::USE_TEXT, "\n"));
+			context->setDatabase(dbb);
+		}
+
+		~SortContext()
+		{
+			Database::destroy(context->getDatabase());
+		}
+
+	private:
+		ThreadContextHolder context;
+	};
+
+	// Records with small keys and zero padding compress well, random bytes don't
+	std::vector<UCHAR> makeRunData(size_t length, bool random)
+	{
+		std::vector<UCHAR> data(length);
+		ULONG seed = 54321;
+
+		for (size_t i = 0; i < length; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+
+			if (random)
+				data[i] = (UCHAR) (seed >> 16);
+			else if (i % 16 < 2)
+				data[i] = (UCHAR) ((seed >> 16) % 10);
+		}
+
+		return data;
+	}
+
+	// Temporary space kept in files only
+	class FileSpace : public TempSpace
+	{
+	public:
+		FileSpace()
+			: TempSpace(*getDefaultMemoryPool(), "fb_sort_", false)
+		{
+			setCacheLimit(0);
+		}
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(SortSuite)
+
+
+BOOST_AUTO_TEST_SUITE(SortTests)
+
+BOOST_FIXTURE_TEST_CASE(TopTest, SortContext)
+{
+	const auto keys = makeKeys(100000, 1000);
+
+	for (const bool descending : {false, true})
+	{
+		const auto expected = expectedKeys(keys, descending);
+
+		for (const unsigned count : {1u, 2u, 10u, 100u, 1000u})
+		{
+			const auto rows = sortRows(keys, descending, count);
+
+			BOOST_TEST_INFO("descending " << descending << ", first " << count);
+			BOOST_TEST(rows.size() == count);
+			checkRows(rows, keys, expected, 0, count);
+		}
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(TopTiesTest, SortContext)
+{
+	// Many rows have the same key as the last one kept
+
+	const auto keys = makeKeys(10000, 3);
+
+	for (const bool descending : {false, true})
+	{
+		const auto expected = expectedKeys(keys, descending);
+		const auto rows = sortRows(keys, descending, 50);
+
+		BOOST_TEST(rows.size() == 50u);
+		checkRows(rows, keys, expected, 0, 50);
+	}
+
+	// All keys are equal
+
+	const std::vector<ULONG> equal(1000, 7);
+	const auto rows = sortRows(equal, false, 10);
+
+	BOOST_TEST(rows.size() == 10u);
+	checkRows(rows, equal, equal, 0, 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(TopLimitOffsetTest, SortContext)
+{
+	const auto keys = makeKeys(20000, 500);
+
+	const struct
+	{
+		SINT64 first;
+		SINT64 skip;
+	} limits[] = {
+		{1, 0}, {10, 5}, {5, 100}, {100, 19950}, {1, 19999},	// within the input
+		{10, 19995}, {100, 30000}, {30000, 0},					// beyond the input
+		{30000, 30000}											// too many to keep in the top-N heap
+	};
+
+	for (const bool descending : {false, true})
+	{
+		const auto expected = expectedKeys(keys, descending);
+
+		for (const auto& limit : limits)
+		{
+			const FB_UINT64 count = SortedStream::getLimit(limit.first, limit.skip);
+			const auto rows = sortRows(keys, descending, count);
+
+			BOOST_TEST_INFO("descending " << descending << ", first " << limit.first << ", skip " << limit.skip);
+			BOOST_TEST(rows.size() == std::min<FB_UINT64>(count, keys.size()));
+			checkRows(rows, keys, expected, (size_t) limit.skip, (size_t) limit.first);
+		}
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(UnlimitedTest, SortContext)
+{
+	// Regular sort, spilled to runs
+	const auto keys = makeKeys(100000, 1000);
+
+	for (const bool descending : {false, true})
+	{
+		const auto rows = sortRows(keys, descending, 0);
+
+		BOOST_TEST(rows.size() == keys.size());
+		checkRows(rows, keys, expectedKeys(keys, descending), 0, keys.size());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(GetLimitTest)
+{
+	BOOST_TEST(SortedStream::getLimit(10, 0) == 10u);
+	BOOST_TEST(SortedStream::getLimit(10, 5) == 15u);
+	BOOST_TEST(SortedStream::getLimit(MAX_SINT64, 0) == (FB_UINT64) MAX_SINT64);
+	BOOST_TEST(SortedStream::getLimit(MAX_SINT64 - 5, 5) == (FB_UINT64) MAX_SINT64);
+
+	// Invalid or overflowing values don't limit the sort
+	BOOST_TEST(SortedStream::getLimit(0, 0) == 0u);
+	BOOST_TEST(SortedStream::getLimit(0, 5) == 0u);
+	BOOST_TEST(SortedStream::getLimit(-1, 0) == 0u);
+	BOOST_TEST(SortedStream::getLimit(10, -1) == 0u);
+	BOOST_TEST(SortedStream::getLimit(MAX_SINT64, 1) == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SortTests
+
+
+BOOST_AUTO_TEST_SUITE(PackedRunTests)
+
+BOOST_FIXTURE_TEST_CASE(RoundTripTest, SortContext)
+{
+	if (!PackedRun::isSupported())
+		return;
+
+	for (const bool random : {false, true})
+	{
+		BOOST_TEST_INFO("random " << random);
+
+		const auto data = makeRunData(1000000, random);
+
+		FileSpace space;
+		PackedRun run(*getDefaultMemoryPool(), &space);
+
+		// Write and read back by portions of different sizes
+
+		for (size_t pos = 0; pos < data.size(); pos += 10000)
+			run.write(data.data() + pos, (ULONG) std::min<size_t>(10000, data.size() - pos));
+
+		run.flush();
+
+		BOOST_TEST(run.getSize() > 0u);
+		if (!random)
+			BOOST_TEST(run.getSize() < data.size() / 4);
+
+		std::vector<UCHAR> result(data.size());
+
+		for (size_t pos = 0; pos < result.size(); pos += 3333)
+			run.read(result.data() + pos, (ULONG) std::min<size_t>(3333, result.size() - pos));
+
+		BOOST_TEST((result == data));
+
+		// All the chunks are returned to the space
+
+		run.release();
+
+		offset_t free = 0;
+		BOOST_TEST(space.validate(free));
+		BOOST_TEST(free == space.getSize());
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(EndOfRunTest, SortContext)
+{
+	if (!PackedRun::isSupported())
+		return;
+
+	const auto data = makeRunData(1000, false);
+
+	FileSpace space;
+	PackedRun run(*getDefaultMemoryPool(), &space);
+
+	run.write(data.data(), (ULONG) data.size());
+	run.flush();
+
+	std::vector<UCHAR> result(data.size() + 1);
+	run.read(result.data(), (ULONG) data.size());
+	BOOST_TEST(memcmp(result.data(), data.data(), data.size()) == 0);
+
+	// Nothing may be read past the end of the run
+	BOOST_CHECK_THROW(run.read(result.data(), 1), status_exception);
+
+	run.release();
+}
+
+BOOST_FIXTURE_TEST_CASE(EmptyRunTest, SortContext)
+{
+	if (!PackedRun::isSupported())
+		return;
+
+	FileSpace space;
+	PackedRun run(*getDefaultMemoryPool(), &space);
+
+	run.flush();
+	BOOST_TEST(run.getSize() > 0u);
+
+	run.release();
+	BOOST_TEST(run.getSize() == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// PackedRunTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SortSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,72 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/TempSpace.h"
+
+using namespace Firebird;
+
+namespace
+{
+	typedef RefPtr<TempCacheQuota> QuotaPtr;
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(TempCacheQuotaSuite)
+
+
+BOOST_AUTO_TEST_SUITE(TempCacheQuotaTests)
+
+BOOST_AUTO_TEST_CASE(ChainTest)
+{
+	const QuotaPtr attachment(FB_NEW TempCacheQuota(1000));
+	const QuotaPtr statement1(FB_NEW TempCacheQuota(600, attachment));
+	const QuotaPtr statement2(FB_NEW TempCacheQuota(0, attachment));
+
+	BOOST_TEST(statement1->allocate(500));
+	BOOST_TEST(!statement1->allocate(200));
+	BOOST_TEST(statement1->getUsage() == 500u);
+
+	// Unlimited statement is still limited by the attachment
+	BOOST_TEST(statement2->allocate(400));
+	BOOST_TEST(!statement2->allocate(200));
+	BOOST_TEST(statement2->getUsage() == 400u);
+	BOOST_TEST(attachment->getUsage() == 900u);
+
+	statement1->deallocate(500);
+	BOOST_TEST(statement2->allocate(200));
+	BOOST_TEST(attachment->getUsage() == 600u);
+
+	statement2->deallocate(600);
+	BOOST_TEST(attachment->getUsage() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SpillsTest)
+{
+	const QuotaPtr attachment(FB_NEW TempCacheQuota(0));
+	const QuotaPtr statement(FB_NEW TempCacheQuota(100, attachment));
+
+	BOOST_TEST(statement->allocate(100));
+	statement->addSpill();
+	statement->addSpill();
+	BOOST_TEST(statement->getSpills() == 2u);
+	BOOST_TEST(attachment->getSpills() == 2u);
+
+	// Next execution counts its own spills, the memory still cached and
+	// the attachment counter are kept
+	statement->resetSpills();
+	BOOST_TEST(statement->getSpills() == 0u);
+	BOOST_TEST(statement->getUsage() == 100u);
+	BOOST_TEST(attachment->getSpills() == 2u);
+
+	statement->addSpill();
+	BOOST_TEST(statement->getSpills() == 1u);
+	BOOST_TEST(attachment->getSpills() == 3u);
+
+	statement->deallocate(100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// TempCacheQuotaTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// TempCacheQuotaSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -3905,6 +3905,21 @@ TimeZoneSnapshot* jrd_tra::getTimeZoneSnapshot(thread_db* tdbb)
 }
 
 
+TempSpace* jrd_tra::getUndoSpace()
+{
+	if (!tra_undo_space)
+	{
+		tra_undo_space = FB_NEW_POOL(*tra_pool) TempSpace(*tra_pool, TRA_UNDO_SPACE);
+
+		// Keep a huge undo log from eating up the temporary cache of the database
+		const Database* const dbb = tra_attachment->att_database;
+		tra_undo_space->setCacheLimit(dbb->dbb_config->getUndoCacheLimit());
+	}
+
+	return tra_undo_space;
+}
+
+
 UserManagement* jrd_tra::getUserManagement()
 {
 	if (!tra_user_management)
@@ -360,15 +360,7 @@ public:
 		return tra_blob_space;
 	}
 
-	TempSpace* getUndoSpace()
-	{
-		if (!tra_undo_space)
-		{
-			tra_undo_space = FB_NEW_POOL(*tra_pool) TempSpace(*tra_pool, TRA_UNDO_SPACE);
-		}
-
-		return tra_undo_space;
-	}
+	TempSpace* getUndoSpace();
 
 	Record* getUndoRecord(const Format* format)
 	{
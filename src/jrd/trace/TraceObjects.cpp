@@ -125,7 +125,7 @@ const char* StatementHolder::ensurePlan(bool explained)
 	if (m_statement && (m_plan.isEmpty() || m_planExplained != explained))
 	{
 		m_planExplained = explained;
-		m_plan = Optimizer::getPlan(JRD_get_thread_data(), m_statement, explained);
+		m_plan = Optimizer::getPlan(JRD_get_thread_data(), m_statement, explained, m_request);
 	}
 
 	return m_plan.c_str();
@@ -644,6 +644,13 @@ const char* TraceServiceImpl::getRemoteProcessName()
 
 /// TraceRuntimeStats
 
+static_assert(IPerformanceCounters::WAIT_LATCHES == static_cast<unsigned>(WaitStatType::LATCH_WAITS) &&
+			  IPerformanceCounters::WAIT_LOCKS == static_cast<unsigned>(WaitStatType::LOCK_WAITS) &&
+			  IPerformanceCounters::WAIT_PAGE_READS == static_cast<unsigned>(WaitStatType::PAGE_READS) &&
+			  IPerformanceCounters::WAIT_PAGE_WRITES == static_cast<unsigned>(WaitStatType::PAGE_WRITES) &&
+			  IPerformanceCounters::WAIT_SORT_IO == static_cast<unsigned>(WaitStatType::SORT_IO),
+			  "Wait counters mismatch");
+
 TraceRuntimeStats::TraceRuntimeStats(Attachment* attachment,
 									 RuntimeStatistics* baseline, RuntimeStatistics* stats,
 									 SINT64 clock, SINT64 recordsFetched)
@@ -679,6 +686,7 @@ TraceRuntimeStats::TraceRuntimeStats(Attachment* attachment,
 		};
 
 		m_tableCounters.reset(&baseline->getTableCounters(), getTableName);
+		m_waitCounters.reset(baseline);
 
 		m_legacyCounts.resize(m_tableCounters.getObjectCount());
 		m_info.pin_tables = m_legacyCounts.begin();
@@ -62,6 +62,11 @@ public:
 		: m_statement(statement)
 	{}
 
+	// The request is used to report actual row counts in the explained plan
+	StatementHolder(const Statement* statement, const Request* request)
+		: m_statement(statement), m_request(request)
+	{}
+
 	explicit StatementHolder(const Request* request)
 		: m_statement(request ? request->getStatement() : nullptr)
 	{}
@@ -76,6 +81,7 @@ public:
 
 private:
 	const Statement* const m_statement;
+	const Request* const m_request = nullptr;
 	Firebird::string m_plan;
 	bool m_planExplained = false;
 };
@@ -152,6 +158,60 @@ class TraceRuntimeStats :
 	typedef GenericCounters<RuntimeStatistics::PageCounters> PageCounters;
 	typedef GenericCounters<RuntimeStatistics::TableCounters> TableCounters;
 
+	// Wait times are not grouped, so they're reported as a single unnamed object
+	class WaitCounters :
+		public Firebird::AutoIface<Firebird::IPerformanceCountersImpl<WaitCounters, Firebird::CheckStatusWrapper> >
+	{
+	public:
+		static constexpr unsigned WAIT_COUNTERS = static_cast<unsigned>(WaitStatType::TOTAL_ITEMS);
+
+		WaitCounters() = default;
+		~WaitCounters() = default;
+
+		void reset(const RuntimeStatistics* stats)
+		{
+			m_present = false;
+
+			for (unsigned i = 0; i < WAIT_COUNTERS; i++)
+			{
+				m_counters[i] = stats ? (*stats)[static_cast<WaitStatType>(i)] : 0;
+
+				if (m_counters[i])
+					m_present = true;
+			}
+		}
+
+		// PerformanceCounts implementation
+		unsigned getObjectCount()
+		{
+			return m_present ? 1 : 0;
+		}
+
+		unsigned getMaxCounterIndex()
+		{
+			return WAIT_COUNTERS - 1;
+		}
+
+		unsigned getObjectId(unsigned index)
+		{
+			return 0;
+		}
+
+		const char* getObjectName(unsigned index)
+		{
+			return nullptr;
+		}
+
+		const SINT64* getObjectCounters(unsigned index)
+		{
+			return (m_present && !index) ? m_counters : nullptr;
+		}
+
+	private:
+		SINT64 m_counters[WAIT_COUNTERS] = {};
+		bool m_present = false;
+	};
+
 public:
 	TraceRuntimeStats(Attachment* att, RuntimeStatistics* baseline, RuntimeStatistics* stats,
 		SINT64 clock, SINT64 recordsFetched);
@@ -181,6 +241,10 @@ public:
 				counters = &m_tableCounters;
 				break;
 
+			case IPerformanceStats::COUNTER_GROUP_WAITS:
+				counters = &m_waitCounters;
+				break;
+
 			default:
 				fb_assert(false);
 		}
@@ -197,6 +261,7 @@ private:
 	Firebird::PerformanceInfo m_info;
 	PageCounters m_pageCounters;
 	TableCounters m_tableCounters;
+	WaitCounters m_waitCounters;
 	SINT64 m_globalCounters[GLOBAL_COUNTERS];
 	Firebird::HalfStaticArray<Firebird::TraceCounts, 16> m_legacyCounts;
 };
@@ -362,7 +427,8 @@ class TraceSQLStatementImpl :
 {
 public:
 	TraceSQLStatementImpl(DsqlRequest* stmt, TraceRuntimeStats* stats, const UCHAR* inputBuffer) :
-		StatementHolder(stmt ? stmt->getStatement() : nullptr),
+		StatementHolder(stmt ? stmt->getStatement() : nullptr,
+			(stmt && stats) ? stmt->getRequest() : nullptr),
 		m_stmt(stmt),
 		m_inputs(stmt, inputBuffer),
 		m_stats(stats)
@@ -716,7 +716,13 @@ inline void check_gbak_cheating_delete(thread_db* tdbb, const jrd_rel* relation)
 inline int wait(thread_db* tdbb, jrd_tra* transaction, const record_param* rpb, bool probe)
 {
 	if (!probe && transaction->getLockWait())
-		tdbb->bumpStats(RecordStatType::WAITS, rpb->rpb_relation->getId());
+	{
+		const auto relId = rpb->rpb_relation->getId();
+		tdbb->bumpStats(RecordStatType::WAITS, relId);
+
+		RuntimeStatistics::Timer timer(tdbb, RecordStatType::WAIT_TIME, relId);
+		return TRA_wait(tdbb, transaction, rpb->rpb_transaction_nr, tra_wait);
+	}
 
 	return TRA_wait(tdbb, transaction, rpb->rpb_transaction_nr,
 		probe ? tra_probe : tra_wait);
@@ -2608,6 +2614,8 @@ void VIO_intermediate_gc(thread_db* tdbb, record_param* rpb, jrd_tra* transactio
 	Database *dbb = tdbb->getDatabase();
 	Attachment* att = tdbb->getAttachment();
 
+	RuntimeStatistics::Timer timer(tdbb, RecordStatType::GC_TIME, rpb->rpb_relation->getId());
+
 	// If current record is not a primary version, release it and fetch primary version
 	if (rpb->rpb_flags & rpb_chained)
 	{
@@ -5615,6 +5623,7 @@ static void garbage_collect(thread_db* tdbb, record_param* rpb, ULONG prior_page
 		rpb->rpb_f_page, rpb->rpb_f_line);
 #endif
 
+	RuntimeStatistics::Timer timer(tdbb, RecordStatType::GC_TIME, rpb->rpb_relation->getId());
 	RuntimeStatistics::Accumulator backversions(tdbb, rpb->rpb_relation, RecordStatType::BACK_READS);
 
 	// Delete old versions fetching data for garbage collection.
@@ -55,6 +55,7 @@
 #include "../common/classes/init.h"
 #include "../common/classes/timestamp.h"
 #include "../common/os/os_utils.h"
+#include "../common/utils_proto.h"
 
 #include <stdio.h>
 #include <errno.h>
@@ -3762,6 +3763,8 @@ void LockManager::wait_for_request(const Callbacks& callbacks, lrq* request, SSH
  **************************************/
 	ASSERT_ACQUIRED;
 
+	const SINT64 wait_start = fb_utils::query_performance_counter();
+
 	++(m_sharedMemory->getHeader()->lhb_waits);
 	const ULONG scan_interval = m_sharedMemory->getHeader()->lhb_scan_interval;
 
@@ -4023,6 +4026,8 @@ void LockManager::wait_for_request(const Callbacks& callbacks, lrq* request, SSH
 
 	request->lrq_flags &= ~LRQ_wait_timeout;
 	owner->own_waits--;
+
+	callbacks.waitCompleted(fb_utils::query_performance_counter() - wait_start);
 }
 
 void LockManager::mutexBug(int state, char const* text)
@@ -301,6 +301,7 @@ public:
 		virtual ISC_STATUS getCancelState() const = 0;
 		virtual ULONG adjustWait(ULONG wait) const = 0;
 		virtual void checkoutRun(std::function<void()> func) const = 0;
+		virtual void waitCompleted(SINT64 /*ticks*/) const {}
 	};
 
 private:
@@ -83,9 +83,9 @@
 #include <process.h>
 #endif
 
-#if defined(WIN_NT)
+#if defined(WIN_NT) || defined(LINUX)
 #include "../common/isc_proto.h"
-#include "../remote/os/win32/xnet_proto.h"
+#include "../remote/xnet_proto.h"
 #endif
 
 
@@ -93,7 +93,7 @@ const char* const PROTOCOL_INET = "inet";
 const char* const PROTOCOL_INET4 = "inet4";
 const char* const PROTOCOL_INET6 = "inet6";
 
-#ifdef WIN_NT
+#if defined(WIN_NT) || defined(LINUX)
 const char* const PROTOCOL_XNET = "xnet";
 #endif
 
@@ -7915,7 +7915,7 @@ static rem_port* analyze(ClntAuthBlock& cBlock, PathName& attach_name, unsigned
 
 		try
 		{
-#ifdef WIN_NT
+#if defined(WIN_NT) || defined(LINUX)
 			if (ISC_analyze_protocol(PROTOCOL_XNET, attach_name, node_name, NULL, needFile))
 				port = XNET_analyze(&cBlock, attach_name, flags & ANALYZE_USER_VFY, cBlock.getConfig(), ref_db_name);
 			else
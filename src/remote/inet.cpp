@@ -88,6 +88,7 @@
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
 
 #if defined(HAVE_POLL_H)
 #include <poll.h>
@@ -99,6 +100,10 @@
 
 constexpr int INET_RETRY_CALL = 5;
 
+// Payloads that large bypass the port buffer: they're sent from
+// and received into the caller's memory without intermediate copying
+constexpr unsigned INET_DIRECT_SIZE = 4096;
+
 #include "../remote/remote.h"
 #include "../remote/SockAddr.h"
 #include "ibase.h"
@@ -544,6 +549,7 @@ static void		get_peer_info(rem_port*);
 static void		inet_gen_error(bool, rem_port*, const Arg::StatusVector& v);
 static void		inet_error(bool, rem_port*, const TEXT*, ISC_STATUS, int);
 static bool		inet_read(RemoteXdr*);
+static bool		inet_read_direct(RemoteXdr*, SCHAR*, unsigned);
 static rem_port*		inet_try_connect(	PACKET*,
 									Rdb*,
 									const PathName&,
@@ -553,6 +559,9 @@ static rem_port*		inet_try_connect(	PACKET*,
 									const PathName*,
 									int);
 static bool		inet_write(RemoteXdr*);
+#ifndef WIN_NT
+static bool		inet_write_direct(RemoteXdr*, const SCHAR*, unsigned);
+#endif
 static rem_port* listener_socket(rem_port* port, USHORT flag, const addrinfo* pai);
 
 #ifdef DEBUG
@@ -562,6 +571,9 @@ static void packet_print(const TEXT*, const UCHAR*, int, ULONG);
 static bool		packet_receive(rem_port*, UCHAR*, SSHORT, SSHORT*);
 static bool		packet_receive2(rem_port*, UCHAR*, SSHORT, SSHORT*);
 static bool		packet_send(rem_port*, const SCHAR*, SSHORT);
+#ifndef WIN_NT
+static bool		packet_send_vector(rem_port*, iovec*, int);
+#endif
 static rem_port*		receive(rem_port*, PACKET *);
 static rem_port*		select_accept(rem_port*);
 
@@ -2579,6 +2591,11 @@ bool_t InetXdr::x_getbytes(SCHAR* buff, unsigned bytecount)
 	if (x_public->port_flags & PORT_server)
 		return REMOTE_getbytes(this, buff, bytecount);
 
+	// Large payload that is not buffered yet is received in place.
+
+	if (bytecount >= INET_DIRECT_SIZE && bytecount > x_handy && !(x_public->port_flags & PORT_async))
+		return inet_read_direct(this, buff, bytecount);
+
 	// Use memcpy to optimize bulk transfers.
 
 	while (bytecount > sizeof(ISC_QUAD))
@@ -2706,6 +2723,25 @@ bool_t InetXdr::x_putbytes(const SCHAR* buff, unsigned bytecount)
  *
  **************************************/
 
+#ifndef WIN_NT
+	// Large payload that doesn't fit is sent in place along with
+	// the buffered data, unless the stream is compressed on the wire.
+
+	if (bytecount >= INET_DIRECT_SIZE && bytecount > x_handy)
+	{
+		const rem_port* const port = x_public;
+
+		if (!(port->port_flags & PORT_async)
+#ifdef WIRE_COMPRESS_SUPPORT
+			&& !(port->port_compressed && (port->port_flags & PORT_compressed))
+#endif
+			)
+		{
+			return inet_write_direct(this, buff, bytecount);
+		}
+	}
+#endif
+
 	// Use memcpy to optimize bulk transfers.
 
 	while (bytecount > sizeof(ISC_QUAD))
@@ -2798,6 +2834,46 @@ static bool inet_read( RemoteXdr* xdrs)
 	return true;
 }
 
+static bool inet_read_direct(RemoteXdr* xdrs, SCHAR* buff, unsigned bytecount)
+{
+/**************************************
+ *
+ *	i n e t _ r e a d _ d i r e c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take what's left in the buffer and then read
+ *	the rest of the data straight into the caller's
+ *	memory, without passing it through the buffer.
+ *
+ **************************************/
+	rem_port* port = xdrs->x_public;
+
+	if (xdrs->x_handy > 0)
+	{
+		memcpy(buff, xdrs->x_private, xdrs->x_handy);
+		buff += xdrs->x_handy;
+		bytecount -= xdrs->x_handy;
+	}
+
+	xdrs->x_handy = 0;
+	xdrs->x_private = xdrs->x_base;
+
+	while (bytecount)
+	{
+		SSHORT length = (SSHORT) MIN(bytecount, MAX_SSHORT);
+		port->port_z_data = false;
+		if (!REMOTE_inflate(port, packet_receive2, (UCHAR*) buff, length, &length))
+			return false;
+
+		buff += length;
+		bytecount -= length;
+	}
+
+	return true;
+}
+
 static bool packet_receive2(rem_port* port, UCHAR* p, SSHORT bufSize, SSHORT* length)
 {
 	*length = 0;
@@ -2920,6 +2996,72 @@ static bool inet_write(RemoteXdr* xdrs)
 
 }
 
+#ifndef WIN_NT
+static bool inet_write_direct(RemoteXdr* xdrs, const SCHAR* buff, unsigned bytecount)
+{
+/**************************************
+ *
+ *	i n e t _ w r i t e _ d i r e c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write the buffered data followed by the caller's
+ *	memory by a single call, without copying the
+ *	latter into the buffer.
+ *
+ *	Encrypted stream can't be sent from the caller's
+ *	memory, so both parts are encrypted one after
+ *	another into a single scratch buffer instead.
+ *
+ **************************************/
+	rem_port* port = xdrs->x_public;
+	const unsigned length = xdrs->x_private - xdrs->x_base;
+
+	port->bumpLogBytes(rem_port::SEND, length + bytecount);
+
+	iovec iov[2];
+	int count = 2;
+
+	iov[0].iov_base = xdrs->x_base;
+	iov[0].iov_len = length;
+	iov[1].iov_base = const_cast<SCHAR*>(buff);
+	iov[1].iov_len = bytecount;
+
+	HalfStaticArray<char, BUFFER_TINY> encrypted;
+	if (port->port_crypt_plugin && port->port_crypt_complete)
+	{
+		LocalStatus ls;
+		CheckStatusWrapper st(&ls);
+
+		char* const data = encrypted.getBuffer(length + bytecount);
+
+		if (length)
+			port->port_crypt_plugin->encrypt(&st, length, xdrs->x_base, data);
+
+		if (!(st.getState() & IStatus::STATE_ERRORS))
+			port->port_crypt_plugin->encrypt(&st, bytecount, buff, data + length);
+
+		if (st.getState() & IStatus::STATE_ERRORS)
+		{
+			status_exception::raise(&st);
+		}
+
+		iov[0].iov_base = data;
+		iov[0].iov_len = length + bytecount;
+		count = 1;
+	}
+
+	if (!packet_send_vector(port, iov, count))
+		return false;
+
+	xdrs->x_private = xdrs->x_base;
+	xdrs->x_handy = INET_remote_buffer;
+
+	return true;
+}
+#endif
+
 #ifdef DEBUG
 static void packet_print(const TEXT* string, const UCHAR* packet, int length, ULONG counter)
 {
@@ -3308,6 +3450,70 @@ static bool packet_send( rem_port* port, const SCHAR* buffer, SSHORT buffer_leng
 	return true;
 }
 
+#ifndef WIN_NT
+static bool packet_send_vector(rem_port* port, iovec* iov, int count)
+{
+/**************************************
+ *
+ *	p a c k e t _ s e n d _ v e c t o r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send a few pieces of data on their way by a
+ *	single system call. The data must be already
+ *	encrypted and not need out-of-band notification.
+ *
+ **************************************/
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = iov;
+	message.msg_iovlen = count;
+
+	size_t total = 0;
+	for (int i = 0; i < count; i++)
+		total += iov[i].iov_len;
+
+	while (message.msg_iovlen)
+	{
+		const ssize_t n = sendmsg(port->port_handle, &message, FB_SEND_FLAGS);
+
+		if (n == -1)
+		{
+			if (INTERRUPT_ERROR(INET_ERRNO)) {
+				continue;
+			}
+
+			try
+			{
+				inet_error(false, port, "sendmsg", isc_net_write_err, INET_ERRNO);
+			}
+			catch (const Exception&) { }
+			return false;
+		}
+
+		// Skip what's been sent
+
+		size_t sent = n;
+		while (message.msg_iovlen && sent >= message.msg_iov->iov_len)
+		{
+			sent -= message.msg_iov->iov_len;
+			message.msg_iov++;
+			message.msg_iovlen--;
+		}
+
+		if (message.msg_iovlen)
+		{
+			message.msg_iov->iov_base = (char*) message.msg_iov->iov_base + sent;
+			message.msg_iov->iov_len -= sent;
+		}
+	}
+
+	port->bumpPhysStats(rem_port::SEND, total);
+	return true;
+}
+#endif
+
 static bool setNoNagleOption(rem_port* port)
 {
 /**************************************
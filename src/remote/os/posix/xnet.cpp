@@ -0,0 +1,1478 @@
+/*
+ *	PROGRAM:	JRD Remote Interface/Server
+ *	MODULE:		xnet.cpp
+ *	DESCRIPTION:	Shared memory local transport (Linux)
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ *  This is the counterpart of the Windows XNET protocol. The client and the server
+ *  exchange packets through the memory shared by the both processes, wakeups use
+ *  futexes placed into that memory. The server listens at a Unix socket in the
+ *  abstract namespace, creates the shared memory for every accepted connection
+ *  and passes its descriptor to the client. The socket is kept open afterwards:
+ *  it's closed by the kernel when any side dies, that's how the peer notices.
+ */
+
+#include "firebird.h"
+
+#ifdef LINUX
+
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../../../remote/remote.h"
+#include "ibase.h"
+#include "../../../remote/os/posix/xnet.h"
+#include "../../../remote/proto_proto.h"
+#include "../../../remote/remot_proto.h"
+#include "../../../remote/xnet_proto.h"
+#include "../../../remote/server/serve_proto.h"
+#include "../../../yvalve/gds_proto.h"
+#include "../../../common/isc_proto.h"
+#include "../../../common/isc_f_proto.h"
+#include "../../../common/classes/init.h"
+#include "../../../common/classes/fb_string.h"
+#include "../../../common/config/config.h"
+#include "../../../common/classes/ClumpletWriter.h"
+#include "../../../common/utils_proto.h"
+
+using namespace Firebird;
+
+static bool accept_connection(rem_port*, const P_CNCT*);
+static rem_port* alloc_port(rem_port*, UCHAR*, ULONG, UCHAR*, ULONG);
+static rem_port* aux_connect(rem_port*, PACKET*);
+static rem_port* aux_request(rem_port*, PACKET*);
+
+static void cleanup_comm(XCC);
+static void cleanup_mapping(XPM);
+static void cleanup_port(rem_port*);
+static void disconnect(rem_port*);
+static void force_close(rem_port*);
+static int cleanup_ports(const int, const int, void* arg);
+
+static rem_port* connect_client(PACKET*, const RefPtr<const Config>*);
+static rem_port* connect_server();
+static rem_port* get_server_port(int);
+static bool server_init();
+
+static rem_port* receive(rem_port*, PACKET*);
+static int send_full(rem_port*, PACKET*);
+static int send_partial(rem_port*, PACKET*);
+
+static RemoteXdr* xdrxnet_create(rem_port*, UCHAR *, USHORT, xdr_op);
+
+static bool_t xnet_read(RemoteXdr* xdrs);
+static bool_t xnet_write(RemoteXdr* xdrs);
+
+struct XnetXdr : public RemoteXdr
+{
+	virtual bool_t x_getbytes(SCHAR *, unsigned);		// get some bytes from "
+	virtual bool_t x_putbytes(const SCHAR*, unsigned);	// put some bytes to "
+};
+
+static pid_t current_process_id;
+
+static volatile bool xnet_shutdown = false;
+static GlobalPtr<PortsCleanup>	xnet_ports;
+static GlobalPtr<Mutex> xnet_mutex;
+
+static bool xnet_initialized = false;
+static int xnet_listen_socket = -1;
+
+static void xnet_error(rem_port*, ISC_STATUS, int);
+
+static void xnet_log_error(const char* err_msg, const Exception& ex)
+{
+	string str("XNET error: ");
+	str += err_msg;
+	iscLogException(str.c_str(), ex);
+}
+
+static void xnet_log_error(const char* err_msg)
+{
+	gds__log("XNET error: %s", err_msg);
+}
+
+#ifdef DEV_BUILD
+#define ERR_STR2(str, lnum) (str #lnum)
+#define ERR_STR1(str, lnum) ERR_STR2(str " at line ", lnum)
+#define ERR_STR(str) ERR_STR1(str, __LINE__)
+#else
+#define ERR_STR(str) (str)
+#endif
+
+
+rem_port* XNET_analyze(ClntAuthBlock* cBlock,
+					   const PathName& file_name,
+					   bool uv_flag,
+					   RefPtr<const Config>* config,
+					   const PathName* ref_db_name)
+{
+/**************************************
+ *
+ *  X N E T _ a n a l y z e
+ *
+ **************************************
+ *
+ * Functional description
+ *  Client performs attempt to establish connection
+ *  based on the set of protocols.
+ *	If a connection is established, return a port block,
+ *	otherwise return NULL.
+ *
+ **************************************/
+
+	// We need to establish a connection to a remote server.
+	// Allocate the necessary blocks and get ready to go.
+
+	Rdb* rdb = FB_NEW Rdb;
+	PACKET* packet = &rdb->rdb_packet;
+
+	// Pick up some user identification information
+
+	string buffer;
+	ClumpletWriter user_id(ClumpletReader::UnTagged, 64000);
+	if (cBlock)
+	{
+		cBlock->extractDataFromPluginTo(user_id);
+	}
+
+	ISC_get_user(&buffer, 0, 0);
+	buffer.lower();
+	ISC_systemToUtf8(buffer);
+	user_id.insertString(CNCT_user, buffer);
+
+	ISC_get_host(buffer);
+	buffer.lower();
+	ISC_systemToUtf8(buffer);
+	user_id.insertString(CNCT_host, buffer);
+
+	if (uv_flag) {
+		user_id.insertTag(CNCT_user_verification);
+	}
+
+	// Establish connection to server
+
+	P_CNCT* cnct = &packet->p_cnct;
+	packet->p_operation = op_connect;
+	cnct->p_cnct_operation = 0;
+	cnct->p_cnct_cversion = CONNECT_VERSION3;
+	cnct->p_cnct_client = ARCHITECTURE;
+
+	const PathName& cnct_file(ref_db_name ? (*ref_db_name) : file_name);
+	cnct->p_cnct_file.cstr_length = (ULONG) cnct_file.length();
+	cnct->p_cnct_file.cstr_address = reinterpret_cast<const UCHAR*>(cnct_file.c_str());
+
+	cnct->p_cnct_user_id.cstr_length = (ULONG) user_id.getBufferLength();
+	cnct->p_cnct_user_id.cstr_address = user_id.getBuffer();
+
+	static const p_cnct::p_cnct_repeat protocols_to_try[] =
+	{
+		REMOTE_PROTOCOL(PROTOCOL_VERSION10, ptype_batch_send, 1),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION11, ptype_batch_send, 2),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION12, ptype_batch_send, 3),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION13, ptype_batch_send, 4),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION14, ptype_batch_send, 5),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION15, ptype_batch_send, 6),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_batch_send, 7),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION17, ptype_batch_send, 8),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION18, ptype_batch_send, 9),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION19, ptype_batch_send, 10),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION20, ptype_batch_send, 11)
+	};
+	static_assert(FB_NELEM(protocols_to_try) <= MAX_CNCT_VERSIONS);
+
+	cnct->p_cnct_count = FB_NELEM(protocols_to_try);
+
+	for (size_t i = 0; i < cnct->p_cnct_count; i++) {
+		cnct->p_cnct_versions[i] = protocols_to_try[i];
+	}
+
+	// If we can't talk to a server, punt. Let somebody else generate an error.
+
+	rem_port* port = NULL;
+	try
+	{
+		port = XNET_connect(packet, 0, config);
+	}
+	catch (const Exception&)
+	{
+		delete rdb;
+		throw;
+	}
+
+	// Get response packet from server
+
+	rdb->rdb_port = port;
+	port->port_context = rdb;
+	port->receive(packet);
+
+	P_ACPT* accept = NULL;
+	switch (packet->p_operation)
+	{
+	case op_accept_data:
+	case op_cond_accept:
+		accept = &packet->p_acpd;
+		if (cBlock)
+		{
+			cBlock->storeDataForPlugin(packet->p_acpd.p_acpt_data.cstr_length,
+									   packet->p_acpd.p_acpt_data.cstr_address);
+			cBlock->authComplete = packet->p_acpd.p_acpt_authenticated;
+			cBlock->resetClnt(&packet->p_acpd.p_acpt_keys);
+		}
+		break;
+
+	case op_accept:
+		if (cBlock)
+		{
+			cBlock->resetClnt();
+		}
+		accept = &packet->p_acpt;
+		break;
+
+	case op_response:
+		try
+		{
+			LocalStatus warning;		// Ignore connect warnings for a while
+			REMOTE_check_response(&warning, rdb, packet);
+		}
+		catch (const Exception&)
+		{
+			disconnect(port);
+			delete rdb;
+			throw;
+		}
+		// fall through - response is not a required accept
+
+	default:
+		disconnect(port);
+		delete rdb;
+		Arg::Gds(isc_connect_reject).raise();
+		break;
+	}
+
+	fb_assert(accept);
+	fb_assert(port);
+	port->port_protocol = accept->p_acpt_version;
+
+	// Once we've decided on a protocol, concatenate the version
+	// string to reflect it...
+
+	string temp;
+	temp.printf("%s/P%d", port->port_version->str_data,
+						  port->port_protocol & FB_PROTOCOL_MASK);
+
+	delete port->port_version;
+	port->port_version = REMOTE_make_string(temp.c_str());
+
+	if (accept->p_acpt_architecture == ARCHITECTURE)
+		port->port_flags |= PORT_symmetric;
+
+	if (accept->p_acpt_type != ptype_out_of_band)
+		port->port_flags |= PORT_no_oob;
+
+	return port;
+}
+
+
+rem_port* XNET_connect(PACKET* packet,
+					   USHORT /*flag*/,
+					   RefPtr<const Config>* config)
+{
+/**************************************
+ *
+ *  X N E T _ c o n n e c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Establish half of a communication link.
+ *	Server side serves the multi-threaded
+ *	listener only, so the flag is not used.
+ *
+ **************************************/
+	if (xnet_shutdown)
+	{
+		Arg::StatusVector temp;
+		temp << Arg::Gds(isc_net_server_shutdown) << Arg::Str("XNET");
+		temp.raise();
+	}
+
+	if (packet)
+	{
+		return connect_client(packet, config);
+	}
+
+	return connect_server();
+}
+
+
+static bool accept_connection(rem_port* port, const P_CNCT* cnct)
+{
+/**************************************
+ *
+ *	a c c e p t _ c o n n e c t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Accept an incoming request for connection.
+ *
+ **************************************/
+	// Default account to "guest" (in theory all packets contain a name)
+
+	string user_name("guest"), host_name;
+
+	// Pick up account and host name, if given
+
+	ClumpletReader id(ClumpletReader::UnTagged,
+					  cnct->p_cnct_user_id.cstr_address,
+					  cnct->p_cnct_user_id.cstr_length);
+
+	for (id.rewind(); !id.isEof(); id.moveNext())
+	{
+		switch (id.getClumpTag())
+		{
+		case CNCT_user:
+			id.getString(user_name);
+			break;
+
+		case CNCT_host:
+			id.getString(host_name);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	port->port_login = port->port_user_name = user_name;
+	port->port_peer_name = host_name;
+	port->port_protocol_id = "XNET";
+
+	return true;
+}
+
+
+static rem_port* alloc_port(rem_port* parent,
+							UCHAR* send_buffer,
+							ULONG send_length,
+							UCHAR* receive_buffer,
+							ULONG /*receive_length*/)
+{
+/**************************************
+ *
+ *	a l l o c _ p o r t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allocate a port block, link it in to parent (if there is a parent),
+ *	and initialize input and output XDR streams.
+ *
+ **************************************/
+	rem_port* const port = FB_NEW rem_port(rem_port::XNET, 0);
+
+	TEXT buffer[BUFFER_TINY];
+	ISC_get_host(buffer, sizeof(buffer));
+	port->port_host = REMOTE_make_string(buffer);
+	port->port_connection = REMOTE_make_string(buffer);
+	fb_utils::snprintf(buffer, sizeof(buffer), "XNet (%s)", port->port_host->str_data);
+	port->port_version = REMOTE_make_string(buffer);
+
+	port->port_accept = accept_connection;
+	port->port_disconnect = disconnect;
+	port->port_force_close = force_close;
+	port->port_receive_packet = receive;
+	port->port_send_packet = send_full;
+	port->port_send_partial = send_partial;
+	port->port_connect = aux_connect;
+	port->port_request = aux_request;
+	port->port_buff_size = send_length;
+
+	port->port_send = xdrxnet_create(port, send_buffer, send_length, XDR_ENCODE);
+	port->port_receive = xdrxnet_create(port, receive_buffer, 0, XDR_DECODE);
+
+	if (parent)
+	{
+		delete port->port_connection;
+		port->port_connection = nullptr;
+		port->port_connection = REMOTE_make_string(parent->port_connection->str_data);
+
+		port->linkParent(parent);
+	}
+
+	return port;
+}
+
+
+static XCC make_aux_xcc(XCC parent_xcc, ULONG flags, int send_channel, int recv_channel)
+{
+/**************************************
+ *
+ *	m a k e _ a u x _ x c c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make an xcc pointing to the event channels
+ *	of the same mapped area as the parent one.
+ *
+ **************************************/
+	XPS xps = (XPS) parent_xcc->xcc_mapped_addr;
+
+	XCC xcc = FB_NEW struct xcc;
+
+	xcc->xcc_xpm = parent_xcc->xcc_xpm;
+	xcc->xcc_flags = flags;
+	xcc->xcc_mapped_addr = parent_xcc->xcc_mapped_addr;
+	xcc->xcc_send_channel = &xps->xps_channels[send_channel];
+	xcc->xcc_recv_channel = &xps->xps_channels[recv_channel];
+
+	MutexLockGuard guard(xnet_mutex, FB_FUNCTION);
+	xcc->xcc_xpm->xpm_count++;
+
+	return xcc;
+}
+
+
+static rem_port* aux_connect(rem_port* port, PACKET* /*packet*/)
+{
+/**************************************
+ *
+ *	a u x _ c o n n e c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to establish an alternative connection for handling events.
+ *  Somebody has already done a successful connect request.
+ *  This uses the existing xcc for the parent port to more
+ *  or less duplicate a new xcc for the new aux port pointing
+ *  to the event stuff in the map.
+ *
+ **************************************/
+
+	if (port->port_server_flags)
+	{
+		port->port_flags |= PORT_async;
+		return port;
+	}
+
+	XCC xcc = NULL;
+
+	try
+	{
+		xcc = make_aux_xcc(port->port_xcc, 0, XPS_CHANNEL_C2S_EVENTS, XPS_CHANNEL_S2C_EVENTS);
+
+		UCHAR* const channel_c2s_client_ptr =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_C2S_EVENTS);
+		UCHAR* const channel_s2c_client_ptr =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_S2C_EVENTS);
+
+		// alloc new port and link xcc to it
+		rem_port* const new_port = alloc_port(NULL,
+											  channel_c2s_client_ptr, xcc->xcc_send_channel->xch_size,
+											  channel_s2c_client_ptr, xcc->xcc_recv_channel->xch_size);
+
+		port->port_async = new_port;
+		new_port->port_flags = port->port_flags & PORT_no_oob;
+		new_port->port_flags |= PORT_async;
+		new_port->port_xcc = xcc;
+
+		return new_port;
+	}
+	catch (const Exception&)
+	{
+		xnet_log_error("aux_connect() failed");
+
+		if (xcc)
+			cleanup_comm(xcc);
+
+		return NULL;
+	}
+}
+
+
+static rem_port* aux_request(rem_port* port, PACKET* packet)
+{
+/**************************************
+ *
+ *	a u x _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *  A remote interface has requested the server to
+ *  prepare an auxiliary connection.   This is done
+ *  by allocating a new port and comm (xcc) structure,
+ *  using the event stuff in the map rather than the
+ *  normal database channels.
+ *
+ **************************************/
+
+	XCC xcc = NULL;
+
+	try
+	{
+		xcc = make_aux_xcc(port->port_xcc, XCCF_ASYNC, XPS_CHANNEL_S2C_EVENTS, XPS_CHANNEL_C2S_EVENTS);
+
+		UCHAR* const channel_c2s_client_ptr =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_C2S_EVENTS);
+		UCHAR* const channel_s2c_client_ptr =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_S2C_EVENTS);
+
+		// alloc new port and link xcc to it
+		rem_port* const new_port = alloc_port(NULL,
+											  channel_s2c_client_ptr, xcc->xcc_send_channel->xch_size,
+											  channel_c2s_client_ptr, xcc->xcc_recv_channel->xch_size);
+
+		new_port->port_xcc = xcc;
+		new_port->port_flags = (port->port_flags & PORT_no_oob) | PORT_connecting;
+		new_port->port_server_flags = port->port_server_flags;
+		port->port_async = new_port;
+
+		P_RESP* response = &packet->p_resp;
+		response->p_resp_data.cstr_length = 0;
+		response->p_resp_data.cstr_address = NULL;
+
+		return new_port;
+	}
+	catch (const Exception&)
+	{
+		xnet_log_error("aux_request() failed");
+
+		if (xcc)
+			cleanup_comm(xcc);
+
+		return NULL;
+	}
+}
+
+
+static void cleanup_comm(XCC xcc)
+{
+/**************************************
+ *
+ *  c l e a n u p _ c o m m
+ *
+ **************************************
+ *
+ * Functional description
+ *  Clean up an xcc structure, release
+ *  its mapping and free it.
+ *
+ **************************************/
+	XPS xps = (XPS) xcc->xcc_mapped_addr;
+	if (xps) {
+		xps->xps_flags |= XPS_DISCONNECTED;
+	}
+
+	if (xcc->xcc_xpm) {
+		cleanup_mapping(xcc->xcc_xpm);
+	}
+
+	delete xcc;
+}
+
+
+static void cleanup_mapping(XPM xpm)
+{
+/**************************************
+ *
+ *  c l e a n u p _ m a p p i n g
+ *
+ **************************************
+ *
+ * Functional description
+ *  Unmap the area and close the connection
+ *  socket when the last port releases them.
+ *
+ **************************************/
+	MutexLockGuard guard(xnet_mutex, FB_FUNCTION);
+
+	if (--xpm->xpm_count)
+		return;
+
+	if (xpm->xpm_address)
+		munmap(xpm->xpm_address, xpm->xpm_size);
+
+	if (xpm->xpm_socket >= 0)
+		close(xpm->xpm_socket);
+
+	delete xpm;
+}
+
+
+static void cleanup_port(rem_port* port)
+{
+/**************************************
+ *
+ *  c l e a n u p _ p o r t
+ *
+ **************************************
+ *
+ * Functional description
+ *  Walk through the port structure freeing
+ *  allocated memory and then free the port.
+ *
+ **************************************/
+
+	if (port->port_thread_guard && port->port_events_thread.isCurrent())
+	{
+		// Do not release XNET structures while event's thread working
+		port->port_events_thread.waitForCompletion();
+	}
+
+	if (port->port_xcc)
+	{
+		cleanup_comm(port->port_xcc);
+		port->port_xcc = NULL;
+	}
+
+	port->releasePort();
+}
+
+
+static rem_port* connect_client(PACKET* packet, const RefPtr<const Config>* config)
+{
+/**************************************
+ *
+ *  c o n n e c t _ c l i e n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Establish a client side part of the connection
+ *
+ **************************************/
+
+	const RefPtr<const Config>& conf(config ? *config : Config::getDefaultConfig());
+
+	current_process_id = getpid();
+
+	sockaddr_un address;
+	const socklen_t address_length = xnet_socket_address(&address, conf->getIpcName());
+
+	int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (sock < 0) {
+		system_error::raise(ERR_STR("socket"));
+	}
+
+	int map_fd = -1;
+	XPM xpm = NULL;
+	XCC xcc = NULL;
+
+	try
+	{
+		if (connect(sock, (sockaddr*) &address, address_length) < 0)
+		{
+			string name;
+			name.printf("xnet://%s", conf->getIpcName());
+			(Arg::Gds(isc_network_error) << Arg::Str(name) << SYS_ERR(errno)).raise();
+		}
+
+		// Wait for the server response carrying the shared memory descriptor
+
+		pollfd pfd;
+		pfd.fd = sock;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		int n;
+		do {
+			n = poll(&pfd, 1, conf->getConnectionTimeout() * 1000);
+		} while (n < 0 && errno == EINTR);
+
+		if (n <= 0)
+			(Arg::Gds(isc_net_read_err) << SYS_ERR(n ? errno : ETIMEDOUT)).raise();
+
+		XNET_RESPONSE response;
+		const ssize_t length = xnet_receive_mapping(sock, &response, &map_fd);
+		if (length < 0) {
+			system_error::raise(ERR_STR("recvmsg"));
+		}
+
+		if (length != sizeof(response) || map_fd < 0)
+		{
+			xnet_log_error("Server failed to respond on connect request");
+			Arg::Gds(isc_net_connect_err).raise();
+		}
+
+		void* const mapped_address =
+			mmap(NULL, response.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd, 0);
+		if (mapped_address == MAP_FAILED) {
+			system_error::raise(ERR_STR("mmap"));
+		}
+
+		close(map_fd);
+		map_fd = -1;
+
+		xpm = FB_NEW struct xpm;
+		xpm->xpm_count = 1;
+		xpm->xpm_socket = sock;
+		xpm->xpm_address = (UCHAR*) mapped_address;
+		xpm->xpm_size = response.map_size;
+		sock = -1;
+
+		// there's no thread structure, so make one
+		xcc = FB_NEW struct xcc;
+		xcc->xcc_xpm = xpm;
+		xcc->xcc_mapped_addr = xpm->xpm_address;
+
+		XPS xps = (XPS) xcc->xcc_mapped_addr;
+
+		// only speak if server has correct protocol
+
+		if (xps->xps_server_protocol != XPI_SERVER_PROTOCOL_VERSION) {
+			fatal_exception::raise("Unknown XNET protocol version");
+		}
+
+		xps->xps_client_protocol = XPI_CLIENT_PROTOCOL_VERSION;
+
+		xcc->xcc_recv_channel = &xps->xps_channels[XPS_CHANNEL_S2C_DATA];
+		xcc->xcc_send_channel = &xps->xps_channels[XPS_CHANNEL_C2S_DATA];
+
+		UCHAR* const channel_c2s_client_ptr =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_C2S_DATA);
+		UCHAR* const channel_s2c_client_ptr =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_S2C_DATA);
+
+		rem_port* const port =
+			alloc_port(NULL,
+					   channel_c2s_client_ptr, xcc->xcc_send_channel->xch_size,
+					   channel_s2c_client_ptr, xcc->xcc_recv_channel->xch_size);
+
+		port->port_xcc = xcc;
+		xnet_ports->registerPort(port);
+		send_full(port, packet);
+		if (config)
+		{
+			port->port_config = *config;
+		}
+
+		return port;
+	}
+	catch (const Exception&)
+	{
+		if (map_fd >= 0)
+			close(map_fd);
+
+		if (xcc)
+			cleanup_comm(xcc);
+		else if (xpm)
+			cleanup_mapping(xpm);
+		else if (sock >= 0)
+			close(sock);
+
+		throw;
+	}
+}
+
+
+static bool server_init()
+{
+/**************************************
+ *
+ *  s e r v e r _ i n i t
+ *
+ **************************************
+ *
+ * Functional description
+ *  Initialization of server side resources used
+ *  when clients perform connect to server
+ *
+ **************************************/
+	MutexLockGuard guard(xnet_mutex, FB_FUNCTION);
+
+	if (xnet_initialized)
+		return true;
+
+	current_process_id = getpid();
+
+	try
+	{
+		sockaddr_un address;
+		const socklen_t address_length =
+			xnet_socket_address(&address, Config::getDefaultConfig()->getIpcName());
+
+		xnet_listen_socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+		if (xnet_listen_socket < 0) {
+			system_error::raise(ERR_STR("socket"));
+		}
+
+		if (bind(xnet_listen_socket, (sockaddr*) &address, address_length) < 0) {
+			system_error::raise(ERR_STR("bind"));
+		}
+
+		if (listen(xnet_listen_socket, SOMAXCONN) < 0) {
+			system_error::raise(ERR_STR("listen"));
+		}
+	}
+	catch (const Exception& ex)
+	{
+		xnet_log_error("XNET server initialization failed. "
+			"Probably another instance of server is already running.", ex);
+
+		if (xnet_listen_socket >= 0)
+		{
+			close(xnet_listen_socket);
+			xnet_listen_socket = -1;
+		}
+
+		xnet_shutdown = true;
+
+		// the real error is already logged, return isc_net_server_shutdown instead
+		Arg::StatusVector temp;
+		temp << Arg::Gds(isc_net_server_shutdown) << Arg::Str("XNET");
+		temp.raise();
+	}
+
+	xnet_initialized = true;
+	fb_shutdown_callback(0, cleanup_ports, fb_shut_postproviders, 0);
+
+	return true;
+}
+
+
+static rem_port* connect_server()
+{
+/**************************************
+ *
+ *  c o n n e c t _ s e r v e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Establish a server side part of the connection
+ *
+ **************************************/
+	if (!server_init())
+		return NULL;
+
+	while (!xnet_shutdown)
+	{
+		const int sock = accept4(xnet_listen_socket, NULL, NULL, SOCK_CLOEXEC);
+
+		if (sock < 0)
+		{
+			if (xnet_shutdown)
+				break;
+
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			xnet_log_error("accept() failed");
+			break;
+		}
+
+		try
+		{
+			return get_server_port(sock);
+		}
+		catch (const Exception& ex)
+		{
+			xnet_log_error("Failed to allocate server port for communication", ex);
+		}
+	}
+
+	if (xnet_shutdown)
+	{
+		Arg::StatusVector temp;
+		temp << Arg::Gds(isc_net_server_shutdown) << Arg::Str("XNET");
+		temp.raise();
+	}
+
+	return NULL;
+}
+
+
+static rem_port* get_server_port(int sock)
+{
+/**************************************
+ *
+ *  g e t _ s e r v e r _ p o r t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allocates new rem_port for server side communication.
+ *	Creates the shared memory for the accepted
+ *	connection and passes it to the client.
+ *
+ **************************************/
+	rem_port* port = NULL;
+	XCC xcc = NULL;
+	XPM xpm = NULL;
+	int map_fd = -1;
+
+	try
+	{
+		ucred credentials;
+		socklen_t credentials_length = sizeof(credentials);
+		if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &credentials, &credentials_length) < 0) {
+			system_error::raise(ERR_STR("getsockopt"));
+		}
+
+		map_fd = memfd_create("firebird_xnet", MFD_CLOEXEC);
+		if (map_fd < 0) {
+			system_error::raise(ERR_STR("memfd_create"));
+		}
+
+		if (ftruncate(map_fd, XPS_MAPPED_SIZE) < 0) {
+			system_error::raise(ERR_STR("ftruncate"));
+		}
+
+		void* const mapped_address =
+			mmap(NULL, XPS_MAPPED_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd, 0);
+		if (mapped_address == MAP_FAILED) {
+			system_error::raise(ERR_STR("mmap"));
+		}
+
+		xpm = FB_NEW struct xpm;
+		xpm->xpm_count = 1;
+		xpm->xpm_socket = sock;
+		xpm->xpm_address = (UCHAR*) mapped_address;
+		xpm->xpm_size = XPS_MAPPED_SIZE;
+		sock = -1;
+
+		// allocate a communications control structure and fill it in
+
+		xcc = FB_NEW struct xcc;
+		xcc->xcc_xpm = xpm;
+		xcc->xcc_mapped_addr = xpm->xpm_address;
+
+		// the memory is zeroed by ftruncate() that makes all events non-signaled
+
+		XPS xps = xnet_init_mapping(xcc->xcc_mapped_addr, XPS_MAPPED_SIZE);
+		xps->xps_client_proc_id = credentials.pid;
+		xps->xps_server_proc_id = current_process_id;
+
+		UCHAR* const channel_c2s_data_buffer =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_C2S_DATA);
+		UCHAR* const channel_s2c_data_buffer =
+			xnet_channel_buffer(xcc->xcc_mapped_addr, XPS_CHANNEL_S2C_DATA);
+
+		xcc->xcc_recv_channel = &xps->xps_channels[XPS_CHANNEL_C2S_DATA];
+		xcc->xcc_send_channel = &xps->xps_channels[XPS_CHANNEL_S2C_DATA];
+
+		// finally, allocate and set the port structure for this client
+
+		port = alloc_port(NULL,
+						  channel_s2c_data_buffer, xcc->xcc_send_channel->xch_size,
+						  channel_c2s_data_buffer, xcc->xcc_recv_channel->xch_size);
+
+		port->port_xcc = xcc;
+		port->port_server_flags |= SRVR_server;
+		port->port_flags |= PORT_server;
+
+		// pass the shared memory to the client
+
+		XNET_RESPONSE response;
+		response.proc_id = current_process_id;
+		response.map_size = XPS_MAPPED_SIZE;
+
+		if (!xnet_send_mapping(xpm->xpm_socket, response, map_fd)) {
+			system_error::raise(ERR_STR("sendmsg"));
+		}
+
+		close(map_fd);
+		map_fd = -1;
+
+		xnet_ports->registerPort(port);
+	}
+	catch (const Exception&)
+	{
+		if (map_fd >= 0)
+			close(map_fd);
+
+		if (port)
+			cleanup_port(port);
+		else if (xcc)
+			cleanup_comm(xcc);
+		else if (xpm)
+			cleanup_mapping(xpm);
+		else if (sock >= 0)
+			close(sock);
+
+		throw;
+	}
+
+	return port;
+}
+
+
+static void disconnect(rem_port* port)
+{
+/**************************************
+ *
+ *	d i s c o n n e c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Break a remote connection.
+ *
+ **************************************/
+
+	if (port->port_state == rem_port::DISCONNECTED)
+		return;
+
+	port->port_state = rem_port::DISCONNECTED;
+
+	if (port->port_async)
+	{
+		disconnect(port->port_async);
+		port->port_async = NULL;
+	}
+	port->port_context = NULL;
+
+	// If this is a sub-port, unlink it from it's parent
+	port->unlinkParent();
+	port->port_flags &= ~PORT_connecting;
+	xnet_ports->unRegisterPort(port);
+	cleanup_port(port);
+}
+
+
+static void force_close(rem_port* port)
+{
+/**************************************
+ *
+ *	f o r c e _ c l o s e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Forcibly close remote connection.
+ *	Threads waiting for the channels notice
+ *	the flag when their wait times out.
+ *
+ **************************************/
+	if (port->port_state != rem_port::PENDING || !port->port_xcc)
+		return;
+
+	port->port_state = rem_port::BROKEN;
+
+	XPS xps = (XPS) port->port_xcc->xcc_mapped_addr;
+	if (xps) {
+		xps->xps_flags |= XPS_DISCONNECTED;
+	}
+}
+
+
+static int cleanup_ports(const int, const int, void* /*arg*/)
+{
+/**************************************
+ *
+ *	c l e a n u p _ p o r t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Shutdown all active connections
+ *	to allow correct shutdown.
+ *
+ **************************************/
+	xnet_shutdown = true;
+
+	// wake up the listener thread waiting in accept()
+	if (xnet_listen_socket >= 0)
+		shutdown(xnet_listen_socket, SHUT_RDWR);
+
+	xnet_ports->closePorts();
+
+	return 0;
+}
+
+
+static rem_port* receive( rem_port* main_port, PACKET* packet)
+{
+/**************************************
+ *
+ *	r e c e i v e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Receive a message from a port.
+ *
+ **************************************/
+
+	try
+	{
+		if (!xdr_protocol(main_port->port_receive, packet))
+			packet->p_operation = op_exit;
+	}
+	catch (const Exception&)
+	{
+		packet->p_operation = op_exit;
+	}
+
+	return main_port;
+}
+
+
+static int send_full( rem_port* port, PACKET* packet)
+{
+/**************************************
+ *
+ *	s e n d _ f u l l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send a packet across a port to another process.
+ *  Flush data to remote interface
+ *
+ **************************************/
+
+	if (!xdr_protocol(port->port_send, packet))
+		return FALSE;
+
+	return xnet_write(port->port_send);
+}
+
+
+static int send_partial( rem_port* port, PACKET* packet)
+{
+/**************************************
+ *
+ *	s e n d _ p a r t i a l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send a packet across a port to another process.
+ *
+ **************************************/
+
+	return xdr_protocol(port->port_send, packet);
+}
+
+
+static RemoteXdr* xdrxnet_create(rem_port* port, UCHAR* buffer, USHORT length, xdr_op x_op)
+{
+/**************************************
+ *
+ *  x d r x n e t _ c r e a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *  Initialize an XDR stream.
+ *
+ **************************************/
+
+	RemoteXdr* xdrs = FB_NEW XnetXdr;
+
+	xdrs->x_public = port;
+	xdrs->x_local = true;
+	xdrs->create(reinterpret_cast<SCHAR*>(buffer), length, x_op);
+
+	return xdrs;
+}
+
+
+static void xnet_gen_error (rem_port* port, const Arg::StatusVector& v)
+{
+/**************************************
+ *
+ *      x n e t _ g e n _ e r r o r
+ *
+ **************************************
+ *
+ * Functional description
+ *	An error has occurred.  Mark the port as broken.
+ *	Format the status vector if there is one and
+ *	save the status vector strings in a permanent place.
+ *
+ **************************************/
+	port->port_state = rem_port::BROKEN;
+	v.raise();
+}
+
+
+static void xnet_error(rem_port* port, ISC_STATUS operation, int status)
+{
+/**************************************
+ *
+ *      x n e t _ e r r o r
+ *
+ **************************************
+ *
+ * Functional description
+ *	An I/O error has occurred.  If a status vector is present,
+ *	generate an error return.  In any case, return NULL, which
+ *	is used to indicate and error.
+ *
+ **************************************/
+	if (status)
+	{
+		if (port->port_state == rem_port::PENDING)
+		{
+			gds__log("XNET/xnet_error: errno = %d", status);
+		}
+
+		xnet_gen_error(port, Arg::Gds(operation) << SYS_ERR(status));
+	}
+	else
+	{
+		xnet_gen_error(port, Arg::Gds(operation));
+	}
+}
+
+
+static bool peer_alive(XCC xcc)
+{
+/**************************************
+ *
+ *      p e e r _ a l i v e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether the other side is alive. Nothing is
+ *	written into the connection socket after the connect,
+ *	so any event on it means the other side has closed it.
+ *
+ **************************************/
+	const XPS xps = (XPS) xcc->xcc_mapped_addr;
+
+	if (xps->xps_flags & XPS_DISCONNECTED)
+		return false;
+
+	pollfd pfd;
+	pfd.fd = xcc->xcc_xpm->xpm_socket;
+	pfd.events = POLLIN | POLLRDHUP;
+	pfd.revents = 0;
+
+	const int n = poll(&pfd, 1, 0);
+	return n == 0 || (n < 0 && errno == EINTR);
+}
+
+
+static bool xnet_wait(rem_port* port, xev* event, int timeout)
+{
+/**************************************
+ *
+ *      x n e t _ w a i t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Wait for the channel event,
+ *	watching the other side health.
+ *
+ **************************************/
+	XCC xcc = port->port_xcc;
+
+	while (!xnet_shutdown)
+	{
+		if (xcc->xcc_flags & XCCF_PEER_GONE)
+			return false;
+
+		const bool signaled = xnet_event_wait(event, timeout);
+
+		if (port->port_flags & PORT_disconnect)
+			return false;
+
+		if (signaled)
+			return true;
+
+		if (!peer_alive(xcc))
+		{
+			// Another side is dead or something bad has happened
+			xcc->xcc_flags |= XCCF_PEER_GONE;
+			xnet_error(port, isc_lost_db_connection, 0);
+		}
+	}
+
+	return false;
+}
+
+
+bool_t XnetXdr::x_getbytes(SCHAR* buff, unsigned bytecount)
+{
+/**************************************
+ *
+ *      x n e t _ g e t b y t e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fetch a bunch of bytes from remote interface.
+ *
+ **************************************/
+	while (bytecount && !xnet_shutdown)
+	{
+		SLONG to_copy;
+		if (x_handy >= bytecount)
+			to_copy = bytecount;
+		else
+			to_copy = x_handy;
+
+		if (x_handy)
+		{
+			if (to_copy == sizeof(SLONG))
+				*((SLONG*)buff)	= *((SLONG*)x_private);
+			else
+				memcpy(buff, x_private, to_copy);
+
+			x_handy -= to_copy;
+			x_private += to_copy;
+		}
+		else
+		{
+			if (!xnet_read(this))
+				return FALSE;
+		}
+
+		if (to_copy)
+		{
+			bytecount -= to_copy;
+			buff += to_copy;
+		}
+	}
+
+	return xnet_shutdown ? FALSE : TRUE;
+}
+
+
+bool_t XnetXdr::x_putbytes(const SCHAR* buff, unsigned bytecount)
+{
+/**************************************
+ *
+ *      x n e t _ p u t b y t e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put a bunch of bytes into a memory stream.
+ *
+ **************************************/
+	rem_port* port = x_public;
+	XCH xch = port->port_xcc->xcc_send_channel;
+
+	while (bytecount && !xnet_shutdown)
+	{
+		SLONG to_copy;
+		if (x_handy >= bytecount)
+			to_copy = bytecount;
+		else
+			to_copy = x_handy;
+
+		if (x_handy)
+		{
+			// The channel must be read by the other side before it's filled again
+
+			if (x_handy == xch->xch_size && !xnet_wait(port, &xch->xch_empted, XNET_SEND_WAIT_TIMEOUT))
+				return FALSE;
+
+			if (to_copy == sizeof(SLONG))
+				*((SLONG*)x_private) = *((SLONG*)buff);
+			else
+				memcpy(x_private, buff, to_copy);
+
+			x_handy -= to_copy;
+			x_private += to_copy;
+		}
+		else
+		{
+			if (!xnet_write(this))
+				return FALSE;
+		}
+
+		if (to_copy)
+		{
+			bytecount -= to_copy;
+			buff += to_copy;
+		}
+	}
+
+	return xnet_shutdown ? FALSE : TRUE;
+}
+
+
+static bool_t xnet_read(RemoteXdr* xdrs)
+{
+/**************************************
+ *
+ *      x n e t _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a buffer full of data.
+ *
+ **************************************/
+	rem_port* port = xdrs->x_public;
+	XCH xch = port->port_xcc->xcc_recv_channel;
+
+	if (xnet_shutdown)
+		return FALSE;
+
+	xnet_event_set(&xch->xch_empted);
+
+	if (!xnet_wait(port, &xch->xch_filled, XNET_RECV_WAIT_TIMEOUT))
+		return FALSE;
+
+	// The other side has written some data for us to read
+
+	port->bumpPhysStats(rem_port::RECEIVE, xch->xch_length);
+	port->bumpLogBytes(rem_port::RECEIVE, xch->xch_length);	// XNET not calls REMOTE_inflate
+
+	xdrs->x_handy = xch->xch_length;
+	xdrs->x_private = xdrs->x_base;
+
+	return TRUE;
+}
+
+
+static bool_t xnet_write(RemoteXdr* xdrs)
+{
+/**************************************
+ *
+ *      x n e t _ w r i t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Signal remote interface that memory stream is
+ *  filled and ready for reading.
+ *
+ **************************************/
+	rem_port* port = xdrs->x_public;
+	XCH xch = port->port_xcc->xcc_send_channel;
+
+	xch->xch_length = xdrs->x_private - xdrs->x_base;
+	xnet_event_set(&xch->xch_filled);
+
+	port->bumpPhysStats(rem_port::SEND, xch->xch_length);
+	port->bumpLogBytes(rem_port::SEND, xch->xch_length);	// XNET not calls REMOTE_deflate
+
+	xdrs->x_private = xdrs->x_base;
+	xdrs->x_handy = xch->xch_size;
+
+	return TRUE;
+}
+
+#endif // LINUX
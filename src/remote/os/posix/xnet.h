@@ -0,0 +1,327 @@
+/*
+ *	PROGRAM:	JRD Remote Interface/Server
+ *	MODULE:		xnet.h
+ *	DESCRIPTION:	Shared memory local transport definitions (Linux)
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef REMOTE_POSIX_XNET_H
+#define REMOTE_POSIX_XNET_H
+
+#include <atomic>
+#include <new>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+// Receive wait timeout (ms), the other side liveness is checked when it expires
+inline constexpr int XNET_RECV_WAIT_TIMEOUT = 500;
+
+// Send wait timeout (ms)
+inline constexpr int XNET_SEND_WAIT_TIMEOUT = XNET_RECV_WAIT_TIMEOUT;
+
+// Size of the memory area shared by the client and the server, every connection has its own one
+inline constexpr ULONG XPS_MAPPED_SIZE		= 64 * 1024;
+
+inline constexpr ULONG XNET_EVENT_SPACE		= 100;	// half of space (bytes) for event handling per connection
+
+// Auto-reset event placed into the shared memory. Waiting threads sleep on the futex
+// while the flag is clear, so the signaling side enters the kernel only if somebody waits.
+
+struct xev
+{
+	std::atomic<int>	xev_signaled;		// futex word: 1 - signaled, 0 - not
+	std::atomic<int>	xev_waiters;		// number of threads sleeping on the futex
+};
+
+static_assert(std::atomic<int>::is_always_lock_free, "Futex word must be lock free");
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "Futex word must be 32-bit integer");
+
+// Comm channel structure - four per connection (client to server data,
+// server to client data, client to server events, server to client events)
+
+typedef struct xch
+{
+	ULONG		xch_length;					// message length
+	ULONG		xch_size;					// channel data size
+	xev			xch_filled;					// channel is ready for reading
+	xev			xch_empted;					// channel is ready for writing
+} *XCH;
+
+// Mapped area, shared by the main and auxiliary ports of the connection
+
+typedef struct xpm
+{
+	ULONG		xpm_count;					// ports using the mapping
+	int			xpm_socket;					// connection socket, kept open to watch the other side
+	UCHAR*		xpm_address;				// address of mapped memory
+	ULONG		xpm_size;					// size of mapped memory
+} *XPM;
+
+// Thread connection control block
+
+typedef struct xcc
+{
+	xcc()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	XPM			xcc_xpm;					// pointer back to xpm
+	XCH			xcc_recv_channel;			// receive channel structure
+	XCH			xcc_send_channel;			// send channel structure
+	ULONG		xcc_flags;					// status bits
+	UCHAR*		xcc_mapped_addr;			// where the connection is mapped to
+} *XCC;
+
+// XCC structure flags
+
+inline constexpr ULONG XCCF_PEER_GONE		= 1;	// the other side has gone, error is already reported
+inline constexpr ULONG XCCF_ASYNC			= 2;	// secondary XCC for events processing
+
+// This structure (xps) is mapped to the start of the allocated
+// communications area between the client and server
+
+typedef struct xps
+{
+	ULONG		xps_server_protocol;		// server's protocol level
+	ULONG		xps_client_protocol;		// client's protocol level
+	pid_t		xps_server_proc_id;			// server's process id
+	pid_t		xps_client_proc_id;			// client's process id
+	std::atomic<int>	xps_flags;			// flags word
+	struct xch	xps_channels[4];			// comm channels
+} *XPS;
+
+// XPS flags
+
+inline constexpr int XPS_DISCONNECTED = 1;
+
+// xps_channel numbers
+
+inline constexpr int XPS_CHANNEL_C2S_DATA	= 0;	// 0 - client to server data
+inline constexpr int XPS_CHANNEL_S2C_DATA	= 1;	// 1 - server to client data
+inline constexpr int XPS_CHANNEL_C2S_EVENTS	= 2;	// 2 - client to server events
+inline constexpr int XPS_CHANNEL_S2C_EVENTS	= 3;	// 3 - server to client events
+
+// Order of the channel buffers in the mapped area, they follow the xps structure
+
+inline constexpr int XPS_CHANNEL_LAYOUT[] =
+	{XPS_CHANNEL_C2S_EVENTS, XPS_CHANNEL_S2C_EVENTS, XPS_CHANNEL_C2S_DATA, XPS_CHANNEL_S2C_DATA};
+
+inline constexpr ULONG XPI_CLIENT_PROTOCOL_VERSION	= 1;
+inline constexpr ULONG XPI_SERVER_PROTOCOL_VERSION	= 1;
+
+// XNET_RESPONSE - server response on client connect request,
+// the descriptor of the shared memory is passed along with it
+
+struct XNET_RESPONSE
+{
+	ULONG proc_id;
+	ULONG map_size;
+};
+
+// Name of the socket in the abstract namespace the server listens at
+
+inline constexpr const char* XNET_CONNECT_SOCKET	= "%s_XNET_CONNECT";
+
+
+// Shared memory events
+
+inline long xnet_futex(std::atomic<int>* word, int operation, int value, const timespec* timeout)
+{
+	return syscall(SYS_futex, reinterpret_cast<int*>(word), operation, value, timeout, NULL, 0);
+}
+
+inline void xnet_event_set(xev* event)
+{
+	event->xev_signaled.store(1);
+
+	if (event->xev_waiters.load())
+		xnet_futex(&event->xev_signaled, FUTEX_WAKE, 1, NULL);
+}
+
+inline bool xnet_event_wait(xev* event, int timeout)
+{
+	// Returns true if the event was signaled and false if the timeout has expired
+
+	if (event->xev_signaled.exchange(0))
+		return true;
+
+	const timespec interval = {timeout / 1000, (timeout % 1000) * 1000000L};
+
+	event->xev_waiters++;
+
+	bool signaled = false;
+	while (true)
+	{
+		if (event->xev_signaled.exchange(0))
+		{
+			signaled = true;
+			break;
+		}
+
+		// The word could be set between the check and the call, futex returns EAGAIN then
+
+		if (xnet_futex(&event->xev_signaled, FUTEX_WAIT, 0, &interval) < 0 && errno == ETIMEDOUT)
+		{
+			signaled = event->xev_signaled.exchange(0);
+			break;
+		}
+	}
+
+	event->xev_waiters--;
+
+	return signaled;
+}
+
+
+// Address of the socket the server listens at, returns its length
+
+inline socklen_t xnet_socket_address(sockaddr_un* address, const char* ipc_name)
+{
+	// The leading zero byte puts the name into the abstract namespace,
+	// so nothing is left in the file system after the server exits
+
+	memset(address, 0, sizeof(sockaddr_un));
+	address->sun_family = AF_UNIX;
+
+	const size_t max_length = sizeof(address->sun_path) - 1;
+	const int length = snprintf(address->sun_path + 1, max_length, XNET_CONNECT_SOCKET, ipc_name);
+
+	return offsetof(sockaddr_un, sun_path) + 1 + MIN((size_t) length, max_length - 1);
+}
+
+
+// Lay out the zeroed memory of a new connection, all events are non-signaled then
+
+inline XPS xnet_init_mapping(UCHAR* address, ULONG size)
+{
+	XPS xps = new(address) struct xps;
+
+	// make sure client knows what this server speaks
+
+	xps->xps_server_protocol = XPI_SERVER_PROTOCOL_VERSION;
+	xps->xps_client_protocol = 0L;
+
+	// the rest of the memory is split between the data channels
+
+	const ULONG avail = (ULONG) (size - sizeof(struct xps) - XNET_EVENT_SPACE * 2) / 2;
+
+	xps->xps_channels[XPS_CHANNEL_C2S_EVENTS].xch_size = XNET_EVENT_SPACE;
+	xps->xps_channels[XPS_CHANNEL_S2C_EVENTS].xch_size = XNET_EVENT_SPACE;
+	xps->xps_channels[XPS_CHANNEL_C2S_DATA].xch_size = avail;
+	xps->xps_channels[XPS_CHANNEL_S2C_DATA].xch_size = avail;
+
+	return xps;
+}
+
+// Address of the channel buffer in the mapped area
+
+inline UCHAR* xnet_channel_buffer(UCHAR* address, int channel)
+{
+	const XPS xps = (XPS) address;
+	UCHAR* p = address + sizeof(struct xps);
+
+	for (const int n : XPS_CHANNEL_LAYOUT)
+	{
+		if (n == channel)
+			break;
+
+		p += xps->xps_channels[n].xch_size;
+	}
+
+	return p;
+}
+
+
+// Send the server response with the descriptor of the shared memory,
+// returns false and sets errno on failure
+
+inline bool xnet_send_mapping(int sock, const XNET_RESPONSE& response, int map_fd)
+{
+	iovec iov;
+	iov.iov_base = const_cast<XNET_RESPONSE*>(&response);
+	iov.iov_len = sizeof(response);
+
+	union
+	{
+		cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(int))];
+	} control;
+
+	memset(&control, 0, sizeof(control));
+
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	cmsghdr* const cmsg = CMSG_FIRSTHDR(&message);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &map_fd, sizeof(int));
+
+	return sendmsg(sock, &message, MSG_NOSIGNAL) >= 0;
+}
+
+// Receive the server response, map_fd is set to the passed descriptor or -1 if
+// there is none. Returns the length of the response or -1 with errno set.
+
+inline ssize_t xnet_receive_mapping(int sock, XNET_RESPONSE* response, int* map_fd)
+{
+	*map_fd = -1;
+
+	iovec iov;
+	iov.iov_base = response;
+	iov.iov_len = sizeof(XNET_RESPONSE);
+
+	union
+	{
+		cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(int))];
+	} control;
+
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	const ssize_t length = recvmsg(sock, &message, MSG_CMSG_CLOEXEC);
+
+	if (length >= 0)
+	{
+		const cmsghdr* const cmsg = CMSG_FIRSTHDR(&message);
+		if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+			memcpy(map_fd, CMSG_DATA(cmsg), sizeof(int));
+	}
+
+	return length;
+}
+
+#endif // REMOTE_POSIX_XNET_H
@@ -31,7 +31,7 @@
 #include "../../../utilities/install/install_nt.h"
 #include "../../../remote/proto_proto.h"
 #include "../../../remote/remot_proto.h"
-#include "../../../remote/os/win32/xnet_proto.h"
+#include "../../../remote/xnet_proto.h"
 #include "../../../remote/server/serve_proto.h"
 #include "../../../yvalve/gds_proto.h"
 #include "../../../common/isc_proto.h"
@@ -1314,7 +1314,7 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 
 	enum rem_port_t {
 		INET,			// Internet (TCP/IP)
-		XNET			// Windows NT shared memory connection
+		XNET			// Shared memory connection (Windows NT, Linux)
 	}				port_type;
 	enum state_t {
 		PENDING,		// connection is pending
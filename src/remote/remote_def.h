@@ -83,7 +83,7 @@ inline constexpr USHORT SRVR_server				= 1;	// server
 inline constexpr USHORT SRVR_multi_client		= 2;	// multi-client server
 inline constexpr USHORT SRVR_debug				= 4;	// debug run
 inline constexpr USHORT SRVR_inet				= 8;	// Inet protocol
-inline constexpr USHORT SRVR_xnet				= 16;	// Xnet protocol (Win32)
+inline constexpr USHORT SRVR_xnet				= 16;	// Xnet protocol (Win32, Linux)
 inline constexpr USHORT SRVR_non_service		= 32;	// not running as an NT service
 inline constexpr USHORT SRVR_high_priority		= 64;	// fork off server at high priority
 inline constexpr USHORT SRVR_thread_per_port	= 128;	// bind thread to a port
@@ -83,12 +83,16 @@
 #include "../jrd/replication/Config.h"
 #include "../common/file_params.h"
 #include "../remote/inet_proto.h"
+#ifdef LINUX
+#include "../remote/xnet_proto.h"
+#endif
 #include "../remote/server/serve_proto.h"
 #include "../remote/server/ReplServer.h"
 #include "../yvalve/gds_proto.h"
 #include "../common/utils_proto.h"
 #include "../common/classes/fb_string.h"
 #include "../common/classes/semaphore.h"
+#include "../common/ThreadStart.h"
 
 #include "firebird/Interface.h"
 #include "../common/classes/ImplementHelper.h"
@@ -120,6 +124,13 @@ static void shutdown_handler(int);
 static TEXT protocol[128];
 static int INET_SERVER_start = 0;
 
+#ifdef LINUX
+static THREAD_ENTRY_DECLARE xnet_connect_wait_thread(THREAD_ENTRY_PARAM);
+static THREAD_ENTRY_DECLARE xnet_connection_thread(THREAD_ENTRY_PARAM);
+
+static USHORT XNET_SERVER_flag = 0;
+#endif
+
 #if defined(HAVE_SETRLIMIT) && defined(HAVE_GETRLIMIT)
 #define FB_RAISE_LIMITS 1
 static void raiseLimit(int resource);
@@ -203,6 +214,7 @@ int CLIB_ROUTINE main( int argc, char** argv)
 		const TEXT* const* const end = argc + argv;
 		argv++;
 		bool debug = false;
+		bool xnet = false;
 		USHORT INET_SERVER_flag = 0;
 		protocol[0] = 0;
 
@@ -256,11 +268,22 @@ int CLIB_ROUTINE main( int argc, char** argv)
 						}
 						break;
 
+					case 'X':
+#ifdef LINUX
+						xnet = true;
+#else
+						printf("Shared memory protocol is not supported, switch -X ignored\n");
+#endif
+						break;
+
 		            case 'H':
 					case '?':
 						printf("Firebird TCP/IP server options are:\n");
 						printf("  -d        : debug on\n");
 						printf("  -p <port> : specify port to listen on\n");
+#ifdef LINUX
+						printf("  -x        : also accept local connections using shared memory (xnet://)\n");
+#endif
 						printf("  -z        : print version and exit\n");
 						printf("  -h|?      : print this help\n");
 		                printf("\n");
@@ -579,6 +602,19 @@ int CLIB_ROUTINE main( int argc, char** argv)
 
 		fb_shutdown_callback(NULL, closePort, fb_shut_exit, port);
 
+#ifdef LINUX
+		if (xnet)
+		{
+			if (super)
+			{
+				XNET_SERVER_flag = INET_SERVER_flag | SRVR_xnet;
+				Thread::start(xnet_connect_wait_thread, NULL, THREAD_medium);
+			}
+			else
+				gds__log("Switch -X ignored in CS mode\n");
+		}
+#endif
+
 		SRVR_multi_thread(port, INET_SERVER_flag);
 
 		// perform atexit shutdown here when all globals in embedded library are active
@@ -607,6 +643,75 @@ int CLIB_ROUTINE main( int argc, char** argv)
 } // extern "C"
 
 
+#ifdef LINUX
+static THREAD_ENTRY_DECLARE xnet_connect_wait_thread(THREAD_ENTRY_PARAM)
+{
+/**************************************
+ *
+ *	x n e t _ c o n n e c t _ w a i t _ t h r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Accept shared memory connections,
+ *	serving each one in its own thread.
+ *
+ **************************************/
+	while (true)
+	{
+		rem_port* port = NULL;
+
+		try
+		{
+			port = XNET_connect(NULL, XNET_SERVER_flag, NULL);
+		}
+		catch (const Exception& ex)
+		{
+			SimpleStatusVector<> status_vector;
+			ex.stuffException(status_vector);
+
+			if (status_vector[1] == isc_net_server_shutdown)
+				break;
+
+			iscLogException("XNET_connect", ex);
+		}
+
+		if (!port)
+			break;
+
+		try
+		{
+			Thread::start(xnet_connection_thread, port, THREAD_medium);
+		}
+		catch (const Exception&)
+		{
+			gds__log("XNET: can't start worker thread, connection terminated");
+			port->disconnect(NULL, NULL);
+		}
+	}
+
+	return 0;
+}
+
+
+static THREAD_ENTRY_DECLARE xnet_connection_thread(THREAD_ENTRY_PARAM arg)
+{
+/**************************************
+ *
+ *	x n e t _ c o n n e c t i o n _ t h r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Serve the single shared memory connection.
+ *
+ **************************************/
+	SRVR_main((rem_port*) arg, XNET_SERVER_flag & ~SRVR_multi_client);
+	return 0;
+}
+#endif // LINUX
+
+
 static void set_signal(int signal_number, void (*handler) (int))
 {
 /**************************************
@@ -0,0 +1,5 @@
+#include "firebird.h"
+#include "../common/gdsassert.h"
+
+#define BOOST_TEST_MODULE RemoteTest
+#include "boost/test/included/unit_test.hpp"
@@ -0,0 +1,300 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+
+#ifdef LINUX
+
+#include "../remote/os/posix/xnet.h"
+#include <poll.h>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr int WAIT_TIMEOUT = 5000;
+
+	typedef std::vector<UCHAR> Message;
+
+	// One side of the connection, exchanges the messages through the data channels
+	// of its own mapping using the same block protocol as the XDR stream of the port
+	class Side
+	{
+	public:
+		Side(UCHAR* address, int sendChannel, int recvChannel)
+			: send(&((XPS) address)->xps_channels[sendChannel]),
+			  recv(&((XPS) address)->xps_channels[recvChannel]),
+			  sendBuffer(xnet_channel_buffer(address, sendChannel)),
+			  recvBuffer(xnet_channel_buffer(address, recvChannel))
+		{
+		}
+
+		bool put(const Message& message)
+		{
+			for (size_t offset = 0; offset < message.size(); )
+			{
+				// The channel must be read by the other side before it's filled again
+
+				if (!xnet_event_wait(&send->xch_empted, WAIT_TIMEOUT))
+					return false;
+
+				const ULONG length = (ULONG) MIN(message.size() - offset, (size_t) send->xch_size);
+				memcpy(sendBuffer, message.data() + offset, length);
+				offset += length;
+
+				send->xch_length = length;
+				xnet_event_set(&send->xch_filled);
+			}
+
+			return true;
+		}
+
+		bool get(Message& message, size_t length)
+		{
+			message.clear();
+
+			while (message.size() < length)
+			{
+				xnet_event_set(&recv->xch_empted);
+
+				if (!xnet_event_wait(&recv->xch_filled, WAIT_TIMEOUT))
+					return false;
+
+				message.insert(message.end(), recvBuffer, recvBuffer + recv->xch_length);
+			}
+
+			return message.size() == length;
+		}
+
+	private:
+		XCH send;
+		XCH recv;
+		UCHAR* sendBuffer;
+		UCHAR* recvBuffer;
+	};
+
+	// Sizes of the exchanged messages, the larger ones take a few blocks
+	std::vector<size_t> getMessageSizes(ULONG channelSize)
+	{
+		return {1, 100, channelSize - 1, channelSize, channelSize * 3 + 7};
+	}
+
+	// Accept the connection, pass the shared memory to the client
+	// and answer every message with its bytes incremented
+	bool serve(int listenSocket)
+	{
+		const int sock = accept4(listenSocket, NULL, NULL, SOCK_CLOEXEC);
+		if (sock < 0)
+			return false;
+
+		bool result = false;
+		const int mapFd = memfd_create("xnet_test", MFD_CLOEXEC);
+		void* mapped = MAP_FAILED;
+
+		if (mapFd >= 0 && ftruncate(mapFd, XPS_MAPPED_SIZE) == 0)
+			mapped = mmap(NULL, XPS_MAPPED_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, mapFd, 0);
+
+		if (mapped != MAP_FAILED)
+		{
+			UCHAR* const address = (UCHAR*) mapped;
+			const XPS xps = xnet_init_mapping(address, XPS_MAPPED_SIZE);
+
+			XNET_RESPONSE response;
+			response.proc_id = getpid();
+			response.map_size = XPS_MAPPED_SIZE;
+
+			if (xnet_send_mapping(sock, response, mapFd))
+			{
+				Side side(address, XPS_CHANNEL_S2C_DATA, XPS_CHANNEL_C2S_DATA);
+				Message message;
+
+				result = true;
+
+				for (const auto size : getMessageSizes(xps->xps_channels[XPS_CHANNEL_C2S_DATA].xch_size))
+				{
+					if (!side.get(message, size))
+					{
+						result = false;
+						break;
+					}
+
+					for (auto& byte : message)
+						byte++;
+
+					if (!side.put(message))
+					{
+						result = false;
+						break;
+					}
+				}
+			}
+
+			munmap(mapped, XPS_MAPPED_SIZE);
+		}
+
+		if (mapFd >= 0)
+			close(mapFd);
+
+		close(sock);
+
+		return result;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(RemoteSuite)
+BOOST_AUTO_TEST_SUITE(XnetSuite)
+
+
+BOOST_AUTO_TEST_SUITE(XnetTests)
+
+BOOST_AUTO_TEST_CASE(EventTest)
+{
+	xev event;
+	event.xev_signaled = 0;
+	event.xev_waiters = 0;
+
+	BOOST_TEST(!xnet_event_wait(&event, 10));
+
+	// Event is reset by the wait
+	xnet_event_set(&event);
+	BOOST_TEST(xnet_event_wait(&event, 10));
+	BOOST_TEST(!xnet_event_wait(&event, 10));
+
+	// Sleeping waiter is woken up
+	std::thread setter([&event] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		xnet_event_set(&event);
+	});
+
+	BOOST_TEST(xnet_event_wait(&event, WAIT_TIMEOUT));
+	setter.join();
+
+	BOOST_TEST(event.xev_waiters == 0);
+	BOOST_TEST(event.xev_signaled == 0);
+}
+
+BOOST_AUTO_TEST_CASE(LayoutTest)
+{
+	std::vector<UCHAR> memory(XPS_MAPPED_SIZE, 0);
+	UCHAR* const address = memory.data();
+
+	const XPS xps = xnet_init_mapping(address, XPS_MAPPED_SIZE);
+
+	BOOST_TEST(xps->xps_server_protocol == XPI_SERVER_PROTOCOL_VERSION);
+	BOOST_TEST(xps->xps_channels[XPS_CHANNEL_C2S_EVENTS].xch_size == XNET_EVENT_SPACE);
+	BOOST_TEST(xps->xps_channels[XPS_CHANNEL_S2C_EVENTS].xch_size == XNET_EVENT_SPACE);
+	BOOST_TEST(xps->xps_channels[XPS_CHANNEL_C2S_DATA].xch_size ==
+		xps->xps_channels[XPS_CHANNEL_S2C_DATA].xch_size);
+
+	// Channel buffers follow each other after the header and fit the mapping
+	UCHAR* next = address + sizeof(struct xps);
+
+	for (const int channel : XPS_CHANNEL_LAYOUT)
+	{
+		BOOST_TEST(xnet_channel_buffer(address, channel) == next);
+		next += xps->xps_channels[channel].xch_size;
+	}
+
+	BOOST_TEST(next <= address + XPS_MAPPED_SIZE);
+	BOOST_TEST(next + 2 > address + XPS_MAPPED_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(ConnectExchangeTest)
+{
+	// Own name, so the test doesn't meet a running server
+	char ipcName[32];
+	snprintf(ipcName, sizeof(ipcName), "XnetTest_%d", (int) getpid());
+
+	sockaddr_un address;
+	const socklen_t addressLength = xnet_socket_address(&address, ipcName);
+
+	const int listenSocket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	BOOST_REQUIRE(listenSocket >= 0);
+	BOOST_REQUIRE(bind(listenSocket, (sockaddr*) &address, addressLength) == 0);
+	BOOST_REQUIRE(listen(listenSocket, 1) == 0);
+
+	bool served = false;
+	std::thread server([&served, listenSocket] {
+		served = serve(listenSocket);
+	});
+
+	// Let the server thread go if the client side fails
+	struct ServerGuard
+	{
+		~ServerGuard()
+		{
+			shutdown(listenSocket, SHUT_RDWR);
+
+			if (server.joinable())
+				server.join();
+
+			close(listenSocket);
+		}
+
+		std::thread& server;
+		const int listenSocket;
+	} serverGuard{server, listenSocket};
+
+	const int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	BOOST_REQUIRE(sock >= 0);
+	BOOST_REQUIRE(connect(sock, (sockaddr*) &address, addressLength) == 0);
+
+	pollfd pfd;
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	BOOST_REQUIRE(poll(&pfd, 1, WAIT_TIMEOUT) == 1);
+
+	XNET_RESPONSE response;
+	int mapFd;
+	BOOST_REQUIRE(xnet_receive_mapping(sock, &response, &mapFd) == (ssize_t) sizeof(response));
+	BOOST_REQUIRE(mapFd >= 0);
+	BOOST_TEST(response.proc_id == (ULONG) getpid());
+	BOOST_TEST(response.map_size == XPS_MAPPED_SIZE);
+
+	void* const mapped = mmap(NULL, response.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, mapFd, 0);
+	close(mapFd);
+	BOOST_REQUIRE(mapped != MAP_FAILED);
+
+	// Client maps the memory at its own address, but sees the same area
+	UCHAR* const mappedAddress = (UCHAR*) mapped;
+	const XPS xps = (XPS) mappedAddress;
+
+	BOOST_TEST(xps->xps_server_protocol == XPI_SERVER_PROTOCOL_VERSION);
+	xps->xps_client_protocol = XPI_CLIENT_PROTOCOL_VERSION;
+
+	Side side(mappedAddress, XPS_CHANNEL_C2S_DATA, XPS_CHANNEL_S2C_DATA);
+	Message message, answer;
+
+	for (const auto size : getMessageSizes(xps->xps_channels[XPS_CHANNEL_C2S_DATA].xch_size))
+	{
+		message.resize(size);
+
+		for (size_t i = 0; i < size; i++)
+			message[i] = (UCHAR) (i * 7 + size);
+
+		BOOST_TEST_INFO("message size " << size);
+		BOOST_REQUIRE(side.put(message));
+		BOOST_REQUIRE(side.get(answer, size));
+
+		size_t mismatch = 0;
+		while (mismatch < size && answer[mismatch] == (UCHAR) (message[mismatch] + 1))
+			mismatch++;
+
+		BOOST_TEST(mismatch == size);
+	}
+
+	server.join();
+	BOOST_TEST(served);
+
+	munmap(mapped, response.map_size);
+	close(sock);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// XnetTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// XnetSuite
+BOOST_AUTO_TEST_SUITE_END()	// RemoteSuite
+
+#endif // LINUX
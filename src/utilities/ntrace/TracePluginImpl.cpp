@@ -677,6 +677,38 @@ void TracePluginImpl::appendGlobalCounts(IPerformanceStats* stats)
 		}
 	}
 
+	const auto waitCounters = stats->getCounters(IPerformanceStats::COUNTER_GROUP_WAITS);
+
+	if (waitCounters && waitCounters->getObjectCount())
+	{
+		static const struct
+		{
+			unsigned index;
+			const char* name;
+		} waits[] =
+		{
+			{IPerformanceCounters::WAIT_PAGE_READS, "read"},
+			{IPerformanceCounters::WAIT_PAGE_WRITES, "write"},
+			{IPerformanceCounters::WAIT_LATCHES, "latch wait"},
+			{IPerformanceCounters::WAIT_LOCKS, "lock wait"},
+			{IPerformanceCounters::WAIT_SORT_IO, "sort I/O"}
+		};
+
+		const auto counters = waitCounters->getObjectCounters(0);
+		const auto maxIndex = waitCounters->getMaxCounterIndex();
+
+		for (const auto& wait : waits)
+		{
+			if (wait.index > maxIndex || !counters[wait.index])
+				continue;
+
+			// Wait times are reported in microseconds
+			temp.printf(", %" QUADFORMAT"d.%03d ms %s", counters[wait.index] / 1000,
+				(int) (counters[wait.index] % 1000), wait.name);
+			record.append(temp);
+		}
+	}
+
 	record.append(NEWLINE);
 }
 
@@ -369,6 +369,7 @@ static constexpr UCHAR
 	rid[]		= { op_word, op_byte, op_line, 0},
 	rid2[]		= { op_word, op_byte, op_literal, op_pad, op_byte, op_line, 0},
 	union_ops[] = { op_byte, op_byte, op_line, op_union, 0},
+	union_shared[] = { op_word, op_byte, op_byte, op_line, op_union, 0},
     map[]  	    = { op_word, op_line, op_map, 0},
 	function[]	= { op_byte, op_literal, op_byte, op_line, op_args, 0},
 	function2[]	= { op_byte, op_literal, op_pad, op_byte, op_literal, op_pad, op_byte, op_line,